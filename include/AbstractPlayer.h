@@ -2,6 +2,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 
 class AbstractPlayer : public QObject {
     Q_OBJECT
@@ -12,6 +13,10 @@ public:
 
     virtual void play(const QString& url) = 0;
     virtual void stop() = 0;
+    // Один и тот же эфир по нескольким адресам (зеркала, качество) в порядке
+    // приоритета. Плеер может подключаться к ним параллельно и переходить на
+    // следующий при обрыве; по умолчанию играет первый
+    virtual void playCandidates(const QStringList& urls) { if (!urls.isEmpty()) play(urls.first()); }
     virtual void togglePlayback() = 0;
 
     virtual void setVolume(int value) = 0;
@@ -23,6 +28,17 @@ public:
     virtual void setCookiesFile(const QString& path) { Q_UNUSED(path); }
     virtual QString cookiesFile() const { return QString(); }
     virtual bool sendQuitAndWait(int waitMs = 1500) { Q_UNUSED(waitMs); return false; }
+    // Подсказка: эти URL, вероятно, включат следующими (соседи по списку).
+    // Плеер может заранее подключиться к ним; по умолчанию игнорируется
+    virtual void prepareNext(const QStringList& urls) { Q_UNUSED(urls); }
+    // Сдвиг во времени живого эфира (supportsFeature("timeshift")):
+    // deltaMs < 0 — назад, > 0 — вперёд, но не дальше эфира
+    virtual void shiftBy(int deltaMs) { Q_UNUSED(deltaMs); }
+    virtual void goLive() {}
+    // Запись текущего эфира как есть (supportsFeature("record"))
+    virtual bool startRecording(const QString& dir, const QString& label) { Q_UNUSED(dir); Q_UNUSED(label); return false; }
+    virtual void stopRecording() {}
+    virtual bool isRecording() const { return false; }
 
     signals:
     void playbackStateChanged(bool isPlaying);
@@ -30,4 +46,7 @@ public:
     void mutedChanged(bool muted);
     void errorOccurred(const QString& errorString);
     void featureChanged(const QString& feature, bool enabled);
+    // Текущий трек из метаданных потока (ICY StreamTitle); пусто — неизвестен
+    void nowPlayingChanged(const QString& title);
+    void recordingChanged(bool recording);
 };
@@ -0,0 +1,159 @@
+# Резидентный помощник YtResolver: yt_dlp импортируется один раз, дальше
+# запросы идут построчным JSON. stdin: {"id", "url", "format" (null —
+# формат yt-dlp по умолчанию), "cookies", "playlist", "background"} или
+# {"cancel": id}; stdout: {"id", "url" | "error", "rss_mb"}.
+# Аргументы: потоков для запросов, которых ждут, и для предвыборки —
+# пулы раздельные, фон никогда не задерживает воспроизведение.
+# Конец stdin — доделать начатое и выйти.
+import json
+import os
+import sys
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+out_lock = threading.Lock()
+
+
+def rss_mb():
+    try:
+        if sys.platform == "win32":
+            import ctypes
+            from ctypes import wintypes
+
+            class Counters(ctypes.Structure):
+                _fields_ = [("cb", wintypes.DWORD),
+                            ("PageFaultCount", wintypes.DWORD),
+                            ("PeakWorkingSetSize", ctypes.c_size_t),
+                            ("WorkingSetSize", ctypes.c_size_t),
+                            ("QuotaPeakPagedPoolUsage", ctypes.c_size_t),
+                            ("QuotaPagedPoolUsage", ctypes.c_size_t),
+                            ("QuotaPeakNonPagedPoolUsage", ctypes.c_size_t),
+                            ("QuotaNonPagedPoolUsage", ctypes.c_size_t),
+                            ("PagefileUsage", ctypes.c_size_t),
+                            ("PeakPagefileUsage", ctypes.c_size_t)]
+
+            counters = Counters()
+            counters.cb = ctypes.sizeof(counters)
+            kernel32 = ctypes.windll.kernel32
+            kernel32.GetCurrentProcess.restype = wintypes.HANDLE
+            if kernel32.K32GetProcessMemoryInfo(kernel32.GetCurrentProcess(),
+                                                ctypes.byref(counters), counters.cb):
+                return counters.WorkingSetSize // (1024 * 1024)
+            return 0
+        with open("/proc/self/statm") as f:
+            return int(f.read().split()[1]) * os.sysconf("SC_PAGE_SIZE") // (1024 * 1024)
+    except Exception:
+        return 0
+
+
+def reply(obj):
+    obj["rss_mb"] = rss_mb()
+    line = json.dumps(obj)
+    with out_lock:
+        sys.stdout.write(line + "\n")
+        sys.stdout.flush()
+
+
+class QuietLogger:
+    # Ошибка и так уходит в ответ; предупреждения не нужны
+    def debug(self, msg):
+        pass
+
+    def info(self, msg):
+        pass
+
+    def warning(self, msg):
+        pass
+
+    def error(self, msg):
+        pass
+
+
+def pick_url(info):
+    # Как yt-dlp -g: первый элемент плейлиста, первая ссылка формата
+    while info and info.get("_type") == "playlist":
+        entries = [e for e in (info.get("entries") or []) if e]
+        info = entries[0] if entries else None
+    if not info:
+        return None
+    formats = info.get("requested_formats")
+    if formats:
+        # Из раздельных дорожек — та, где есть звук
+        with_audio = [f for f in formats if f.get("acodec") not in (None, "none")]
+        return (with_audio or formats)[0].get("url")
+    return info.get("url")
+
+
+def handle(yt_dlp, request):
+    opts = {
+        "quiet": True,
+        "no_warnings": True,
+        "logger": QuietLogger(),
+        "nocheckcertificate": True,
+        "noplaylist": not request.get("playlist"),
+        "playlist_items": "1",
+    }
+    if request.get("format"):
+        opts["format"] = request["format"]
+    if request.get("cookies"):
+        opts["cookiefile"] = request["cookies"]
+    try:
+        with yt_dlp.YoutubeDL(opts) as ydl:
+            url = pick_url(ydl.extract_info(request["url"], download=False))
+        if url:
+            reply({"id": request["id"], "url": url})
+        else:
+            reply({"id": request["id"], "error": "no URL in extractor result"})
+    except BaseException as e:
+        reply({"id": request["id"], "error": str(e) or type(e).__name__})
+
+
+def main():
+    sys.stdin.reconfigure(encoding="utf-8")
+    try:
+        import yt_dlp
+    except Exception as e:
+        reply({"ready": False, "error": str(e)})
+        return 1
+    reply({"ready": True, "version": yt_dlp.version.__version__})
+
+    foreground_workers = int(sys.argv[1]) if len(sys.argv) > 1 else 4
+    background_workers = int(sys.argv[2]) if len(sys.argv) > 2 else 2
+    foreground = ThreadPoolExecutor(max_workers=max(1, foreground_workers))
+    background = ThreadPoolExecutor(max_workers=max(1, background_workers))
+    pending = {}
+    pending_lock = threading.Lock()
+
+    def run(request):
+        with pending_lock:
+            pending.pop(request["id"], None)
+        handle(yt_dlp, request)
+
+    while True:
+        line = sys.stdin.readline()
+        if not line:
+            break
+        line = line.strip()
+        if not line:
+            continue
+        try:
+            request = json.loads(line)
+        except ValueError:
+            continue
+        if "cancel" in request:
+            # Ещё не начатый — выбрасываем; начатый разбор не прервать
+            with pending_lock:
+                future = pending.pop(request["cancel"], None)
+            if future is not None:
+                future.cancel()
+            continue
+        pool = background if request.get("background") else foreground
+        with pending_lock:
+            pending[request["id"]] = pool.submit(run, request)
+    foreground.shutdown(wait=True)
+    background.shutdown(wait=True)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,99 @@
+#include "AppSettings.h"
+#include "BackgroundWriter.h"
+#include <QCoreApplication>
+#include <QSettings>
+#include <QDebug>
+
+AppSettings* AppSettings::instance()
+{
+    static AppSettings* settings = new AppSettings(QCoreApplication::instance());
+    return settings;
+}
+
+AppSettings::AppSettings(QObject* parent)
+    : QObject(parent)
+    , m_writer(new BackgroundWriter(QStringLiteral("SettingsWriter"), 1000, this))
+{
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "MyApp", "LoraRadio");
+    const QStringList keys = settings.allKeys();
+    m_values.reserve(keys.size());
+    for (const QString& key : keys)
+        m_values.insert(key, settings.value(key));
+    qDebug() << "[AppSettings] Loaded" << m_values.size() << "keys from" << settings.fileName();
+}
+
+AppSettings::~AppSettings()
+{
+    // Задача записи обращается к m_pending — сбрасываем до разрушения членов
+    m_writer->flush();
+}
+
+QVariant AppSettings::value(const QString& key, const QVariant& defaultValue) const
+{
+    auto it = m_values.constFind(key);
+    return it != m_values.constEnd() ? it.value() : defaultValue;
+}
+
+QStringList AppSettings::keys(const QString& prefix) const
+{
+    QStringList result;
+    for (auto it = m_values.constBegin(); it != m_values.constEnd(); ++it) {
+        if (it.key().startsWith(prefix))
+            result.append(it.key());
+    }
+    return result;
+}
+
+void AppSettings::setValue(const QString& key, const QVariant& value)
+{
+    auto it = m_values.find(key);
+    if (it != m_values.end() && it.value() == value)
+        return;
+    m_values.insert(key, value);
+
+    {
+        QMutexLocker lock(&m_pendingMutex);
+        m_pending.insert(key, value);
+    }
+    m_writer->schedule([this]() { writePending(); });
+    emit valueChanged(key, value);
+}
+
+void AppSettings::remove(const QString& key)
+{
+    if (!m_values.remove(key))
+        return;
+
+    {
+        QMutexLocker lock(&m_pendingMutex);
+        m_pending.insert(key, QVariant());
+    }
+    m_writer->schedule([this]() { writePending(); });
+    emit valueChanged(key, QVariant());
+}
+
+void AppSettings::flush()
+{
+    m_writer->flush();
+}
+
+void AppSettings::writePending()
+{
+    // Выполняется в потоке BackgroundWriter
+    QHash<QString, QVariant> pending;
+    {
+        QMutexLocker lock(&m_pendingMutex);
+        pending.swap(m_pending);
+    }
+    if (pending.isEmpty())
+        return;
+
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "MyApp", "LoraRadio");
+    for (auto it = pending.constBegin(); it != pending.constEnd(); ++it) {
+        if (it.value().isValid())
+            settings.setValue(it.key(), it.value());
+        else
+            settings.remove(it.key());
+    }
+    settings.sync();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVariant>
+
+class BackgroundWriter;
+
+// AppSettings — единое хранилище настроек приложения.
+// INI читается один раз при старте, чтения идут из памяти, а изменения
+// копятся и сбрасываются на диск пачкой в фоне (BackgroundWriter).
+class AppSettings : public QObject {
+    Q_OBJECT
+public:
+    static AppSettings* instance();
+    ~AppSettings() override;
+
+    QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const;
+    void setValue(const QString& key, const QVariant& value);
+    bool contains(const QString& key) const { return m_values.contains(key); }
+    QStringList keys(const QString& prefix) const;
+    void remove(const QString& key);
+    void flush();
+
+    int     volume() const                { return value("volume", 50).toInt(); }
+    void    setVolume(int v)              { setValue("volume", v); }
+    QString language() const              { return value("language", "en").toString(); }
+    void    setLanguage(const QString& l) { setValue("language", l); }
+    int     lastMode() const              { return value("lastMode", 0).toInt(); }
+    void    setLastMode(int mode)         { setValue("lastMode", mode); }
+    bool    autostartEnabled() const      { return value("autostart/enabled", false).toBool(); }
+    void    setAutostartEnabled(bool on)  { setValue("autostart/enabled", on); }
+    // Сколько соседних станций держать подключёнными заранее (0 — выкл.)
+    int     radioStandbyLimit() const     { return value("radio/standbyLimit", 2).toInt(); }
+    // Длительность кроссфейда при смене станции, мс (0 — без кроссфейда)
+    int     radioCrossfadeMs() const      { return value("radio/crossfadeMs", 0).toInt(); }
+    // Движок радио: "qt" (QMediaPlayer) или "native" (StreamPlayer)
+    QString radioBackend() const          { return value("radio/backend", "qt").toString(); }
+    // Движок "qt": названия треков (ICY) — вторым лёгким подключением к
+    // станции, пока QtMultimedia не отдаёт их сам (удваивает трафик радио)
+    bool    radioIcyTitles() const        { return value("radio/icyTitles", true).toBool(); }
+    // Пределы адаптивного буфера StreamPlayer, мс
+    int     radioBufferMinMs() const      { return value("radio/bufferMinMs", 300).toInt(); }
+    int     radioBufferMaxMs() const      { return value("radio/bufferMaxMs", 8000).toInt(); }
+    // Сколько HLS-сегментов качать одновременно
+    int     radioHlsParallel() const      { return value("radio/hlsParallel", 3).toInt(); }
+    // Окно сдвига во времени живого эфира, мин (0 — пауза переподключает)
+    int     radioTimeShiftMinutes() const { return value("radio/timeShiftMinutes", 10).toInt(); }
+    // Запись эфира: папка (пусто — «Музыка/LoraRadio») и резка по времени, мин
+    QString radioRecordDir() const        { return value("radio/recordDir").toString(); }
+    int     radioRecordSplitMinutes() const { return value("radio/recordSplitMinutes", 60).toInt(); }
+    // Фоновые процессы yt-dlp для предвыборки соседних видео (0 — выкл.)
+    int     youtubePrefetchWorkers() const { return value("youtube/prefetchWorkers", 2).toInt(); }
+    // Через сколько мс молчания основного запроса yt-dlp параллельно
+    // запрашивать манифест (0 — только после неудачи основного)
+    int     youtubeHedgeDelayMs() const   { return value("youtube/hedgeDelayMs", 2500).toInt(); }
+    // Резидентный python с yt_dlp вместо запуска yt-dlp на каждый запрос;
+    // пусто в helperPython — python из PATH. Смена процесса после N запросов
+    // или при памяти больше лимита, МБ (0 — без ограничения)
+    bool    youtubeHelperEnabled() const  { return value("youtube/helper", true).toBool(); }
+    QString youtubeHelperPython() const   { return value("youtube/helperPython").toString(); }
+    int     youtubeHelperMaxRequests() const { return value("youtube/helperMaxRequests", 200).toInt(); }
+    int     youtubeHelperMaxRssMb() const { return value("youtube/helperMaxRssMb", 400).toInt(); }
+    // Недавно включённые видео, свежие первыми — кандидаты на предвыборку
+    QStringList youtubeRecent() const     { return value("youtube/recent").toStringList(); }
+    void    setYoutubeRecent(const QStringList& urls) { setValue("youtube/recent", urls); }
+
+signals:
+    void valueChanged(const QString& key, const QVariant& value);
+
+private:
+    explicit AppSettings(QObject* parent = nullptr);
+    void writePending();
+
+    QHash<QString, QVariant> m_values;
+
+    // Изменения, ещё не попавшие на диск; невалидный QVariant — удаление
+    QMutex                   m_pendingMutex;
+    QHash<QString, QVariant> m_pending;
+    BackgroundWriter*        m_writer;
+};
@@ -0,0 +1,59 @@
+#include "BackgroundWriter.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
+
+BackgroundWriter::BackgroundWriter(const QString& name, int quietMs, QObject* parent)
+    : QObject(parent)
+    , m_thread(new QThread)
+    , m_context(new QObject)
+    , m_timer(new QTimer(this))
+{
+    m_thread->setObjectName(name);
+    m_context->moveToThread(m_thread);
+    m_thread->start(QThread::LowPriority);
+
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(quietMs);
+    connect(m_timer, &QTimer::timeout, this, &BackgroundWriter::dispatch);
+
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+                this, &BackgroundWriter::flush);
+    }
+}
+
+BackgroundWriter::~BackgroundWriter()
+{
+    flush();
+    m_thread->quit();
+    m_thread->wait();
+    delete m_context;
+    delete m_thread;
+}
+
+void BackgroundWriter::schedule(std::function<void()> job)
+{
+    m_pending = std::move(job);
+    m_timer->start();  // перезапуск — ждём паузы в изменениях
+}
+
+void BackgroundWriter::dispatch()
+{
+    m_timer->stop();
+    if (!m_pending)
+        return;
+
+    std::function<void()> job = std::move(m_pending);
+    m_pending = nullptr;
+    QMetaObject::invokeMethod(m_context, std::move(job), Qt::QueuedConnection);
+}
+
+void BackgroundWriter::flush()
+{
+    dispatch();
+    // Очередь потока обрабатывается по порядку: пустая задача завершится
+    // только после всех записей, поставленных ранее
+    if (QThread::currentThread() != m_thread && m_thread->isRunning())
+        QMetaObject::invokeMethod(m_context, []() {}, Qt::BlockingQueuedConnection);
+}
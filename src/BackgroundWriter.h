@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <functional>
+
+class QThread;
+class QTimer;
+
+// BackgroundWriter — отложенная запись на диск в отдельном потоке.
+// schedule() заменяет ещё не начатую задачу новой (серия изменений даёт одну
+// запись) и запускает её после паузы quietMs. flush() выполняет отложенное
+// сразу и ждёт завершения; вызывается автоматически на aboutToQuit.
+class BackgroundWriter : public QObject {
+    Q_OBJECT
+public:
+    explicit BackgroundWriter(const QString& name, int quietMs, QObject* parent = nullptr);
+    ~BackgroundWriter() override;
+
+    void schedule(std::function<void()> job);
+    void flush();
+    bool isPending() const { return static_cast<bool>(m_pending); }
+
+private:
+    void dispatch();
+
+    QThread*              m_thread;
+    QObject*              m_context;
+    QTimer*               m_timer;
+    std::function<void()> m_pending;
+};
@@ -0,0 +1,203 @@
+#include "DirectoryPage.h"
+#include "../include/fluent_icons.h"
+#include "IconButton.h"
+#include <QComboBox>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+#include <QSpinBox>
+#include <QTimer>
+#include <QDebug>
+using namespace fluent_icons;
+
+DirectoryPage::DirectoryPage(StationManager* stations, QWidget* parent)
+    : QWidget(parent)
+    , m_stations(stations)
+    , m_catalog(new StationCatalog(QString(), this))
+    , m_model(new CatalogModel(m_catalog, this))
+    , m_queryTimer(new QTimer(this))
+{
+    // Короткая пауза между нажатиями — запрос один на «всплеск» набора
+    m_queryTimer->setSingleShot(true);
+    m_queryTimer->setInterval(80);
+
+    setupUi();
+    setupConnections();
+    reloadFacets();
+    runQuery();
+}
+
+void DirectoryPage::setupUi()
+{
+    m_search = new QLineEdit(this);
+    m_search->setPlaceholderText(tr("Поиск: название, жанр, теги"));
+    m_search->setClearButtonEnabled(true);
+
+    m_country = new QComboBox(this);
+    m_codec   = new QComboBox(this);
+    m_minBitrate = new QSpinBox(this);
+    m_minBitrate->setRange(0, 512);
+    m_minBitrate->setSingleStep(32);
+    m_minBitrate->setSuffix(tr(" кбит/с"));
+    m_minBitrate->setToolTip(tr("Минимальный битрейт"));
+
+    m_listView = new QListView(this);
+    m_listView->setModel(m_model);
+    m_listView->setUniformItemSizes(true);
+    m_listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    m_status = new QLabel(this);
+
+    m_btnPromote = new IconButton(ic_fluent_add_circle_32_filled,     32, QColor("#FFF"), tr("В избранное"),   this);
+    m_btnPlay    = new IconButton(ic_fluent_play_circle_48_filled,    32, QColor("#FFF"), tr("Воспроизвести"), this);
+    m_btnImport  = new IconButton(ic_fluent_arrow_download_32_filled, 32, QColor("#FFF"), tr("Загрузить каталог"), this);
+
+    auto *filterLay = new QHBoxLayout;
+    filterLay->addWidget(m_search, 1);
+    filterLay->addWidget(m_country);
+    filterLay->addWidget(m_codec);
+    filterLay->addWidget(m_minBitrate);
+
+    auto *buttonLay = new QHBoxLayout;
+    buttonLay->addWidget(m_btnPromote);
+    buttonLay->addWidget(m_btnPlay);
+    buttonLay->addWidget(m_btnImport);
+    buttonLay->addStretch();
+    buttonLay->addWidget(m_status);
+
+    QWidget *stationPanel = new QWidget(this);
+    stationPanel->setObjectName("stationPanel");
+
+    auto *panelLay = new QVBoxLayout(stationPanel);
+    panelLay->addLayout(filterLay);
+    panelLay->addWidget(m_listView, 1);
+    panelLay->addLayout(buttonLay);
+    panelLay->setContentsMargins(0, 0, 0, 0);
+
+    auto *mainLay = new QVBoxLayout(this);
+    mainLay->addWidget(stationPanel, 1);
+    mainLay->setContentsMargins(0, 0, 0, 0);
+
+    if (!m_catalog->isOpen()) {
+        setEnabled(false);
+        m_status->setText(tr("Каталог недоступен"));
+    }
+}
+
+void DirectoryPage::setupConnections()
+{
+    connect(m_queryTimer, &QTimer::timeout, this, &DirectoryPage::runQuery);
+    connect(m_search, &QLineEdit::textChanged, m_queryTimer, qOverload<>(&QTimer::start));
+    // Фасеты меняются кликом — запрос сразу
+    connect(m_country, &QComboBox::currentIndexChanged, this, &DirectoryPage::runQuery);
+    connect(m_codec,   &QComboBox::currentIndexChanged, this, &DirectoryPage::runQuery);
+    connect(m_minBitrate, QOverload<int>::of(&QSpinBox::valueChanged), m_queryTimer, qOverload<>(&QTimer::start));
+
+    connect(m_btnPromote, &IconButton::clicked, this, &DirectoryPage::promoteCurrent);
+    connect(m_btnImport,  &IconButton::clicked, this, &DirectoryPage::importDump);
+    connect(m_btnPlay, &IconButton::clicked, this, [this]() {
+        const QModelIndex idx = m_listView->currentIndex();
+        if (idx.isValid())
+            emit playRequested(idx.data(CatalogModel::UrlRole).toString());
+    });
+    connect(m_listView, &QListView::doubleClicked, this, [this](const QModelIndex& idx) {
+        if (idx.isValid())
+            emit playRequested(idx.data(CatalogModel::UrlRole).toString());
+    });
+
+    connect(m_model, &QAbstractItemModel::modelReset,  this, &DirectoryPage::updateStatus);
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &DirectoryPage::updateStatus);
+
+    connect(m_catalog, &StationCatalog::importProgress, this, [this](qint64 done, qint64 total) {
+        m_status->setText(tr("Загрузка каталога: %1%").arg(total > 0 ? done * 100 / total : 0));
+    });
+    connect(m_catalog, &StationCatalog::importFinished, this, [this](int count, bool canceled) {
+        m_btnImport->setEnabled(true);
+        qDebug() << "[DirectoryPage] Catalog import finished:" << count << "canceled:" << canceled;
+        reloadFacets();
+        runQuery();
+    });
+    connect(m_catalog, &StationCatalog::importFailed, this, [this](const QString& error) {
+        m_btnImport->setEnabled(true);
+        m_status->setText(tr("Ошибка загрузки: %1").arg(error));
+    });
+}
+
+void DirectoryPage::reloadFacets()
+{
+    const QSignalBlocker countryBlock(m_country);
+    const QSignalBlocker codecBlock(m_codec);
+    const QString country = m_country->currentData().toString();
+    const QString codec   = m_codec->currentData().toString();
+
+    m_country->clear();
+    m_country->addItem(tr("Все страны"), QString());
+    for (const QString& c : m_catalog->countries())
+        m_country->addItem(c, c);
+    m_country->setCurrentIndex(qMax(0, m_country->findData(country)));
+
+    m_codec->clear();
+    m_codec->addItem(tr("Все кодеки"), QString());
+    for (const QString& c : m_catalog->codecs())
+        m_codec->addItem(c, c);
+    m_codec->setCurrentIndex(qMax(0, m_codec->findData(codec)));
+}
+
+void DirectoryPage::runQuery()
+{
+    m_queryTimer->stop();
+    CatalogQuery query;
+    query.text       = m_search->text();
+    query.country    = m_country->currentData().toString();
+    query.codec      = m_codec->currentData().toString();
+    query.minBitrate = m_minBitrate->value();
+    m_model->setQuery(query);
+}
+
+void DirectoryPage::updateStatus()
+{
+    if (m_catalog->isImporting())
+        return;
+    const int rows = m_model->rowCount();
+    m_status->setText(m_model->canFetchMore(QModelIndex())
+                      ? tr("Найдено: %1+").arg(rows)
+                      : tr("Найдено: %1").arg(rows));
+}
+
+void DirectoryPage::promoteCurrent()
+{
+    const QModelIndex idx = m_listView->currentIndex();
+    if (!idx.isValid())
+        return;
+
+    const CatalogEntry& entry = m_model->entryAt(idx.row());
+    if (m_stations->idForUrl(entry.url) != 0) {
+        m_status->setText(tr("Уже в избранном"));
+        return;
+    }
+
+    Station st;
+    st.name = entry.name;
+    st.url  = entry.url;
+    st.type = QStringLiteral("radio");
+    m_stations->addStation(st);
+    m_status->setText(tr("Добавлено: %1").arg(entry.name));
+}
+
+void DirectoryPage::importDump()
+{
+    if (m_catalog->isImporting())
+        return;
+
+    const QString path = QFileDialog::getOpenFileName(
+        this, tr("Загрузить каталог"), QString(),
+        tr("Дамп Radio-Browser (*.json);;Все файлы (*)"));
+    if (path.isEmpty())
+        return;
+
+    m_btnImport->setEnabled(false);
+    m_status->setText(tr("Загрузка каталога..."));
+    m_catalog->importDump(path);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QWidget>
+#include <QPointer>
+#include "StationManager.h"
+#include "StationCatalog.h"
+
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QListView;
+class QSpinBox;
+class QTimer;
+class IconButton;
+
+// DirectoryPage — вкладка каталога: поиск по SQLite-каталогу с фасетами
+// (страна, кодек, битрейт) и перенос станций в избранное (StationManager)
+class DirectoryPage : public QWidget {
+    Q_OBJECT
+public:
+    explicit DirectoryPage(StationManager* stations, QWidget* parent = nullptr);
+
+signals:
+    void playRequested(const QString& url);
+
+private slots:
+    void runQuery();
+    void promoteCurrent();
+    void importDump();
+
+private:
+    void setupUi();
+    void setupConnections();
+    void reloadFacets();
+    void updateStatus();
+
+    StationManager*       m_stations;
+    StationCatalog*       m_catalog;
+    CatalogModel*         m_model;
+    QTimer*               m_queryTimer;
+
+    QLineEdit*            m_search;
+    QComboBox*            m_country;
+    QComboBox*            m_codec;
+    QSpinBox*             m_minBitrate;
+    QListView*            m_listView;
+    QLabel*               m_status;
+    QPointer<IconButton>  m_btnPromote;
+    QPointer<IconButton>  m_btnPlay;
+    QPointer<IconButton>  m_btnImport;
+};
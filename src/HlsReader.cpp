@@ -0,0 +1,428 @@
+#include "HlsReader.h"
+#include "TimeShiftBuffer.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+#include <QTimer>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+    const int kSliceMs = 500;            // порция доставки в декодер
+    const int kPaceIntervalMs = 200;
+    const int kMaxSegmentRetries = 3;
+    const int kMaxPlaylistErrors = 6;
+
+    QString attribute(const QString& attrs, const QString& name)
+    {
+        const QRegularExpression rx(QStringLiteral("(?:^|,)%1=(\"[^\"]*\"|[^,]*)").arg(name));
+        QString value = rx.match(attrs).captured(1);
+        if (value.startsWith(QLatin1Char('"')))
+            value = value.mid(1, value.size() - 2);
+        return value;
+    }
+}
+
+HlsReader::HlsReader(QObject* parent)
+    : QObject(parent)
+{
+}
+
+bool HlsReader::isHlsUrl(const QUrl& url)
+{
+    return url.path().endsWith(QLatin1String(".m3u8"), Qt::CaseInsensitive);
+}
+
+void HlsReader::start(int session, const QUrl& url, QSharedPointer<TimeShiftBuffer> store)
+{
+    stop();
+    if (!m_nam) {
+        m_nam = new QNetworkAccessManager(this);
+        m_refresh = new QTimer(this);
+        m_refresh->setSingleShot(true);
+        connect(m_refresh, &QTimer::timeout, this, &HlsReader::fetchPlaylist);
+        m_pace = new QTimer(this);
+        m_pace->setInterval(kPaceIntervalMs);
+        connect(m_pace, &QTimer::timeout, this, &HlsReader::deliver);
+    }
+
+    m_session = session;
+    m_store = store;
+    m_variants.clear();
+    m_variant = -1;
+    m_mediaUrl = url;
+    m_initUrl.clear();
+    m_announced = false;
+    m_endList = false;
+    m_targetMs = 6000;
+    m_playlistErrors = 0;
+    m_lastQueued = -1;
+    m_nextDeliver = -1;
+    m_readyOffset = 0;
+    m_deliveredMs = 0;
+    m_slipMs = 0;
+    m_bandwidth = 0.0;
+    m_samples = 0;
+    m_clock.start();
+
+    qDebug() << "[HlsReader] Loading" << url;
+    fetchPlaylist();
+    m_pace->start();
+}
+
+void HlsReader::stop()
+{
+    if (m_refresh) m_refresh->stop();
+    if (m_pace)    m_pace->stop();
+    if (m_playlistReply) {
+        m_playlistReply->disconnect(this);
+        m_playlistReply->abort();
+        m_playlistReply->deleteLater();
+        m_playlistReply = nullptr;
+    }
+    for (auto it = m_inflight.cbegin(); it != m_inflight.cend(); ++it) {
+        it.key()->disconnect(this);
+        it.key()->abort();
+        it.key()->deleteLater();
+    }
+    m_inflight.clear();
+    m_retrying.clear();
+    m_queue.clear();
+    m_ready.clear();
+    m_store.reset();
+}
+
+void HlsReader::fail(const QString& error)
+{
+    qWarning() << "[HlsReader] Stream failed:" << error;
+    stop();
+    emit failed(m_session, error);
+}
+
+void HlsReader::fetchPlaylist()
+{
+    if (m_playlistReply || !m_store)
+        return;
+    QNetworkRequest request(m_mediaUrl);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setHeader(QNetworkRequest::UserAgentHeader, QStringLiteral("LoraRadio"));
+    request.setTransferTimeout(qMax(m_targetMs, 5000));
+    m_playlistReply = m_nam->get(request);
+    connect(m_playlistReply, &QNetworkReply::finished, this, &HlsReader::onPlaylist);
+}
+
+void HlsReader::onPlaylist()
+{
+    QNetworkReply *reply = m_playlistReply;
+    m_playlistReply = nullptr;
+    reply->deleteLater();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        // Пока в запасе есть сегменты, эфир идёт — просто пробуем ещё раз
+        if (++m_playlistErrors >= kMaxPlaylistErrors) {
+            fail(reply->errorString());
+            return;
+        }
+        qWarning() << "[HlsReader] Playlist refresh failed:" << reply->errorString();
+        m_refresh->start(m_targetMs / 2);
+        return;
+    }
+    m_playlistErrors = 0;
+
+    const QByteArray body = reply->readAll();
+    if (!body.trimmed().startsWith("#EXTM3U")) {
+        fail(tr("HLS: ответ не является плейлистом"));
+        return;
+    }
+
+    if (body.contains("#EXT-X-STREAM-INF")) {
+        if (!parseMaster(body, reply->url()))
+            fail(tr("HLS: в master-плейлисте нет вариантов"));
+        return;
+    }
+
+    const qint64 before = m_lastQueued;
+    if (!parseMedia(body, reply->url()))
+        return;
+    deliver();
+    schedule();
+
+    // Без изменений — следующая попытка раньше, как советует RFC 8216
+    if (!m_endList)
+        m_refresh->start(m_lastQueued != before ? m_targetMs : m_targetMs / 2);
+}
+
+bool HlsReader::parseMaster(const QByteArray& body, const QUrl& base)
+{
+    m_variants.clear();
+    qint64 bandwidth = -1;
+    const QList<QByteArray> lines = body.split('\n');
+    for (const QByteArray &raw : lines) {
+        const QString line = QString::fromUtf8(raw).trimmed();
+        if (line.startsWith(QLatin1String("#EXT-X-STREAM-INF:"))) {
+            bandwidth = attribute(line.mid(18), QStringLiteral("BANDWIDTH")).toLongLong();
+        } else if (!line.isEmpty() && !line.startsWith(QLatin1Char('#')) && bandwidth >= 0) {
+            m_variants.append({ base.resolved(QUrl(line)), bandwidth });
+            bandwidth = -1;
+        }
+    }
+    if (m_variants.isEmpty())
+        return false;
+
+    std::sort(m_variants.begin(), m_variants.end(), [](const Variant& a, const Variant& b) {
+        return a.bandwidth < b.bandwidth;
+    });
+    qDebug() << "[HlsReader] Master playlist:" << m_variants.size() << "variants";
+    // Старт с самого лёгкого: первый сегмент приходит быстрее всего
+    switchVariant(0);
+    return true;
+}
+
+bool HlsReader::parseMedia(const QByteArray& body, const QUrl& base)
+{
+    QList<Segment> segments;
+    qint64 seq = 0;
+    int duration = 0;
+    const QList<QByteArray> lines = body.split('\n');
+    for (const QByteArray &raw : lines) {
+        const QString line = QString::fromUtf8(raw).trimmed();
+        if (line.isEmpty())
+            continue;
+        if (line.startsWith(QLatin1String("#EXTINF:"))) {
+            duration = int(line.mid(8).section(QLatin1Char(','), 0, 0).toDouble() * 1000);
+        } else if (line.startsWith(QLatin1String("#EXT-X-TARGETDURATION:"))) {
+            m_targetMs = qMax(1, line.mid(22).toInt()) * 1000;
+        } else if (line.startsWith(QLatin1String("#EXT-X-MEDIA-SEQUENCE:"))) {
+            seq = line.mid(22).toLongLong();
+        } else if (line.startsWith(QLatin1String("#EXT-X-KEY:"))) {
+            if (attribute(line.mid(11), QStringLiteral("METHOD")) != QLatin1String("NONE")) {
+                fail(tr("HLS: зашифрованные потоки не поддерживаются"));
+                return false;
+            }
+        } else if (line.startsWith(QLatin1String("#EXT-X-MAP:"))) {
+            m_initUrl = base.resolved(QUrl(attribute(line.mid(11), QStringLiteral("URI"))));
+        } else if (line == QLatin1String("#EXT-X-ENDLIST")) {
+            m_endList = true;
+        } else if (!line.startsWith(QLatin1Char('#'))) {
+            Segment seg;
+            seg.seq = seq++;
+            seg.url = base.resolved(QUrl(line));
+            seg.durationMs = duration > 0 ? duration : m_targetMs;
+            segments.append(seg);
+            duration = 0;
+        }
+    }
+    if (segments.isEmpty())
+        return true;  // живой плейлист бывает пуст в первые секунды
+
+    if (m_lastQueued < 0) {
+        // Живой эфир — в трёх сегментах от края (RFC 8216), запись — с начала
+        const qint64 first = segments.first().seq;
+        const qint64 startSeq = m_endList ? first : qMax(first, segments.last().seq - 2);
+        m_lastQueued = startSeq - 1;
+        m_nextDeliver = startSeq;
+        if (m_initUrl.isValid()) {
+            Segment init;
+            init.seq = startSeq - 1;
+            init.url = m_initUrl;
+            m_queue.append(init);
+            m_nextDeliver = init.seq;
+        }
+        qDebug() << "[HlsReader] Starting at segment" << startSeq << "target" << m_targetMs << "ms";
+    } else if (segments.first().seq > m_lastQueued + 1) {
+        qWarning() << "[HlsReader] Playlist moved past" << m_lastQueued << "- segments lost";
+    }
+
+    // Инкрементально: берём только номера, которых ещё не видели
+    for (const Segment &seg : std::as_const(segments)) {
+        if (seg.seq > m_lastQueued) {
+            m_queue.append(seg);
+            m_lastQueued = seg.seq;
+        }
+    }
+    return true;
+}
+
+void HlsReader::schedule()
+{
+    if (!m_store)
+        return;
+    // Вперёд качаем ограниченное окно — для записей (VOD) это важно
+    const qint64 window = m_nextDeliver + 2 * m_maxParallel;
+    while (m_inflight.size() < m_maxParallel && !m_queue.isEmpty() && m_queue.first().seq <= window)
+        fetchSegment(m_queue.takeFirst());
+}
+
+void HlsReader::fetchSegment(const Segment& seg)
+{
+    QNetworkRequest request(seg.url);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setHeader(QNetworkRequest::UserAgentHeader, QStringLiteral("LoraRadio"));
+    request.setTransferTimeout(qMax(2 * m_targetMs, 10000));
+    QNetworkReply *reply = m_nam->get(request);
+
+    Segment tracked = seg;
+    tracked.startedMs = m_clock.elapsed();
+    m_inflight.insert(reply, tracked);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() { onSegment(reply); });
+}
+
+void HlsReader::onSegment(QNetworkReply* reply)
+{
+    const Segment seg = m_inflight.take(reply);
+    reply->deleteLater();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        retrySegment(seg);
+        schedule();
+        return;
+    }
+
+    const QByteArray data = reply->readAll();
+    const qint64 elapsed = qMax<qint64>(1, m_clock.elapsed() - seg.startedMs);
+    // Параллельные загрузки делят канал — замер одной занижает его
+    const double sample = double(data.size()) * 8.0 * 1000.0 / double(elapsed) * (1 + m_inflight.size());
+    m_bandwidth = m_samples == 0 ? sample : 0.7 * m_bandwidth + 0.3 * sample;
+    ++m_samples;
+
+    if (!m_announced) {
+        m_announced = true;
+        const int kbps = m_variant >= 0 ? int(m_variants.at(m_variant).bandwidth / 1000) : 0;
+        emit connected(m_session, reply->header(QNetworkRequest::ContentTypeHeader).toString(), kbps);
+    }
+
+    m_ready.insert(seg.seq, { data, seg.durationMs });
+    chooseVariant();
+    deliver();
+    schedule();
+}
+
+void HlsReader::retrySegment(Segment seg)
+{
+    if (++seg.attempt > kMaxSegmentRetries) {
+        // В живом эфире лучше пропустить сегмент, чем встать
+        qWarning() << "[HlsReader] Skipping segment" << seg.seq << "after" << kMaxSegmentRetries << "retries";
+        m_ready.insert(seg.seq, { QByteArray(), seg.durationMs });
+        deliver();
+        return;
+    }
+    m_retrying.insert(seg.seq);
+    const int session = m_session;
+    QTimer::singleShot(500 * seg.attempt, this, [this, seg, session]() {
+        if (session != m_session || !m_retrying.remove(seg.seq))
+            return;
+        fetchSegment(seg);
+    });
+}
+
+qint64 HlsReader::lowestPendingSeq() const
+{
+    qint64 low = -1;
+    auto take = [&low](qint64 seq) { if (low < 0 || seq < low) low = seq; };
+    if (!m_ready.isEmpty()) take(m_ready.firstKey());
+    if (!m_queue.isEmpty()) take(m_queue.first().seq);
+    for (const Segment &seg : m_inflight) take(seg.seq);
+    for (qint64 seq : m_retrying) take(seq);
+    return low;
+}
+
+void HlsReader::deliver()
+{
+    while (m_store && m_nextDeliver >= 0) {
+        auto it = m_ready.find(m_nextDeliver);
+        if (it == m_ready.end()) {
+            const qint64 low = lowestPendingSeq();
+            if (low < 0) {
+                if (m_endList) {
+                    qDebug() << "[HlsReader] End of playlist";
+                    m_store->finish();
+                    m_store.reset();
+                    m_pace->stop();
+                    emit finished(m_session);
+                }
+                return;
+            }
+            if (low > m_nextDeliver) {
+                // Ушедшие из плейлиста сегменты не вернуть — догоняем
+                m_nextDeliver = low;
+                m_readyOffset = 0;
+                continue;
+            }
+            return;  // ждём загрузку
+        }
+
+        // Эфир не успевал за часами (провал) — отсчёт темпа с текущего момента
+        qint64 playhead = m_clock.elapsed() - m_slipMs;
+        if (m_deliveredMs < playhead) {
+            m_slipMs += playhead - m_deliveredMs;
+            playhead = m_deliveredMs;
+        }
+        if (m_deliveredMs - playhead >= m_leadMs)
+            return;
+
+        Ready &ready = it.value();
+        const qsizetype size = ready.data.size();
+        if (size > 0) {
+            // Порциями по ~полсекунды: декодер опережает эфир не больше чем на lead
+            const qsizetype slice = ready.durationMs > 0
+                ? qMax<qsizetype>(1, size * kSliceMs / ready.durationMs)
+                : size;
+            const qsizetype n = qMin(slice, size - m_readyOffset);
+            m_store->append(ready.data.constData() + m_readyOffset, n);
+            m_readyOffset += n;
+            m_deliveredMs += qint64(double(n) * ready.durationMs / double(size));
+            if (m_readyOffset < size)
+                continue;
+        }
+        m_ready.erase(it);
+        m_readyOffset = 0;
+        ++m_nextDeliver;
+        schedule();
+    }
+}
+
+void HlsReader::chooseVariant()
+{
+    // fMP4 с init-сегментом посреди потока декодер не переварит
+    if (m_variants.size() < 2 || m_initUrl.isValid())
+        return;
+
+    const double budget = m_bandwidth * 0.75;
+    int best = 0;
+    for (int i = 0; i < m_variants.size(); ++i) {
+        if (m_variants.at(i).bandwidth <= budget)
+            best = i;
+    }
+    // Вниз — сразу, вверх — только по нескольким замерам
+    if (best > m_variant && m_samples < 3)
+        return;
+    if (best != m_variant)
+        switchVariant(best);
+}
+
+void HlsReader::switchVariant(int index)
+{
+    if (m_variant >= 0)
+        qDebug() << "[HlsReader] Switching variant" << m_variants.at(m_variant).bandwidth
+                 << "->" << m_variants.at(index).bandwidth << "bps, measured" << qint64(m_bandwidth);
+    m_variant = index;
+    m_mediaUrl = m_variants.at(index).url;
+    m_samples = 0;
+
+    // Незапрошенные сегменты старого варианта берём из нового по тем же номерам
+    // (RFC 8216 требует выровненных номеров между вариантами)
+    if (!m_queue.isEmpty()) {
+        m_lastQueued = m_queue.first().seq - 1;
+        m_queue.clear();
+    }
+
+    if (m_playlistReply) {
+        m_playlistReply->disconnect(this);
+        m_playlistReply->abort();
+        m_playlistReply->deleteLater();
+        m_playlistReply = nullptr;
+    }
+    m_refresh->stop();
+    fetchPlaylist();
+}
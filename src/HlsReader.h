@@ -0,0 +1,116 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QSharedPointer>
+#include <QUrl>
+
+class TimeShiftBuffer;
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+// HlsReader — HLS-источник для StreamPlayer, живёт в том же рабочем потоке,
+// что и IcyReader, и с теми же сигналами подключения. Разбирает master- и
+// media-плейлисты, вариант выбирает по измеренной пропускной способности
+// (старт с самого лёгкого — быстрее первый звук), сегменты качает вперёд,
+// до maxParallel одновременно. Плейлист живого эфира перечитывается раз в
+// target duration, в очередь попадают только новые номера сегментов.
+// В TimeShiftBuffer сегменты уходят по порядку и порциями в темпе эфира, чтобы
+// декодер не переполнил кольцо PCM; остальное ждёт в памяти сжатым —
+// этот запас и переживает короткие провалы сети (поэтому джиттер, как
+// IcyReader, не сообщает: глубину кольца он не должен раздувать).
+// Окно закрывает (finish()) только конец плейлиста (ENDLIST); сбой и stop()
+// оставляют его StreamPlayer — для перехода на зеркало.
+class HlsReader : public QObject {
+    Q_OBJECT
+public:
+    explicit HlsReader(QObject* parent = nullptr);
+
+    static bool isHlsUrl(const QUrl& url);
+
+    // Вызываются до start(): глубина загрузки вперёд и опережение эфира
+    void setMaxParallel(int n) { m_maxParallel = qMax(1, n); }
+    void setLeadMs(int ms)     { m_leadMs = qMax(1000, ms); }
+
+    void start(int session, const QUrl& url, QSharedPointer<TimeShiftBuffer> store);
+    void stop();
+
+signals:
+    void connected(int session, const QString& contentType, int bitrateKbps);
+    void failed(int session, const QString& error);
+    void finished(int session);
+
+private:
+    struct Variant {
+        QUrl   url;
+        qint64 bandwidth = 0;
+    };
+    struct Segment {
+        qint64 seq = 0;
+        QUrl   url;
+        int    durationMs = 0;
+        int    attempt = 0;
+        qint64 startedMs = 0;  // для замера пропускной способности
+    };
+    struct Ready {
+        QByteArray data;       // пусто — сегмент пропущен
+        int        durationMs = 0;
+    };
+
+    void fetchPlaylist();
+    void onPlaylist();
+    bool parseMaster(const QByteArray& body, const QUrl& base);
+    bool parseMedia(const QByteArray& body, const QUrl& base);
+    void schedule();
+    void fetchSegment(const Segment& seg);
+    void onSegment(QNetworkReply* reply);
+    void retrySegment(Segment seg);
+    void deliver();
+    void chooseVariant();
+    void switchVariant(int index);
+    void fail(const QString& error);
+    qint64 lowestPendingSeq() const;
+
+    QNetworkAccessManager* m_nam = nullptr;      // создаются в рабочем потоке
+    QTimer*                m_refresh = nullptr;
+    QTimer*                m_pace = nullptr;
+    QNetworkReply*         m_playlistReply = nullptr;
+    QSharedPointer<TimeShiftBuffer> m_store;
+    int                    m_session = 0;
+    int                    m_maxParallel = 3;
+    int                    m_leadMs = 8000;
+
+    QList<Variant>  m_variants;          // по возрастанию bandwidth
+    int             m_variant = -1;
+    QUrl            m_mediaUrl;
+    QUrl            m_initUrl;           // EXT-X-MAP (fMP4): без смены вариантов
+    bool            m_announced = false;
+    bool            m_endList = false;
+    int             m_targetMs = 6000;
+    int             m_playlistErrors = 0;
+
+    // Номер сегмента (EXT-X-MEDIA-SEQUENCE) — общий ключ для очереди,
+    // загрузок и доставки; по нему же плейлист обновляется инкрементально
+    QList<Segment>                   m_queue;       // ещё не запрошены
+    QHash<QNetworkReply*, Segment>   m_inflight;
+    QSet<qint64>                     m_retrying;    // ждут повторной загрузки
+    QMap<qint64, Ready>              m_ready;       // скачаны, ждут очереди
+    qint64                           m_lastQueued = -1;
+    qint64                           m_nextDeliver = -1;
+    qsizetype                        m_readyOffset = 0;  // отдано из головы m_ready
+
+    // Темп доставки: сколько эфира отдано против прошедшего времени
+    QElapsedTimer m_clock;
+    qint64        m_deliveredMs = 0;
+    qint64        m_slipMs = 0;
+
+    // Пропускная способность, бит/с (EWMA по сегментам)
+    double        m_bandwidth = 0.0;
+    int           m_samples = 0;
+};
@@ -0,0 +1,263 @@
+#include "IcyReader.h"
+#include "TimeShiftBuffer.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+
+namespace {
+    const int kChunkSize = 64 * 1024;
+    const int kMaxMetaSize = 255 * 16;
+    const int kRaceWidth = 3;
+    const int kRaceStaggerMs = 250;
+}
+
+IcyReader::IcyReader(QObject* parent)
+    : QObject(parent)
+    , m_chunk(kChunkSize, Qt::Uninitialized)
+    , m_meta(kMaxMetaSize, Qt::Uninitialized)
+{
+}
+
+void IcyReader::start(int session, const QList<QUrl>& urls, QSharedPointer<TimeShiftBuffer> store)
+{
+    stop();
+    if (!m_nam) {
+        m_nam = new QNetworkAccessManager(this);
+        m_raceTimer = new QTimer(this);
+        m_raceTimer->setSingleShot(true);
+        connect(m_raceTimer, &QTimer::timeout, this, &IcyReader::startNextCandidate);
+    }
+
+    m_session = session;
+    m_store = store;
+    m_announced = false;
+    m_metaInt = 0;
+    m_audioLeft = 0;
+    m_metaLeft = 0;
+    m_metaLen = 0;
+    m_lastTitle.clear();
+    m_lastArrival = -1;
+    m_lastReport = 0;
+    m_meanGap = 0.0;
+    m_jitter = 0.0;
+    m_clock.start();
+
+    m_candidates = urls;
+    m_nextCandidate = 0;
+    m_lastError.clear();
+    startNextCandidate();
+}
+
+void IcyReader::startNextCandidate()
+{
+    if (m_reply || m_nextCandidate >= m_candidates.size())
+        return;
+    const int index = m_nextCandidate++;
+    const QUrl url = m_candidates.at(index);
+
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setHeader(QNetworkRequest::UserAgentHeader, QStringLiteral("LoraRadio"));
+    request.setRawHeader("Icy-MetaData", "1");
+    QNetworkReply *reply = m_nam->get(request);
+    m_racing.insert(reply, index);
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply]() {
+        if (!m_reply && !claim(reply))
+            return;
+        if (reply == m_reply)
+            onReadyRead();
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        if (reply == m_reply)
+            onFinished();
+        else
+            onRacerFinished(reply);
+    });
+    qDebug() << "[IcyReader] Connecting to" << url;
+
+    // Молчит — через паузу параллельно подключаем следующее зеркало
+    if (m_racing.size() < kRaceWidth && m_nextCandidate < m_candidates.size())
+        m_raceTimer->start(kRaceStaggerMs);
+}
+
+bool IcyReader::claim(QNetworkReply* reply)
+{
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status != 0 && (status < 200 || status >= 300))
+        return false;  // тело страницы ошибки — не звук
+
+    const int index = m_racing.take(reply);
+    m_reply = reply;
+    m_raceTimer->stop();
+    abortRacers();
+    if (index > 0)
+        qDebug() << "[IcyReader] Mirror won the race:" << reply->url();
+    emit candidateChosen(m_session, index);
+    return true;
+}
+
+void IcyReader::onRacerFinished(QNetworkReply* reply)
+{
+    m_racing.remove(reply);
+    reply->deleteLater();
+    m_lastError = reply->error() != QNetworkReply::NoError
+                      ? reply->errorString()
+                      : tr("Сервер закрыл поток без данных");
+    qWarning() << "[IcyReader] Candidate failed:" << reply->url() << m_lastError;
+
+    if (m_nextCandidate < m_candidates.size()) {
+        m_raceTimer->stop();
+        startNextCandidate();
+    } else if (m_racing.isEmpty()) {
+        // Гонку проиграли все адреса
+        m_store.reset();
+        emit failed(m_session, m_lastError);
+    }
+}
+
+void IcyReader::abortRacers()
+{
+    // abort() шлёт finished синхронно — сначала отключаемся
+    for (auto it = m_racing.constBegin(); it != m_racing.constEnd(); ++it) {
+        it.key()->disconnect(this);
+        it.key()->abort();
+        it.key()->deleteLater();
+    }
+    m_racing.clear();
+}
+
+void IcyReader::stop()
+{
+    if (m_raceTimer)
+        m_raceTimer->stop();
+    abortRacers();
+    m_candidates.clear();
+    if (m_reply) {
+        m_reply->disconnect(this);
+        m_reply->abort();
+        m_reply->deleteLater();
+        m_reply = nullptr;
+    }
+    m_store.reset();
+}
+
+void IcyReader::onReadyRead()
+{
+    if (!m_announced) {
+        m_announced = true;
+        const QString contentType = m_reply->header(QNetworkRequest::ContentTypeHeader).toString();
+        const int bitrate = m_reply->rawHeader("icy-br").split(',').value(0).trimmed().toInt();
+        // Без заголовка сервер метаданные не вставляет — поток чистый
+        m_metaInt = m_reply->rawHeader("icy-metaint").trimmed().toInt();
+        m_audioLeft = m_metaInt;
+        emit connected(m_session, contentType, bitrate);
+    }
+
+    const qint64 now = m_clock.elapsed();
+    if (m_lastArrival >= 0) {
+        const double gap = double(now - m_lastArrival);
+        m_meanGap += (gap - m_meanGap) / 16.0;
+        m_jitter  += (std::abs(gap - m_meanGap) - m_jitter) / 16.0;
+    }
+    m_lastArrival = now;
+    if (now - m_lastReport >= 1000) {
+        m_lastReport = now;
+        emit jitterMeasured(m_session, int(m_jitter));
+    }
+
+    while (m_reply->bytesAvailable() > 0) {
+        const qint64 n = m_reply->read(m_chunk.data(), m_chunk.size());
+        if (n <= 0)
+            break;
+        consume(m_chunk.constData(), n);
+    }
+}
+
+void IcyReader::consume(const char* data, qint64 len)
+{
+    if (m_metaInt <= 0) {
+        if (m_store)
+            m_store->append(data, len);
+        return;
+    }
+
+    while (len > 0) {
+        if (m_metaLeft > 0) {
+            const int take = int(qMin<qint64>(len, m_metaLeft));
+            std::memcpy(m_meta.data() + m_metaLen, data, size_t(take));
+            m_metaLen  += take;
+            m_metaLeft -= take;
+            data += take;
+            len  -= take;
+            if (m_metaLeft == 0) {
+                handleMetadata(m_meta.constData(), m_metaLen);
+                m_audioLeft = m_metaInt;
+            }
+        } else if (m_audioLeft == 0) {
+            // Байт длины блока; ноль — метаданные не менялись
+            const int size = int(uchar(*data)) * 16;
+            ++data;
+            --len;
+            m_metaLen = 0;
+            m_metaLeft = size;
+            if (size == 0)
+                m_audioLeft = m_metaInt;
+        } else {
+            // Звук уходит в декодер прямо из порции чтения
+            const int take = int(qMin<qint64>(len, m_audioLeft));
+            if (m_store)
+                m_store->append(data, take);
+            m_audioLeft -= take;
+            data += take;
+            len  -= take;
+        }
+    }
+}
+
+void IcyReader::handleMetadata(const char* data, int len)
+{
+    // Блок вида StreamTitle='Artist - Title';StreamUrl='...'; дополнен нулями
+    const std::string_view block(data, size_t(len));
+    const std::string_view key = "StreamTitle='";
+    const size_t start = block.find(key);
+    if (start == std::string_view::npos)
+        return;
+    const size_t from = start + key.size();
+    size_t end = block.find("';", from);
+    if (end == std::string_view::npos)
+        end = block.find_last_of('\'');
+    if (end == std::string_view::npos || end < from)
+        return;
+
+    const std::string_view raw = block.substr(from, end - from);
+    if (raw.size() == size_t(m_lastTitle.size())
+        && std::memcmp(raw.data(), m_lastTitle.constData(), raw.size()) == 0)
+        return;  // тот же трек — обычный случай, без аллокаций
+
+    m_lastTitle = QByteArray(raw.data(), qsizetype(raw.size()));
+    // Кодировку сервер не сообщает: UTF-8, если валиден, иначе Latin-1
+    QString title = QString::fromUtf8(m_lastTitle);
+    if (title.contains(QChar::ReplacementCharacter))
+        title = QString::fromLatin1(m_lastTitle);
+    emit metadata(m_session, title.trimmed(), m_store ? m_store->endPos() : 0);
+}
+
+void IcyReader::onFinished()
+{
+    QNetworkReply *reply = m_reply;
+    m_reply = nullptr;
+    reply->deleteLater();
+    m_store.reset();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        qWarning() << "[IcyReader] Stream failed:" << reply->errorString();
+        emit failed(m_session, reply->errorString());
+    } else {
+        emit finished(m_session);
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QUrl>
+
+class TimeShiftBuffer;
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+// IcyReader — HTTP/ICY-чтение радиопотока в рабочем потоке (свой
+// QNetworkAccessManager). Пишет в TimeShiftBuffer и меряет джиттер прихода
+// данных, по которому StreamPlayer подбирает глубину буфера.
+// Запрашивает ICY-метаданные (Icy-MetaData: 1) и вырезает их блоки из
+// потока на лету, в заранее выделенных буферах; StreamTitle уходит
+// сигналом metadata() только при смене трека.
+// Обрыв и stop() окно не закрывают (finish() — дело StreamPlayer): при
+// переходе на зеркало новое подключение дописывает в тот же TimeShiftBuffer.
+// Без store (пустой указатель) звук отбрасывается, а метаданные разбираются
+// как обычно — так RadioPlayer читает названия треков для QMediaPlayer.
+// session отличает сигналы текущего подключения от запоздавших прошлых.
+// Несколько адресов (зеркала) подключаются в стиле Happy Eyeballs: каждый
+// следующий — если предыдущие молчат 250 мс, не больше трёх сразу; первый,
+// приславший звук, побеждает, остальные обрываются.
+class IcyReader : public QObject {
+    Q_OBJECT
+public:
+    explicit IcyReader(QObject* parent = nullptr);
+
+    void start(int session, const QList<QUrl>& urls, QSharedPointer<TimeShiftBuffer> store);
+    void stop();
+    // Сервер вставляет ICY-метаданные (icy-metaint); известно после connected()
+    bool hasMetadata() const { return m_metaInt > 0; }
+
+signals:
+    void connected(int session, const QString& contentType, int bitrateKbps);
+    // index — какой из адресов start() выиграл гонку
+    void candidateChosen(int session, int index);
+    void jitterMeasured(int session, int jitterMs);
+    void failed(int session, const QString& error);
+    void finished(int session);
+    // streamPos — байт потока, с которого звучит этот трек (для резки записи)
+    void metadata(int session, const QString& title, qint64 streamPos);
+
+private:
+    void startNextCandidate();
+    bool claim(QNetworkReply* reply);
+    void onRacerFinished(QNetworkReply* reply);
+    void abortRacers();
+    void onReadyRead();
+    void onFinished();
+    void consume(const char* data, qint64 len);
+    void handleMetadata(const char* data, int len);
+
+    QNetworkAccessManager*     m_nam = nullptr;  // создаётся в рабочем потоке
+    QNetworkReply*             m_reply = nullptr;   // победитель гонки
+    QHash<QNetworkReply*, int> m_racing;            // ещё без звука -> индекс
+    QList<QUrl>                m_candidates;
+    int                        m_nextCandidate = 0;
+    QTimer*                    m_raceTimer = nullptr;
+    QString                    m_lastError;
+    QSharedPointer<TimeShiftBuffer> m_store;
+    int                        m_session = 0;
+    bool                       m_announced = false;
+
+    // Разбор ICY: icy-metaint байт звука, затем байт длины (×16) и блок
+    // метаданных. Буферы выделены один раз — в пути звука аллокаций нет
+    QByteArray m_chunk;           // порция чтения из ответа
+    QByteArray m_meta;            // блок метаданных, до 255*16 байт
+    QByteArray m_lastTitle;       // StreamTitle последнего блока (сырой)
+    int        m_metaInt = 0;
+    int        m_audioLeft = 0;   // байт звука до следующего блока
+    int        m_metaLeft = 0;    // байт текущего блока ещё не прочитано
+    int        m_metaLen = 0;
+
+    // Оценка джиттера как в RTP (RFC 3550): сглаженное отклонение
+    // интервала между порциями от среднего интервала
+    QElapsedTimer m_clock;
+    qint64        m_lastArrival = -1;
+    qint64        m_lastReport = 0;
+    double        m_meanGap = 0.0;
+    double        m_jitter = 0.0;
+};
@@ -5,8 +5,16 @@
 #include "StationDialog.h"
 #include "AutoStartRegistry.h"
 #include "IconButton.h"
+#include "AppSettings.h"
+#include "StationImporter.h"
+#include "SongHistory.h"
+#include "PlaylistResolver.h"
+#ifdef LORARADIO_HAVE_CATALOG
+#include "DirectoryPage.h"
+#endif
 #include "../include/fluent_icons.h"
-#include <QSettings>
+#include <QFileDialog>
+#include <QProgressDialog>
 #include <QLabel>
 #include <QMenu>
 #include <QListWidget>
@@ -20,46 +28,20 @@
 #include <QMouseEvent>
 #include <QCursor>
 #include <QScreen>
+#include <QShortcut>
+#include <QDir>
+#include <QStandardPaths>
 #include <QDebug>
 using namespace fluent_icons;
 
-namespace {
-    // Найти глобальный индекс N-го элемента типа `type` (nLocal) в общем списке.
-// Возвращает -1 если не найден.
-    static int globalIndexFromLocal(const StationManager* mgr, const QString& type, int nLocal) {
-        if (!mgr || nLocal < 0) return -1;
-        int local = 0;
-        const auto &all = mgr->stations();
-        for (int i = 0; i < all.size(); ++i) {
-            if (all.at(i).type == type) {
-                if (local == nLocal) return i;
-                ++local;
-            }
-        }
-        return -1;
-    }
-
-    // Найти локальный индекс (внутри типа) для глобального индекса.
-// Возвращает -1 если глобальный индекс неверный.
-    static int localIndexFromGlobal(const StationManager* mgr, int globalIdx) {
-        if (!mgr) return -1;
-        const auto &all = mgr->stations();
-        if (globalIdx < 0 || globalIdx >= all.size()) return -1;
-        const QString type = all.at(globalIdx).type;
-        int local = 0;
-        for (int i = 0; i < globalIdx; ++i)
-            if (all.at(i).type == type) ++local;
-        return local;
-    }
-}
-
-
 MainWindow::MainWindow(StationManager* stations,
                        AbstractPlayer* player,
                        QWidget* parent)
     : QMainWindow(parent)
     , m_stations(stations)
     , m_player(player)
+    , m_history(new SongHistory(QString(), this))
+    , m_resolver(new PlaylistResolver(QString(), this))
 {
     setupUi();
     setupTray();
@@ -72,24 +54,21 @@ MainWindow::MainWindow(StationManager* stations,
     modeTabBar->setCurrentIndex(0);
     m_lastModeIndex = modeTabBar->currentIndex();
 
-    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "MyApp", "LoraRadio");
-
-    m_lastMode = settings.value("lastMode", 0).toInt();
+    m_lastMode = AppSettings::instance()->lastMode();
+    if (m_lastMode < 0 || m_lastMode >= modeTabBar->count())
+        m_lastMode = 0;  // вкладки каталога может не быть в этой сборке
     modeTabBar->setCurrentIndex(m_lastMode);
     modeStack->setCurrentIndex(m_lastMode);
 
-    // Загружаем список (в очередь, чтобы не блокировать конструктор)
-    QMetaObject::invokeMethod(m_stations, "load", Qt::QueuedConnection);
+    // Список уже загружен конструктором StationManager (со слепка — мгновенно),
+    // повторная загрузка лишь сбрасывала бы модели
 
     // Восстанавливаем последний индекс для текущего типа (по вкладке)
-    QString type = (modeStack && modeStack->currentIndex() == 0) ? QStringLiteral("radio") : QStringLiteral("youtube");
-    int lastLocal = m_stations->lastStationIndex(type);
-    QMetaObject::invokeMethod(this, [this, lastLocal, type]() {
-        int global = globalIndexFromLocal(m_stations, type, lastLocal);
-        if (global >= 0) {
-            playStation(global);
-            m_currentGlobalIdx = global;  // Добавьте
-        }
+    const QString type = currentStationType();
+    QMetaObject::invokeMethod(this, [this, type]() {
+        const quint64 lastId = m_stations->lastStationId(type);
+        if (m_stations->stationById(lastId))
+            playStation(lastId);
     }, Qt::QueuedConnection);
 
     setAttribute(Qt::WA_TranslucentBackground);
@@ -115,6 +94,9 @@ void MainWindow::setupUi()
     modeTabBar = new QTabBar;
     modeTabBar->addTab(tr("Radio"));
     modeTabBar->addTab(tr("YouTube"));
+#ifdef LORARADIO_HAVE_CATALOG
+    modeTabBar->addTab(tr("Directory"));
+#endif
     modeTabBar->setExpanding(false);
     modeTabBar->setMovable(false);
 
@@ -146,11 +128,16 @@ void MainWindow::setupUi()
     topPanel->setFixedHeight(32);
 
     // Страницы
-    radioPage = new RadioPage(m_stations, m_player, this);
-    ytPage    = new YouTubePage(m_stations, m_player, this);
+    m_stationModel = new StationModel(m_stations, this);
+    radioPage = new RadioPage(m_stations, m_stationModel, m_player, this);
+    ytPage    = new YouTubePage(m_stations, m_stationModel, m_player, this);
     modeStack = new QStackedWidget;
     modeStack->addWidget(radioPage);
     modeStack->addWidget(ytPage);
+#ifdef LORARADIO_HAVE_CATALOG
+    m_directoryPage = new DirectoryPage(m_stations, this);
+    modeStack->addWidget(m_directoryPage);
+#endif
 
     // Собираем всё вместе в вертикальный лэйаут
     auto *mainLay = new QVBoxLayout;
@@ -179,27 +166,11 @@ void MainWindow::setupTray()
 
     m_autostartAction = menu->addAction(tr("Автозапуск"));
     m_autostartAction->setCheckable(true);
-    {
-        QSettings initSettings(
-            QSettings::IniFormat,
-            QSettings::UserScope,
-            "MyApp",
-            "LoraRadio"
-        );
-        bool enabled = initSettings.value("autostart/enabled", false).toBool();
-        m_autostartAction->setChecked(enabled);
-    }
+    m_autostartAction->setChecked(AppSettings::instance()->autostartEnabled());
 
-    // При переключении — снова локально пишем в INI и sync()
+    // При переключении — запоминаем в AppSettings (запишется в фоне)
     connect(m_autostartAction, &QAction::toggled, this, [=](bool on){
-        QSettings s(
-            QSettings::IniFormat,
-            QSettings::UserScope,
-            "MyApp",
-            "LoraRadio"
-        );
-        s.setValue("autostart/enabled", on);
-        s.sync();
+        AppSettings::instance()->setAutostartEnabled(on);
         AutoStartRegistry::setEnabled(on);
     });
     qDebug() << "setupTray";
@@ -210,7 +181,7 @@ void MainWindow::setupTray()
     m_trayIcon->setContextMenu(menu);
     m_trayIcon->show();
 
-    m_quickPopup = new QuickControlPopup(m_stations, this);
+    m_quickPopup = new QuickControlPopup(m_stations, m_stationModel, this);
     m_quickPopup->setFixedSize(250, 300);
 }
 
@@ -262,17 +233,19 @@ void MainWindow::setupConnections()
     // === Station CRUD (RadioPage → MainWindow)
     connect(radioPage, &RadioPage::playStation, this, &MainWindow::onRadioPlayRequested);
     connect(radioPage, &RadioPage::requestAdd, this, &MainWindow::onAddClicked);
+    connect(radioPage, &RadioPage::requestImport, this, &MainWindow::onImportClicked);
+#ifdef LORARADIO_HAVE_CATALOG
+    // Прослушивание из каталога: URL ещё не станция, громкость не привязываем
+    connect(m_directoryPage, &DirectoryPage::playRequested, this, [this](const QString& url) {
+        m_currentStationId = 0;
+        m_player->play(url);
+    });
+#endif
     connect(radioPage, &RadioPage::requestRemove, this, &MainWindow::onRemoveClicked);
     connect(radioPage, &RadioPage::requestUpdate, this, &MainWindow::onUpdateClicked);
-
-    // 1) При изменениях в StationManager обновляем YouTubePage (показываем только youtube)
-connect(m_stations, &StationManager::stationsChanged, this, [this]() {
-    const QVector<Station> yt = m_stations->stationsForType(QStringLiteral("youtube"));
-    if (ytPage) ytPage->setStations(yt);
-});
-
-const QVector<Station> ytInit = m_stations->stationsForType(QStringLiteral("youtube"));
-if (ytPage) ytPage->setStations(ytInit);
+    // Откат последней правки списка (обратные операции из журнала станций)
+    auto *undoShortcut = new QShortcut(QKeySequence::Undo, this);
+    connect(undoShortcut, &QShortcut::activated, m_stations, &StationManager::undo);
 
 connect(ytPage, &YouTubePage::requestAdd, this, [this]() {
     StationDialog dlg(this);
@@ -280,56 +253,50 @@ connect(ytPage, &YouTubePage::requestAdd, this, [this]() {
         Station st = dlg.station();
         st.type = QStringLiteral("youtube"); // важно: принудительно указываем тип
         m_stations->addStation(st);
-        m_stations->save(); // сохранит и вызовет stationsChanged -> обновит ytPage
     }
 });
 
-    connect(ytPage, &YouTubePage::requestRemove, this, [this](int localIdx) {
-    const QString type = QStringLiteral("youtube");
-    const int global = globalIndexFromLocal(m_stations, type, localIdx);
-
-    if (global < 0) {
-        qWarning() << "[MainWindow] YouTube remove: cannot map local index" << localIdx;
+    connect(ytPage, &YouTubePage::requestRemove, this, [this](quint64 id) {
+    const Station* found = m_stations->stationById(id);
+    if (!found) {
+        qWarning() << "[MainWindow] YouTube remove: unknown station id" << id;
         return;
     }
 
     // ДОБАВИТЬ: Диалог подтверждения удаления
-    const Station& station = m_stations->stations().at(global);
+    const Station station = *found;
 
     QMessageBox msgBox(this);
     msgBox.setWindowTitle(tr("Подтверждение удаления"));
     msgBox.setText(tr("Удалить станцию \"%1\"?").arg(station.name));
-    msgBox.setInformativeText(tr("Это действие нельзя отменить."));
+    msgBox.setInformativeText(tr("Отменить удаление: Ctrl+Z."));
     msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
     msgBox.setDefaultButton(QMessageBox::No);
     msgBox.setIcon(QMessageBox::Warning);
 
     if (msgBox.exec() == QMessageBox::Yes) {
-        m_stations->removeStation(global);
-        m_stations->save();
+        m_stations->removeStation(id);
     }
 });
 
-connect(ytPage, &YouTubePage::requestUpdate, this, [this](int localIdx) {
-    const QString type = QStringLiteral("youtube");
-    const int global = globalIndexFromLocal(m_stations, type, localIdx);
-    if (global < 0) {
-        qWarning() << "[MainWindow] YouTube update: cannot map local index" << localIdx;
+connect(ytPage, &YouTubePage::requestUpdate, this, [this](quint64 id) {
+    const Station* orig = m_stations->stationById(id);
+    if (!orig) {
+        qWarning() << "[MainWindow] YouTube update: unknown station id" << id;
         return;
     }
-    Station orig = m_stations->stations().at(global);
-    StationDialog dlg(orig, this);
+    StationDialog dlg(*orig, this);
     if (dlg.exec() == QDialog::Accepted) {
         Station updated = dlg.station();
-        updated.type = type; // сохраняем тип как youtube
-        m_stations->updateStation(global, updated);
-        m_stations->save();
+        updated.type = QStringLiteral("youtube"); // сохраняем тип как youtube
+        m_stations->updateStation(id, updated);
     }
 });
 
 
     // === Кнопки управления (prev/next/reconnect)
     connect(radioPage, &RadioPage::prev, this, &MainWindow::onPrevClicked);
+    connect(radioPage, &RadioPage::recordToggled, this, &MainWindow::onRecordClicked);
     connect(radioPage, &RadioPage::next, this, &MainWindow::onNextClicked);
     connect(radioPage, &RadioPage::reconnectRequested, this, &MainWindow::onReconnectClicked);
     // === Громкость и mute
@@ -344,12 +311,35 @@ connect(ytPage, &YouTubePage::requestUpdate, this, [this](int localIdx) {
     // === Playback status
     connect(m_player, &AbstractPlayer::playbackStateChanged,
             radioPage, &RadioPage::setPlaybackState);
-    connect(radioPage, &RadioPage::playStation,
-        this, &MainWindow::onRadioPlayRequested);
     connect(m_player, &AbstractPlayer::playbackStateChanged,
             ytPage,    &YouTubePage::setPlaybackState);
     connect(m_player, &AbstractPlayer::playbackStateChanged,
             this,      &MainWindow::onPlaybackStateChanged);
+    connect(m_player, &AbstractPlayer::nowPlayingChanged,
+            this,      &MainWindow::onNowPlayingChanged);
+    // === Плейлисты станций раскрываются асинхронно
+    connect(m_resolver, &PlaylistResolver::resolved, this,
+            [this](quint64 id, const QString&, const QStringList& streams) {
+        if (id == m_currentStationId && m_pendingResolve == id) {
+            m_pendingResolve = 0;
+            // Потоки плейлиста — тоже зеркала; за ними заданные вручную
+            QStringList candidates = streams;
+            if (const Station* st = m_stations->stationById(id))
+                candidates += st->mirrors;
+            candidates.removeDuplicates();
+            m_player->playCandidates(candidates);
+        }
+    });
+    connect(m_resolver, &PlaylistResolver::failed, this,
+            [this](quint64 id, const QString& url, const QString& error) {
+        if (id != m_currentStationId || m_pendingResolve != id)
+            return;
+        // Не разобрали — отдаём плееру как есть, пусть попробует сам
+        qWarning() << "[MainWindow] Playlist resolve failed:" << error << "- playing raw URL";
+        m_pendingResolve = 0;
+        const Station* st = m_stations->stationById(id);
+        m_player->playCandidates(QStringList{ url } + (st ? st->mirrors : QStringList()));
+    });
     // === Volume controls (radio → player)
     connect(radioPage, &RadioPage::volumeChanged,
             m_player,   &AbstractPlayer::setVolume);
@@ -365,26 +355,18 @@ connect(ytPage, &YouTubePage::requestUpdate, this, [this](int localIdx) {
         m_player->stop();
         m_player->play(url);
 
-        // Поиск local index
-        const QVector<Station> yt = m_stations->stationsForType("youtube");
-        int local = -1;
-        for (int i = 0; i < yt.size(); ++i) {
-            if (yt.at(i).url == url) {
-                local = i;
-                break;
-            }
-        }
-        if (local >= 0) {
-            const Station& st = yt.at(local);
-
-            // Исправление: обновляем индекс ПЕРЕД установкой громкости
-            m_currentGlobalIdx = globalIndexFromLocal(m_stations, "youtube", local);
+        const quint64 id = m_stations->idForUrl(url);
+        if (const Station* found = m_stations->stationById(id)) {
+            const Station st = *found;
+            // Исправление: обновляем id ПЕРЕД установкой громкости
+            m_currentStationId = id;
 
             m_player->setVolume(st.volume);
             qDebug() << "[MainWindow] Setting station volume for" << st.url << ":" << st.volume;
 
-            m_stations->setLastStationIndex(local, "youtube");
-            qDebug() << "[MainWindow] Updated last index for youtube to" << local;
+            m_stations->setLastStationId(id);
+            qDebug() << "[MainWindow] Updated last station for youtube to" << id;
+            prepareNeighbours(st);
         } else {
             qWarning() << "[MainWindow] URL not in youtube stations, reconnect may not work as expected";
         }
@@ -411,34 +393,89 @@ connect(ytPage, &YouTubePage::requestUpdate, this, [this](int localIdx) {
 }
 
 
-void MainWindow::playStation(int idx)
+void MainWindow::playStation(quint64 id)
 {
     if (m_isInitializing) {
         qDebug() << "[MainWindow] playStation ignored during init";
         return;
     }
 
-    const auto& list = m_stations->stations();
-    if (idx < 0 || idx >= list.size()) {
-        qWarning() << "[MainWindow] playStation: invalid index" << idx;
+    const Station* found = m_stations->stationById(id);
+    if (!found) {
+        qWarning() << "[MainWindow] playStation: unknown station id" << id;
         return;
     }
-    const Station& st = list.at(idx);
+    const Station st = *found;
     qDebug() << "[MainWindow] Playing station:" << st.name << st.url;
 
-    m_player->play(st.url);
+    // Исправление: обновляем id ПЕРЕД установкой громкости
+    m_currentStationId = id;
+    playResolved(st);
 
-    // Исправление: обновляем индекс ПЕРЕД установкой громкости
-    m_currentGlobalIdx = idx;
-
-    // Устанавливаем громкость после обновления индекса
+    // Устанавливаем громкость после обновления id
     m_player->setVolume(st.volume);
     qDebug() << "[MainWindow] Setting station volume for" << st.url << ":" << st.volume;
 
-    // Сохраняем *локальный* индекс в настройках для данного типа
-    int localIdx = localIndexFromGlobal(m_stations, idx);
-    if (localIdx >= 0) {
-        m_stations->setLastStationIndex(localIdx, st.type);
+    m_stations->setLastStationId(id);
+    prepareNeighbours(st);
+}
+
+void MainWindow::prepareNeighbours(const Station& st)
+{
+    // Соседей по списку подключаем заранее — prev/next переключат мгновенно
+    const quint64 id = st.id;
+    QStringList neighbours;
+    const int local = m_stations->localIndexOf(id);
+    for (int offset : {1, -1}) {
+        if (const Station* n = m_stations->stationById(m_stations->idAt(st.type, local + offset))) {
+            // Ещё не раскрытый плейлист прогревать бессмысленно — тянем его в кэш
+            const QStringList cached = m_resolver->cachedStreams(n->id, n->url);
+            if (!cached.isEmpty())
+                neighbours << cached.first();
+            else if (n->type == QLatin1String("radio") && PlaylistResolver::isPlaylistUrl(QUrl(n->url)))
+                m_resolver->resolve(n->id, n->url);
+            else
+                neighbours << n->url;
+        }
+    }
+
+    if (st.type == QLatin1String("youtube")) {
+        // История: к недавно игравшим возвращаются чаще всего — после соседей
+        QStringList recent = AppSettings::instance()->youtubeRecent();
+        recent.removeAll(st.url);
+        for (const QString& url : std::as_const(recent)) {
+            if (neighbours.size() >= 4)
+                break;
+            if (!neighbours.contains(url) && m_stations->idForUrl(url) != 0)
+                neighbours << url;
+        }
+        recent.prepend(st.url);
+        AppSettings::instance()->setYoutubeRecent(recent.mid(0, 20));
+    }
+    m_player->prepareNext(neighbours);
+}
+
+void MainWindow::playResolved(const Station& st)
+{
+    m_pendingResolve = 0;
+    if (st.type != QLatin1String("radio")) {
+        m_player->play(st.url);
+        return;
+    }
+
+    const QStringList cached = m_resolver->cachedStreams(st.id, st.url);
+    if (!cached.isEmpty()) {
+        QStringList candidates = cached + st.mirrors;
+        candidates.removeDuplicates();
+        m_player->playCandidates(candidates);
+    } else if (PlaylistResolver::isPlaylistUrl(QUrl(st.url))) {
+        // Играть начнём по сигналу resolved/failed
+        m_pendingResolve = st.id;
+        m_player->stop();
+        m_resolver->resolve(st.id, st.url);
+    } else {
+        // Зеркала подключаются наперегонки, проигравшие — запас на обрыв
+        m_player->playCandidates(st.urls());
     }
 }
 
@@ -452,47 +489,61 @@ void MainWindow::onPlaybackStateChanged(bool isPlaying)
 
 }
 
-void MainWindow::onPlayClicked()
+void MainWindow::onNowPlayingChanged(const QString& title)
 {
-    m_player->togglePlayback();
-}
+    const Station* st = m_stations->stationById(m_currentStationId);
+    const QString station = st ? st->name : QString();
 
-void MainWindow::onRadioPlayRequested(int localIdx) {
-    if (localIdx < 0) return;
-    const QString type = QStringLiteral("radio");
-    const int global = globalIndexFromLocal(m_stations, type, localIdx);
-    if (global < 0) return;
-    const Station& st = m_stations->stations().at(global);
+    radioPage->setNowPlaying(title);
+    if (title.isEmpty())
+        m_trayIcon->setToolTip(station.isEmpty() ? QStringLiteral("LoraRadio") : station);
+    else
+        m_trayIcon->setToolTip(station.isEmpty() ? title : station + QStringLiteral("\n") + title);
 
-    m_player->play(st.url);
+    m_history->append(station, title);
+}
 
-    // Исправление: обновляем индекс ПЕРЕД установкой громкости
-    m_currentGlobalIdx = global;
+void MainWindow::onRecordClicked()
+{
+    if (m_player->isRecording()) {
+        m_player->stopRecording();
+        return;
+    }
+    QString dir = AppSettings::instance()->radioRecordDir();
+    if (dir.isEmpty())
+        dir = QDir(QStandardPaths::writableLocation(QStandardPaths::MusicLocation)).filePath(QStringLiteral("LoraRadio"));
+    const Station* st = m_stations->stationById(m_currentStationId);
+    if (!m_player->startRecording(dir, st ? st->name : QString()))
+        qWarning() << "[MainWindow] Recording is not available for the current stream";
+}
 
-    m_player->setVolume(st.volume);
-    qDebug() << "[MainWindow] Setting station volume for" << st.url << ":" << st.volume;
+void MainWindow::onPlayClicked()
+{
+    m_player->togglePlayback();
+}
+
+QString MainWindow::currentStationType() const
+{
+    // Каталог наполняет радио-избранное, поэтому навигация там — по радио
+    return (modeStack && modeStack->currentIndex() == 1) ? QStringLiteral("youtube") : QStringLiteral("radio");
+}
 
-    m_stations->setLastStationIndex(localIdx, type);
+void MainWindow::onRadioPlayRequested(quint64 id) {
+    playStation(id);
 }
 
 void MainWindow::onPrevClicked() {
-    QString type = (modeStack && modeStack->currentIndex() == 0) ? QStringLiteral("radio") : QStringLiteral("youtube");
-    int local = m_stations->lastStationIndex(type);
+    const QString type = currentStationType();
+    int local = m_stations->localIndexOf(m_stations->lastStationId(type));
     qDebug() << "[Prev] lastLocalIndex =" << local << "type=" << type;
     if (local > 0) {
-        local--;
-        int global = globalIndexFromLocal(m_stations, type, local);
-        if (global >= 0) {
-            m_stations->setLastStationIndex(local, type);
-            const auto& st = m_stations->stations().at(global);
-            m_player->play(st.url);
-            m_currentGlobalIdx = global;
-            m_player->setVolume(st.volume);
-            qDebug() << "[MainWindow] Setting station volume for" << st.url << ":" << st.volume;
+        const quint64 id = m_stations->idAt(type, local - 1);
+        if (id != 0) {
+            playStation(id);
             if (type == "radio") {
-                radioPage->setCurrentStation(local);
+                radioPage->setCurrentStation(id);
             } else {
-                ytPage->setCurrentStation(local);  // Assuming similar slot added to YouTubePage
+                ytPage->setCurrentStation(id);
             }
         }
     } else {
@@ -501,31 +552,21 @@ void MainWindow::onPrevClicked() {
 }
 
 void MainWindow::onNextClicked() {
-    QString type = (modeStack && modeStack->currentIndex() == 0) ? QStringLiteral("radio") : QStringLiteral("youtube");
-    int local = m_stations->lastStationIndex(type);
+    const QString type = currentStationType();
+    int local = m_stations->localIndexOf(m_stations->lastStationId(type));
     qDebug() << "[Next] lastLocalIndex =" << local << "type=" << type;
-    int countLocal = m_stations->stationsForType(type).size();
+    int countLocal = m_stations->countForType(type);
     if (local < 0 && countLocal > 0) {
         local = 0;
     }
     if (local >= 0 && local + 1 < countLocal) {
-        local++;
-        int global = globalIndexFromLocal(m_stations, type, local);
-        if (global >= 0) {
-            m_stations->setLastStationIndex(local, type);
-            const auto& st = m_stations->stations().at(global);
-            m_player->play(st.url);
-
-            // Исправление: обновляем индекс ПЕРЕД установкой громкости
-            m_currentGlobalIdx = global;
-
-            m_player->setVolume(st.volume);
-            qDebug() << "[MainWindow] Setting station volume for" << st.url << ":" << st.volume;
-
+        const quint64 id = m_stations->idAt(type, local + 1);
+        if (id != 0) {
+            playStation(id);
             if (type == "radio") {
-                radioPage->setCurrentStation(local);
+                radioPage->setCurrentStation(id);
             } else {
-                ytPage->setCurrentStation(local);
+                ytPage->setCurrentStation(id);
             }
         }
     } else {
@@ -534,28 +575,16 @@ void MainWindow::onNextClicked() {
 }
 
 void MainWindow::onReconnectClicked() {
-    QString type = (modeStack->currentIndex() == 0) ? "radio" : "youtube";
-    int local = m_stations->lastStationIndex(type);
-    qDebug() << "[MainWindow] Reconnect: type=" << type << "lastLocalIndex=" << local;
-    if (local < 0) {
-        qWarning() << "[MainWindow] reconnect: no last index for type" << type;
-        return;
-    }
-    int global = globalIndexFromLocal(m_stations, type, local);
-    if (global < 0 || global >= m_stations->stations().size()) {
-        qWarning() << "[MainWindow] reconnect invalid global index" << global;
+    const QString type = currentStationType();
+    const quint64 id = m_stations->lastStationId(type);
+    qDebug() << "[MainWindow] Reconnect: type=" << type << "lastId=" << id;
+    if (!m_stations->stationById(id)) {
+        qWarning() << "[MainWindow] reconnect: no last station for type" << type;
         return;
     }
-    const auto& st = m_stations->stations().at(global);
-    qDebug() << "[MainWindow] Reconnect playing URL:" << st.url;
-
-    m_player->play(st.url);
-
-    // Исправление: обновляем индекс ПЕРЕД установкой громкости
-    m_currentGlobalIdx = global;
-
-    m_player->setVolume(st.volume);
-    qDebug() << "[MainWindow] Setting station volume for" << st.url << ":" << st.volume;
+    // Ручное переподключение — повод заново раскрыть плейлист
+    m_resolver->invalidate(id);
+    playStation(id);
 }
 
 void MainWindow::onVolumeChanged(int value)
@@ -566,16 +595,10 @@ void MainWindow::onVolumeChanged(int value)
 
 void MainWindow::onPlayerVolumeChanged(int value)
 {
-    if (m_isInitializing || m_currentGlobalIdx < 0) return;
+    if (m_isInitializing) return;
 
-    Station st = m_stations->stations().at(m_currentGlobalIdx);
-    qDebug() << "[MainWindow] onPlayerVolumeChanged: idx=" << m_currentGlobalIdx << "url=" << st.url << "old_volume=" << st.volume << "new=" << value;
-
-    if (st.volume == value) return;
-
-    st.volume = value;
-    m_stations->saveStationVolume(st);
-    m_stations->updateStation(m_currentGlobalIdx, st);
+    // Вызывается на каждый тик ползунка: только память, запись — после паузы
+    m_stations->setStationVolume(m_currentStationId, value);
 }
 
 void MainWindow::onVolumeMuteClicked()
@@ -593,48 +616,92 @@ void MainWindow::onAddClicked()
 {
     StationDialog dlg(this);
     if (dlg.exec() == QDialog::Accepted) {
-        m_stations->addStation(dlg.station());
-        m_stations->save();
+        Station st = dlg.station();
+        st.type = QStringLiteral("radio");
+        m_stations->addStation(st);
     }
 }
 
-void MainWindow::onRemoveClicked(int idx)
+void MainWindow::onImportClicked()
 {
-    const auto& list = m_stations->stations();
-    if (idx < 0 || idx >= list.size()) {
-        qWarning() << "[MainWindow] onRemoveClicked: invalid index" << idx;
+    if (m_importer && m_importer->isRunning())
+        return;
+
+    const QString path = QFileDialog::getOpenFileName(
+        this, tr("Импорт станций"), QString(),
+        tr("Списки станций (*.m3u *.m3u8 *.pls *.xspf *.json);;Все файлы (*)"));
+    if (path.isEmpty())
+        return;
+
+    if (!m_importer)
+        m_importer = new StationImporter(this);
+
+    // Разбор идёт в пуле потоков — окно не блокируется
+    auto *progress = new QProgressDialog(tr("Импорт станций..."), tr("Отмена"), 0, 100, this);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(300);
+    progress->setAutoClose(false);
+    progress->setValue(0);
+
+    connect(progress, &QProgressDialog::canceled, m_importer, &StationImporter::cancel);
+    connect(m_importer, &StationImporter::progress, progress, [progress](qint64 done, qint64 total) {
+        progress->setValue(total > 0 ? int(done * 100 / total) : 0);
+    });
+    connect(m_importer, &StationImporter::finished, progress,
+            [this, progress](const QVector<Station>& imported, bool canceled) {
+        progress->close();
+        if (canceled)
+            return;
+        const int added = m_stations->addStations(imported);
+        QMessageBox::information(this, tr("Импорт станций"), tr("Добавлено станций: %1").arg(added));
+    });
+    connect(m_importer, &StationImporter::failed, progress, [this, progress](const QString& error) {
+        progress->close();
+        QMessageBox::warning(this, tr("Импорт станций"), tr("Не удалось импортировать файл: %1").arg(error));
+    });
+
+    m_importer->start(path, QStringLiteral("radio"), m_stations->stations());
+}
+
+void MainWindow::onRemoveClicked(quint64 id)
+{
+    const Station* found = m_stations->stationById(id);
+    if (!found) {
+        qWarning() << "[MainWindow] onRemoveClicked: unknown station id" << id;
         return;
     }
 
-    const Station& station = list.at(idx);
+    const Station station = *found;
 
     // Диалог подтверждения удаления
     QMessageBox msgBox(this);
     msgBox.setWindowTitle(tr("Подтверждение удаления"));
     msgBox.setText(tr("Удалить станцию \"%1\"?").arg(station.name));
-    msgBox.setInformativeText(tr("Это действие нельзя отменить."));
+    msgBox.setInformativeText(tr("Отменить удаление: Ctrl+Z."));
     msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
     msgBox.setDefaultButton(QMessageBox::No);
     msgBox.setIcon(QMessageBox::Warning);
 
 
     if (msgBox.exec() == QMessageBox::Yes) {
-        m_stations->removeStation(idx);
-        m_stations->save();
+        m_stations->removeStation(id);
     }
 }
 
-void MainWindow::onUpdateClicked(int idx)
+void MainWindow::onUpdateClicked(quint64 id)
 {
-    const auto& list = m_stations->stations();
-    if (idx < 0 || idx >= list.size()) {
-        qWarning() << "[MainWindow] onUpdateClicked: invalid index" << idx;
+    const Station* orig = m_stations->stationById(id);
+    if (!orig) {
+        qWarning() << "[MainWindow] onUpdateClicked: unknown station id" << id;
         return;
     }
-    StationDialog dlg(list.at(idx), this);
+    const QString type = orig->type;
+    StationDialog dlg(*orig, this);
     if (dlg.exec() == QDialog::Accepted) {
-        m_stations->updateStation(idx, dlg.station());
-        m_stations->save();
+        Station updated = dlg.station();
+        updated.type = type;
+        m_stations->updateStation(id, updated);
     }
 }
 
@@ -642,33 +709,27 @@ void MainWindow::onModeChanged(int newIndex)
 {
     if (newIndex == m_lastModeIndex) return;
 
-    // Останавливаем плеер на странице, с которой уходим
-    if (m_lastModeIndex == 0) {
-        // уходили с Radio
-        if (radioPage) radioPage->stopPlayback();
-    } else if (m_lastModeIndex == 1) {
-        // уходили с YouTube
-        if (ytPage) ytPage->stopPlayback();
+    // Останавливаем плеер страницы, с которой ушли на другую страницу плеера.
+    // Каталог (вкладка 2) воспроизведение не прерывает — там только выбирают
+    // станции, поэтому m_lastModeIndex помнит последнюю страницу плеера
+    if (newIndex <= 1) {
+        if (m_lastModeIndex == 0) {
+            // уходили с Radio
+            if (radioPage) radioPage->stopPlayback();
+        } else if (m_lastModeIndex == 1) {
+            // уходили с YouTube
+            if (ytPage) ytPage->stopPlayback();
+        }
+        m_lastModeIndex = newIndex;
     }
 
-    // Обновляем индекс последней активной вкладки
-    m_lastModeIndex = newIndex;
-    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "MyApp", "LoraRadio");
-    settings.setValue("lastMode", newIndex);
-    settings.sync();
+    AppSettings::instance()->setLastMode(newIndex);
 }
 
 void MainWindow::switchLanguage(QAction* action)
 {
     const QString langCode = action->data().toString();
-    QSettings settings(
-        QSettings::IniFormat,
-        QSettings::UserScope,
-        "MyApp",
-        "LoraRadio"
-    );
-    settings.setValue("language", langCode);
-    settings.sync();
+    AppSettings::instance()->setLanguage(langCode);
 
     QMessageBox::information(
         this,
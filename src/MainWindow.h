@@ -7,6 +7,7 @@
 #include <QStackedWidget>
 #include <QToolButton>
 #include "StationManager.h"
+#include "StationModel.h"
 #include "../include/AbstractPlayer.h"
 #include "QuickControlPopup.h"
 #include "SwitchPlayer.h"
@@ -17,8 +18,12 @@ class QSlider;
 class QSpinBox;
 class IconButton;
 class QuickControlPopup;
+class StationImporter;
 class RadioPage;
 class YouTubePage;
+class DirectoryPage;
+class SongHistory;
+class PlaylistResolver;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -36,13 +41,14 @@ protected:
     void closeEvent(QCloseEvent* event) override;
 
 private slots:
-    void playStation(int index);
+    void playStation(quint64 id);
     void onPlaybackStateChanged(bool isPlaying);
     void onVolumeChanged(int value);
     void onVolumeMuteClicked();
     void onAddClicked();
-    void onRemoveClicked(int idx);
-    void onUpdateClicked(int idx);
+    void onImportClicked();
+    void onRemoveClicked(quint64 id);
+    void onUpdateClicked(quint64 id);
     void onPrevClicked();
     void onPlayClicked();
     void onNextClicked();
@@ -50,26 +56,37 @@ private slots:
     void onTrayActivated(QSystemTrayIcon::ActivationReason reason);
     void switchLanguage(QAction* action);
     void onModeChanged(int newIndex);
-    void onRadioPlayRequested(int localIdx);
+    void onRadioPlayRequested(quint64 id);
     void onPlayerVolumeChanged(int value);
+    void onNowPlayingChanged(const QString& title);
+    void onRecordClicked();
 
 private:
     void setupUi();
     void setupTray();
     void setupConnections();
+    QString currentStationType() const;
+    void playResolved(const Station& st);
+    void prepareNeighbours(const Station& st);
     int m_lastModeIndex = 0;
     bool m_isInitializing = true;
     int m_lastMode = 0;// 0 - Radio, 1 - YouTube
-    int m_currentGlobalIdx = -1;
+    quint64 m_currentStationId = 0;
+    quint64 m_pendingResolve = 0;  // станция, ждущая раскрытия плейлиста
 
     QTabBar            *modeTabBar;
     QStackedWidget     *modeStack;
     RadioPage          *radioPage;
     YouTubePage        *ytPage;
+    DirectoryPage      *m_directoryPage = nullptr;
 
 
     StationManager     *m_stations;
+    StationModel       *m_stationModel;
+    StationImporter    *m_importer = nullptr;
     AbstractPlayer     *m_player;
+    SongHistory        *m_history;
+    PlaylistResolver   *m_resolver;
     QListWidget        *m_listWidget;
     QSlider            *m_volumeSlider;
     QSpinBox           *m_volumeSpin;
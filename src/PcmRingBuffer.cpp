@@ -0,0 +1,64 @@
+#include "PcmRingBuffer.h"
+#include <cstring>
+
+void PcmRingBuffer::reset(qsizetype capacity)
+{
+    m_data = QByteArray(capacity, '\0');
+    clear();
+}
+
+void PcmRingBuffer::clear()
+{
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+}
+
+qsizetype PcmRingBuffer::available() const
+{
+    return qsizetype(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+}
+
+qsizetype PcmRingBuffer::write(const char* data, qsizetype len)
+{
+    const qsizetype cap = m_data.size();
+    if (cap == 0)
+        return 0;
+
+    const quint64 head = m_head.load(std::memory_order_relaxed);
+    const quint64 tail = m_tail.load(std::memory_order_acquire);
+    const qsizetype n = qMin(len, cap - qsizetype(head - tail));
+    if (n <= 0)
+        return 0;
+
+    // Запись может перейти через конец буфера — максимум два куска
+    const qsizetype pos = qsizetype(head % quint64(cap));
+    const qsizetype first = qMin(n, cap - pos);
+    char *buf = m_data.data();
+    std::memcpy(buf + pos, data, size_t(first));
+    std::memcpy(buf, data + first, size_t(n - first));
+
+    m_head.store(head + quint64(n), std::memory_order_release);
+    return n;
+}
+
+qsizetype PcmRingBuffer::read(char* data, qsizetype len)
+{
+    const qsizetype cap = m_data.size();
+    if (cap == 0)
+        return 0;
+
+    const quint64 tail = m_tail.load(std::memory_order_relaxed);
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    const qsizetype n = qMin(len, qsizetype(head - tail));
+    if (n <= 0)
+        return 0;
+
+    const qsizetype pos = qsizetype(tail % quint64(cap));
+    const qsizetype first = qMin(n, cap - pos);
+    const char *buf = m_data.constData();
+    std::memcpy(data, buf + pos, size_t(first));
+    std::memcpy(data + first, buf, size_t(n - first));
+
+    m_tail.store(tail + quint64(n), std::memory_order_release);
+    return n;
+}
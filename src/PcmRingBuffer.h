@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QByteArray>
+#include <atomic>
+
+// PcmRingBuffer — кольцевой буфер PCM без блокировок на одного писателя
+// (декодер) и одного читателя (поток QAudioSink). Память выделяется один
+// раз в reset(), дальше в горячем пути ни аллокаций, ни мьютексов.
+class PcmRingBuffer {
+public:
+    PcmRingBuffer() = default;
+
+    // Только когда ни писатель, ни читатель не работают
+    void reset(qsizetype capacity);
+    void clear();
+
+    qsizetype write(const char* data, qsizetype len);  // сколько поместилось
+    qsizetype read(char* data, qsizetype len);         // сколько прочитано
+
+    qsizetype available() const;
+    qsizetype capacity() const { return m_data.size(); }
+
+private:
+    QByteArray m_data;
+    // Счётчики байт за всё время; позиция в буфере — по модулю ёмкости
+    std::atomic<quint64> m_head{0};  // записано
+    std::atomic<quint64> m_tail{0};  // прочитано
+};
@@ -0,0 +1,241 @@
+#include "PlaylistResolver.h"
+#include "BackgroundWriter.h"
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QXmlStreamReader>
+#include <QDebug>
+
+namespace {
+    // Плейлист — это килобайты; больше — значит, под видом плейлиста поток
+    const qint64 kMaxPlaylistBytes = 256 * 1024;
+    const int    kMaxDepth = 2;
+    const int    kTimeoutMs = 8000;
+
+    bool isPlaylistContentType(const QString& type)
+    {
+        const QString t = type.section(QLatin1Char(';'), 0, 0).trimmed().toLower();
+        return t.contains(QLatin1String("mpegurl")) || t.contains(QLatin1String("scpls"))
+            || t == QLatin1String("video/x-ms-asf") || t == QLatin1String("video/x-ms-asx")
+            || t.contains(QLatin1String("xspf")) || t.startsWith(QLatin1String("text/"))
+            || t == QLatin1String("application/octet-stream");  // неоднозначно — решит лимит размера
+    }
+}
+
+PlaylistResolver::PlaylistResolver(const QString& cachePath, QObject* parent)
+    : QObject(parent)
+    , m_nam(new QNetworkAccessManager(this))
+    , m_writer(new BackgroundWriter(QStringLiteral("ResolverWriter"), 1000, this))
+    , m_cachePath(cachePath)
+{
+    if (m_cachePath.isEmpty()) {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+        QDir().mkpath(dir);
+        m_cachePath = QDir(dir).filePath(QStringLiteral("resolved.json"));
+    }
+    load();
+}
+
+bool PlaylistResolver::isPlaylistUrl(const QUrl& url)
+{
+    const QString path = url.path().toLower();
+    return path.endsWith(QLatin1String(".pls")) || path.endsWith(QLatin1String(".m3u"))
+        || path.endsWith(QLatin1String(".m3u8")) || path.endsWith(QLatin1String(".asx"))
+        || path.endsWith(QLatin1String(".xspf"));
+}
+
+QStringList PlaylistResolver::cachedStreams(quint64 stationId, const QString& url) const
+{
+    auto it = m_cache.constFind(stationId);
+    if (it == m_cache.constEnd() || it->source != url)
+        return {};
+    if (it->resolvedAt.secsTo(QDateTime::currentDateTimeUtc()) > m_ttlSecs)
+        return {};
+    return it->streams;
+}
+
+void PlaylistResolver::invalidate(quint64 stationId)
+{
+    if (m_cache.remove(stationId))
+        save();
+}
+
+void PlaylistResolver::resolve(quint64 stationId, const QString& url)
+{
+    const QStringList cached = cachedStreams(stationId, url);
+    if (!cached.isEmpty()) {
+        emit resolved(stationId, url, cached);
+        return;
+    }
+    if (QNetworkReply *old = m_pending.take(stationId)) {
+        old->disconnect(this);
+        old->abort();
+        old->deleteLater();
+    }
+    fetch(stationId, url, QUrl(url), 0);
+}
+
+void PlaylistResolver::fetch(quint64 stationId, const QString& source, const QUrl& url, int depth)
+{
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setHeader(QNetworkRequest::UserAgentHeader, QStringLiteral("LoraRadio"));
+    request.setTransferTimeout(kTimeoutMs);
+    QNetworkReply *reply = m_nam->get(request);
+    m_pending.insert(stationId, reply);
+
+    // Прямой поток под видом плейлиста: по типу ответа сразу отдаём как есть
+    connect(reply, &QNetworkReply::metaDataChanged, this, [this, reply, stationId, source, url]() {
+        const QString type = reply->header(QNetworkRequest::ContentTypeHeader).toString();
+        if (type.isEmpty() || isPlaylistContentType(type))
+            return;
+        m_pending.remove(stationId);
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+        finish(stationId, source, { url.toString() });
+    });
+    connect(reply, &QNetworkReply::downloadProgress, this, [this, reply, stationId, source, url](qint64 received, qint64) {
+        if (received <= kMaxPlaylistBytes)
+            return;
+        m_pending.remove(stationId);
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+        finish(stationId, source, { url.toString() });
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply, stationId, source, url, depth]() {
+        m_pending.remove(stationId);
+        reply->deleteLater();
+        if (reply->error() != QNetworkReply::NoError) {
+            qWarning() << "[PlaylistResolver] Fetch failed:" << url << reply->errorString();
+            emit failed(stationId, source, reply->errorString());
+            return;
+        }
+
+        const QByteArray body = reply->readAll();
+        // HLS — сам по себе поток, а не обёртка
+        if (body.contains("#EXT-X-")) {
+            finish(stationId, source, { url.toString() });
+            return;
+        }
+
+        const QStringList streams = parse(body, reply->url());
+        if (streams.isEmpty()) {
+            emit failed(stationId, source, tr("Плейлист пуст"));
+            return;
+        }
+        // Плейлист, ссылающийся на плейлист, — раскрываем ещё уровень
+        if (depth + 1 < kMaxDepth && isPlaylistUrl(QUrl(streams.first()))) {
+            fetch(stationId, source, QUrl(streams.first()), depth + 1);
+            return;
+        }
+        finish(stationId, source, streams);
+    });
+}
+
+void PlaylistResolver::finish(quint64 stationId, const QString& source, const QStringList& streams)
+{
+    Entry &e = m_cache[stationId];
+    e.source = source;
+    e.streams = streams;
+    e.resolvedAt = QDateTime::currentDateTimeUtc();
+    save();
+    qDebug() << "[PlaylistResolver] Resolved" << source << "->" << streams.size() << "stream(s)";
+    emit resolved(stationId, source, streams);
+}
+
+QStringList PlaylistResolver::parse(const QByteArray& body, const QUrl& base)
+{
+    QStringList out;
+    auto add = [&](const QString& value) {
+        const QString trimmed = value.trimmed();
+        if (trimmed.isEmpty()) return;
+        const QString url = base.resolved(QUrl(trimmed)).toString();
+        if (!out.contains(url))
+            out << url;
+    };
+
+    const QByteArray head = body.left(256).trimmed().toLower();
+    if (head.startsWith("<?xml") || head.startsWith("<asx") || head.startsWith("<playlist")) {
+        // ASX часто не валидный XML — ссылки достаём регуляркой
+        static const QRegularExpression refRx(
+            QStringLiteral("<(?:ref|entryref)\\s+href\\s*=\\s*\"([^\"]+)\""),
+            QRegularExpression::CaseInsensitiveOption);
+        const QString text = QString::fromUtf8(body);
+        auto it = refRx.globalMatch(text);
+        while (it.hasNext())
+            add(it.next().captured(1));
+
+        QXmlStreamReader xml(body);
+        while (!xml.atEnd()) {
+            if (xml.readNext() == QXmlStreamReader::StartElement
+                && xml.name().compare(QLatin1String("location"), Qt::CaseInsensitive) == 0)
+                add(xml.readElementText());
+        }
+        return out;
+    }
+
+    const QList<QByteArray> lines = body.split('\n');
+    const bool pls = head.startsWith("[playlist]");
+    for (const QByteArray &raw : lines) {
+        const QByteArray line = raw.trimmed();
+        if (line.isEmpty())
+            continue;
+        if (pls) {
+            const int eq = line.indexOf('=');
+            if (eq > 4 && line.left(4).toLower() == "file")
+                add(QString::fromUtf8(line.mid(eq + 1)));
+        } else if (!line.startsWith('#')) {
+            add(QString::fromUtf8(line));
+        }
+    }
+    return out;
+}
+
+void PlaylistResolver::load()
+{
+    QFile f(m_cachePath);
+    if (!f.open(QIODevice::ReadOnly))
+        return;
+    const QJsonObject root = QJsonDocument::fromJson(f.readAll()).object();
+    for (auto it = root.constBegin(); it != root.constEnd(); ++it) {
+        const QJsonObject o = it.value().toObject();
+        Entry e;
+        e.source = o.value("source").toString();
+        for (const auto v : o.value("streams").toArray())
+            e.streams << v.toString();
+        e.resolvedAt = QDateTime::fromSecsSinceEpoch(o.value("resolvedAt").toInteger()).toUTC();
+        if (!e.streams.isEmpty())
+            m_cache.insert(it.key().toULongLong(), e);
+    }
+}
+
+void PlaylistResolver::save()
+{
+    QJsonObject root;
+    for (auto it = m_cache.constBegin(); it != m_cache.constEnd(); ++it) {
+        QJsonObject o;
+        o.insert("source", it->source);
+        o.insert("streams", QJsonArray::fromStringList(it->streams));
+        o.insert("resolvedAt", it->resolvedAt.toSecsSinceEpoch());
+        root.insert(QString::number(it.key()), o);
+    }
+    const QString path = m_cachePath;
+    const QByteArray data = QJsonDocument(root).toJson(QJsonDocument::Compact);
+    m_writer->schedule([path, data]() {
+        QSaveFile f(path);
+        if (f.open(QIODevice::WriteOnly)) {
+            f.write(data);
+            f.commit();
+        }
+    });
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QStringList>
+#include <QUrl>
+
+class BackgroundWriter;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// PlaylistResolver — раскрытие обёрток-плейлистов (.pls/.m3u/.m3u8/.asx/
+// .xspf) в URL потоков перед play(). Результат кэшируется по станции
+// (id + исходный URL) с TTL в resolved.json, так что повторный запуск
+// станции обходится без лишнего HTTP-запроса; остальные URL из плейлиста
+// хранятся как запасные для переключения при сбое.
+class PlaylistResolver : public QObject {
+    Q_OBJECT
+public:
+    explicit PlaylistResolver(const QString& cachePath = QString(), QObject* parent = nullptr);
+
+    // Только по расширению — прямые потоки не платят за лишний запрос
+    static bool isPlaylistUrl(const QUrl& url);
+
+    // Потоки из кэша (первый — основной); пусто, если записи нет или устарела
+    QStringList cachedStreams(quint64 stationId, const QString& url) const;
+    void resolve(quint64 stationId, const QString& url);
+    void invalidate(quint64 stationId);
+
+    void setTtl(int seconds) { m_ttlSecs = seconds; }
+
+signals:
+    void resolved(quint64 stationId, const QString& url, const QStringList& streams);
+    void failed(quint64 stationId, const QString& url, const QString& error);
+
+private:
+    struct Entry {
+        QString     source;
+        QStringList streams;
+        QDateTime   resolvedAt;
+    };
+
+    void fetch(quint64 stationId, const QString& source, const QUrl& url, int depth);
+    void finish(quint64 stationId, const QString& source, const QStringList& streams);
+    static QStringList parse(const QByteArray& body, const QUrl& base);
+    void load();
+    void save();
+
+    QNetworkAccessManager*   m_nam;
+    BackgroundWriter*        m_writer;
+    QString                  m_cachePath;
+    QHash<quint64, Entry>    m_cache;
+    QHash<quint64, QNetworkReply*> m_pending;  // одна выборка на станцию
+    int                      m_ttlSecs = 12 * 3600;
+};
@@ -1,44 +1,16 @@
 #include "QuickControlPopup.h"
-#include <QListWidget>
+#include <QLineEdit>
+#include <QListView>
 #include <QPushButton>
 #include <QSlider>
 #include <QSpinBox>
 #include <QVBoxLayout>
 #include "StationManager.h"
 
-namespace {
-    // Найти глобальный индекс N-го элемента типа `type` (nLocal) в общем списке.
-    // Возвращает -1 если не найден.
-    static int globalIndexFromLocal(const StationManager* mgr, const QString& type, int nLocal) {
-        if (!mgr || nLocal < 0) return -1;
-        int local = 0;
-        const auto &all = mgr->stations();
-        for (int i = 0; i < all.size(); ++i) {
-            if (all.at(i).type == type) {
-                if (local == nLocal) return i;
-                ++local;
-            }
-        }
-        return -1;
-    }
-
-    // Найти локальный индекс (внутри типа) для глобального индекса.
-    // Возвращает -1 если глобальный индекс неверный.
-    static int localIndexFromGlobal(const StationManager* mgr, int globalIdx) {
-        if (!mgr) return -1;
-        const auto &all = mgr->stations();
-        if (globalIdx < 0 || globalIdx >= all.size()) return -1;
-        const QString type = all.at(globalIdx).type;
-        int local = 0;
-        for (int i = 0; i < globalIdx; ++i)
-            if (all.at(i).type == type) ++local;
-        return local;
-    }
-}
-
-QuickControlPopup::QuickControlPopup(StationManager *stations, QWidget *parent)
+QuickControlPopup::QuickControlPopup(StationManager *stations, StationModel *model, QWidget *parent)
   : QWidget(parent, Qt::Popup | Qt::FramelessWindowHint)
   , m_stations(stations)
+  , m_listModel(new StationTypeModel(model, QStringLiteral("radio"), this))
 {
     setWindowOpacity(0.95);
     setAttribute(Qt::WA_ShowWithoutActivating);
@@ -49,7 +21,14 @@ QuickControlPopup::QuickControlPopup(StationManager *stations, QWidget *parent)
     tabBar->setExpanding(true);
     tabBar->setDrawBase(false);
 
-    listWidget   = new QListWidget(this);
+    filterEdit   = new QLineEdit(this);
+    filterEdit->setPlaceholderText(tr("Поиск"));
+    filterEdit->setClearButtonEnabled(true);
+
+    listView     = new QListView(this);
+    listView->setModel(m_listModel);
+    listView->setUniformItemSizes(true);
+    listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
     btnReconnect = new QPushButton(tr("Переподкл."), this);
     volumeSlider = new QSlider(Qt::Horizontal, this);
     volumeSlider->setRange(0, 100);
@@ -65,18 +44,16 @@ QuickControlPopup::QuickControlPopup(StationManager *stations, QWidget *parent)
     connect(volumeSlider, &QSlider::valueChanged,
             this,         &QuickControlPopup::volumeChanged);
 
-    connect(listWidget, &QListWidget::currentRowChanged,
-            this,       &QuickControlPopup::onStationSelected);
+    connect(listView->selectionModel(), &QItemSelectionModel::currentRowChanged,
+            this, &QuickControlPopup::onStationSelected);
     connect(btnReconnect, &QPushButton::clicked,
             this,         &QuickControlPopup::reconnectRequested);
 
-    connect(m_stations, &StationManager::stationsChanged,
-            this,       &QuickControlPopup::updateStations);
-
     connect(tabBar, &QTabBar::currentChanged,
             this,   &QuickControlPopup::onTabChanged);
-
-    updateStations();
+    connect(filterEdit, &QLineEdit::textChanged, this, [this](const QString& text) {
+        m_listModel->setFilterText(text);
+    });
 
     // Новый горизонтальный layout для кнопки reconnect и громкости (для компактности)
     auto *bottomLayout = new QHBoxLayout;
@@ -88,67 +65,55 @@ QuickControlPopup::QuickControlPopup(StationManager *stations, QWidget *parent)
     auto *lay = new QVBoxLayout(this);
     lay->setContentsMargins(5,5,5,5);
     lay->addWidget(tabBar);
-    lay->addWidget(listWidget);
+    lay->addWidget(filterEdit);
+    lay->addWidget(listView);
     lay->addLayout(bottomLayout);  // Вместо отдельных btn и vol
 }
 
 void QuickControlPopup::onTabChanged(int index)
 {
     m_currentTab = index;
-    updateStations();
+    m_syncingSelection = true;
+    m_listModel->setStationType(index == 0 ? QStringLiteral("radio") : QStringLiteral("youtube"));
+    m_syncingSelection = false;
 }
 
-void QuickControlPopup::onStationSelected(int localIdx)
+void QuickControlPopup::onStationSelected(const QModelIndex &current)
 {
-    if (localIdx < 0) return;
+    if (!current.isValid() || m_syncingSelection || m_listModel->isChanging()) return;
 
-    QString type = (m_currentTab == 0) ? QStringLiteral("radio") : QStringLiteral("youtube");
-    int global = globalIndexFromLocal(m_stations, type, localIdx);
+    const quint64 id = m_listModel->idAt(current.row());
 
-    if (global >= 0) {
-        emit stationSelected(global);
+    if (id != 0) {
+        emit stationSelected(id);
     } else {
-        qWarning() << "[QuickControlPopup] Cannot map local index" << localIdx << "for type" << type;
+        qWarning() << "[QuickControlPopup] Cannot map row" << current.row() << "for type" << m_listModel->stationType();
     }
 }
 
-void QuickControlPopup::setCurrentStation(int globalIdx)
+void QuickControlPopup::selectRow(int row)
+{
+    m_syncingSelection = true;
+    listView->setCurrentIndex(m_listModel->index(row, 0));
+    m_syncingSelection = false;
+}
+
+void QuickControlPopup::setCurrentStation(quint64 id)
 {
-    if (globalIdx < 0 || globalIdx >= m_stations->stations().size()) return;
+    const Station *st = m_stations->stationById(id);
+    if (!st) return;
 
-    const auto &st = m_stations->stations().at(globalIdx);
-    QString type = st.type;
-    int tabIdx = (type == "radio") ? 0 : (type == "youtube") ? 1 : -1;
+    int tabIdx = (st->type == "radio") ? 0 : (st->type == "youtube") ? 1 : -1;
     if (tabIdx < 0) return;
 
     if (tabIdx != m_currentTab) {
         tabBar->setCurrentIndex(tabIdx);
-        // onTabChanged will call updateStations()
+        // onTabChanged will switch the list model type
     }
 
-    int local = localIndexFromGlobal(m_stations, globalIdx);
-
-    if (local >= 0 && local < listWidget->count()) {
-        listWidget->setCurrentRow(local);
-    }
-}
-
-void QuickControlPopup::updateStations()
-{
-    QSignalBlocker blocker(listWidget);
-
-    int cur = listWidget->currentRow();
-
-    listWidget->clear();
-
-    QString type = (m_currentTab == 0) ? QStringLiteral("radio") : QStringLiteral("youtube");
-    auto stations = m_stations->stationsForType(type);
-
-    for (auto &st : stations)
-        listWidget->addItem(st.name);
-
-    if (cur >= 0 && cur < listWidget->count())
-        listWidget->setCurrentRow(cur);
+    const int row = m_listModel->rowOfId(id);
+    if (row >= 0)
+        selectRow(row);
 }
 
 
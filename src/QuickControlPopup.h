@@ -1,15 +1,17 @@
 #pragma once
 #include <QWidget>
 #include <QTabBar>
-#include <QListWidget>
+#include <QListView>
 #include <QPushButton>
 #include <QSlider>
 #include <QSpinBox>
 #include "StationManager.h"
+#include "StationModel.h"
 
 
 
-class QListWidget;
+class QLineEdit;
+class QListView;
 class QPushButton;
 class QSlider;
 class QSpinBox;
@@ -18,27 +20,31 @@ class StationManager;
 class QuickControlPopup : public QWidget {
     Q_OBJECT
 public:
-    explicit QuickControlPopup(StationManager *stations, QWidget *parent = nullptr);
+    explicit QuickControlPopup(StationManager *stations, StationModel *model, QWidget *parent = nullptr);
 public slots:
-    void setCurrentStation(int index);
+    void setCurrentStation(quint64 id);
     void setVolume(int value);
-    void updateStations();
 
     signals:
-        void stationSelected(int index);
+        void stationSelected(quint64 id);
     void reconnectRequested();
     void volumeChanged(int value);
 
 private slots:
     void onTabChanged(int index);
-    void onStationSelected(int localIdx);
+    void onStationSelected(const QModelIndex &current);
 
 private:
+    void selectRow(int row);
+
     QTabBar *tabBar;
     StationManager *m_stations;
-    QListWidget *listWidget;
+    StationTypeModel *m_listModel;
+    QListView *listView;
+    QLineEdit *filterEdit;
     QPushButton *btnReconnect;
     QSlider     *volumeSlider;
     QSpinBox    *volumeSpin;
     int m_currentTab = 0;
+    bool m_syncingSelection = false;
 };
\ No newline at end of file
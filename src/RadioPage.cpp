@@ -1,6 +1,8 @@
 #include "RadioPage.h"
 #include "../include/fluent_icons.h"
-#include <QListWidget>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
 #include <QSlider>
 #include <QSpinBox>
 #include <QHBoxLayout>
@@ -8,34 +10,41 @@
 using namespace fluent_icons;
 
 RadioPage::RadioPage(StationManager* stations,
+                     StationModel* model,
                      AbstractPlayer* player,
                      QWidget* parent)
   : QWidget(parent)
   , m_stations(stations)
   , m_player(player)
-  , m_currentStationIndex(-1)  // ИЗМЕНЕНО: Инициализация
+  , m_listModel(new StationTypeModel(model, QStringLiteral("radio"), this))
+  , m_currentStationId(stations->lastStationId(QStringLiteral("radio")))
 {
     setupUi();
     setupConnections();
     setVolume(m_player->volume());
-    const QVector<Station> radioInit = m_stations->stationsForType(QStringLiteral("radio"));
-    QStringList names;
-    for (const auto& s : radioInit) {
-        names << s.name;
-    }
-    setStations(names);
-
+    restoreCurrentStation();
 }
 
 void RadioPage::setupUi()
 {
-    m_listWidget   = new QListWidget;
+    m_listView     = new QListView;
+    m_listView->setModel(m_listModel);
+    m_listView->setUniformItemSizes(true);
+    m_listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_filterEdit   = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText(tr("Поиск станции"));
+    m_filterEdit->setClearButtonEnabled(true);
+    m_nowPlaying   = new QLabel(this);
+    m_nowPlaying->setObjectName("nowPlaying");
+    m_nowPlaying->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_nowPlaying->hide();
     m_volumeSlider = new QSlider(Qt::Horizontal);
     m_volumeSpin   = new QSpinBox;
     m_volumeSlider->setRange(0,100);
     m_volumeSpin->setRange(0,100);
 
     m_btnAdd       = new IconButton(ic_fluent_add_circle_32_filled,    32, QColor("#FFF"), tr("Добавить"),   this);
+    m_btnImport    = new IconButton(ic_fluent_arrow_download_32_filled, 32, QColor("#FFF"), tr("Импорт"),     this);
     m_btnRemove    = new IconButton(ic_fluent_delete_32_filled,       32, QColor("#FFF"), tr("Удалить"),     this);
     m_btnUpdate    = new IconButton(ic_fluent_edit_32_filled,         32, QColor("#FFF"), tr("Изменить"),    this);
     m_btnPrev      = new IconButton(ic_fluent_previous_32_filled,     32, QColor("#FFF"), tr("Назад"),       this);
@@ -43,11 +52,18 @@ void RadioPage::setupUi()
     m_btnNext      = new IconButton(ic_fluent_next_32_filled,         32, QColor("#FFF"), tr("Далее"),       this);
     m_btnMute      = new IconButton(ic_fluent_speaker_2_32_filled,    32, QColor("#FFF"), tr("Заглушить"),   this);
     m_btnReconnect = new IconButton(ic_fluent_arrow_clockwise_32_filled, 32, QColor("#FFF"), tr("Переподключить"), this);
+    m_btnRewind    = new IconButton(ic_fluent_skip_back_10_32_filled,  32, QColor("#FFF"), tr("Назад на 10 с"), this);
+    m_btnForward   = new IconButton(ic_fluent_skip_forward_10_32_filled, 32, QColor("#FFF"), tr("Вперёд на 10 с"), this);
+    m_btnLive      = new IconButton(ic_fluent_live_24_filled,         32, QColor("#FFF"), tr("В эфир"),      this);
+    m_btnRecord    = new IconButton(ic_fluent_record_32_filled,       32, QColor("#FFF"), tr("Записывать эфир"), this);
+    setTimeShiftAvailable(false);  // показываем, когда плеер держит окно эфира
+    m_btnRecord->hide();
 
     auto *stationButtons = new QHBoxLayout;
     stationButtons->addWidget(m_btnAdd);
     stationButtons->addWidget(m_btnUpdate);
     stationButtons->addWidget(m_btnRemove);
+    stationButtons->addWidget(m_btnImport);
     stationButtons->addStretch();
 
     QWidget *stationPanel = new QWidget(this);
@@ -55,7 +71,8 @@ void RadioPage::setupUi()
 
 
     auto *stationLay = new QVBoxLayout(stationPanel);  // Layout теперь в panel
-    stationLay->addWidget(m_listWidget, 1);
+    stationLay->addWidget(m_filterEdit);
+    stationLay->addWidget(m_listView, 1);
     stationLay->addLayout(stationButtons);
     stationLay->setContentsMargins(0, 0, 0, 0);
 
@@ -64,6 +81,10 @@ void RadioPage::setupUi()
     controlLay->addWidget(m_btnPrev);
     controlLay->addWidget(m_btnPlay);
     controlLay->addWidget(m_btnNext);
+    controlLay->addWidget(m_btnRewind);
+    controlLay->addWidget(m_btnForward);
+    controlLay->addWidget(m_btnLive);
+    controlLay->addWidget(m_btnRecord);
     controlLay->addStretch();
     controlLay->addWidget(m_btnMute);
     controlLay->addWidget(m_volumeSpin);
@@ -71,40 +92,47 @@ void RadioPage::setupUi()
 
     auto *mainLay = new QVBoxLayout(this);
     mainLay->addWidget(stationPanel, 1);  // Добавьте panel вместо stationLay (с stretch=1 для занятия пространства)
+    mainLay->addWidget(m_nowPlaying);
     mainLay->addLayout(controlLay);
     mainLay->setContentsMargins(0, 0, 0, 0);
 }
 
 void RadioPage::setupConnections()
 {
-    // === Обновление списка станций из StationManager ===
-    connect(m_stations, &StationManager::stationsChanged,
-        this,       [this](){
-    QStringList names;
-    for (const auto& s : m_stations->stations()) {
-        if (s.type == QStringLiteral("radio")) {  // Фільтр по типу
-            names << s.name;
-        }
-    }
-    setStations(names);
-});
+    // === Список обновляется моделью; после полной перезагрузки возвращаем выбор ===
+    connect(m_listModel, &QAbstractItemModel::modelReset,
+            this,        &RadioPage::restoreCurrentStation);
+
+    // === Фильтр по мере набора; текущая станция остаётся выделенной, если видна ===
+    connect(m_filterEdit, &QLineEdit::textChanged, this, [this](const QString& text) {
+        m_listModel->setFilterText(text);
+        restoreCurrentStation();
+    });
 
     // === CRUD‑сигналы страницы вверх в MainWindow ===
     connect(m_btnAdd,    &IconButton::clicked, this, &RadioPage::requestAdd);
+    connect(m_btnImport, &IconButton::clicked, this, &RadioPage::requestImport);
     connect(m_btnRemove, &IconButton::clicked, this, [this](){
-    int idx = m_listWidget->currentRow();
-    if (idx < 0 || idx >= m_stations->stations().size()) return;
-    emit requestRemove(idx);
+    const quint64 id = m_listModel->idAt(m_listView->currentIndex().row());
+    if (id == 0) return;
+    emit requestRemove(id);
 });
     connect(m_btnUpdate, &IconButton::clicked, this, [this](){
-        int idx = m_listWidget->currentRow();
-        if (idx < 0 || idx >= m_stations->stations().size()) return;
-        emit requestUpdate(idx);
+        const quint64 id = m_listModel->idAt(m_listView->currentIndex().row());
+        if (id == 0) return;
+        emit requestUpdate(id);
     });
 
     // === Выбор станции из списка ===
-    connect(m_listWidget, &QListWidget::currentRowChanged,
-            this,          &RadioPage::playStation);
+    // Сдвиг текущей строки из-за вставки/удаления — не выбор пользователя
+    connect(m_listView->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+            [this](const QModelIndex& current, const QModelIndex&) {
+        if (m_syncingSelection || m_listModel->isChanging()) return;
+        const quint64 id = m_listModel->idAt(current.row());
+        if (id == 0) return;
+        m_currentStationId = id;
+        emit playStation(id);
+    });
 
     // === Навигация и плейбек ===
     connect(m_btnPrev, &IconButton::clicked, this, &RadioPage::prev);
@@ -114,6 +142,21 @@ void RadioPage::setupConnections()
     });
     connect(m_btnReconnect, &IconButton::clicked, this, &RadioPage::reconnect);
 
+    // === Сдвиг во времени ===
+    connect(m_btnRewind,  &IconButton::clicked, this, [this]() { m_player->shiftBy(-10000); });
+    connect(m_btnForward, &IconButton::clicked, this, [this]() { m_player->shiftBy(10000); });
+    connect(m_btnLive,    &IconButton::clicked, this, [this]() { m_player->goLive(); });
+    connect(m_player, &AbstractPlayer::featureChanged, this, [this](const QString& feature, bool enabled) {
+        if (feature == QLatin1String("timeshift"))
+            setTimeShiftAvailable(enabled);
+        else if (feature == QLatin1String("record"))
+            m_btnRecord->setVisible(enabled);
+    });
+
+    // === Запись ===
+    connect(m_btnRecord, &IconButton::clicked, this, &RadioPage::recordToggled);
+    connect(m_player, &AbstractPlayer::recordingChanged, this, &RadioPage::setRecording);
+
     // === Мьют ===
     connect(m_btnMute, &IconButton::clicked, this, [this]() {
         bool next = !m_player->isMuted();
@@ -137,26 +180,48 @@ void RadioPage::setupConnections()
 
 }
 
-void RadioPage::setStations(const QStringList& names)
+void RadioPage::selectRow(int row)
 {
-    m_listWidget->blockSignals(true);  // Блокируем сигналы
-    m_listWidget->clear();
-    m_listWidget->addItems(names);
+    m_syncingSelection = true;
+    m_listView->setCurrentIndex(m_listModel->index(row, 0));
+    m_syncingSelection = false;
+}
 
-    // Восстанавливаем выбор текущей станции
-    if (m_currentStationIndex >= 0 && m_currentStationIndex < names.size()) {
-        m_listWidget->setCurrentRow(m_currentStationIndex);
-    }
-    m_listWidget->blockSignals(false);  // Разблокируем
+void RadioPage::restoreCurrentStation()
+{
+    const int row = m_listModel->rowOfId(m_currentStationId);
+    if (row >= 0)
+        selectRow(row);
 }
 
-void RadioPage::setCurrentStation(int index) {
-    if (index >= 0 && index < m_listWidget->count()) {
-        m_listWidget->setCurrentRow(index);
-        m_currentStationIndex = index;
+void RadioPage::setCurrentStation(quint64 id) {
+    const int row = m_listModel->rowOfId(id);
+    if (row >= 0) {
+        selectRow(row);  // станция уже запущена вызывающим
+        m_currentStationId = id;
     }
 }
 
+void RadioPage::setNowPlaying(const QString& title)
+{
+    m_nowPlaying->setText(title);
+    m_nowPlaying->setToolTip(title);
+    m_nowPlaying->setVisible(!title.isEmpty());
+}
+
+void RadioPage::setTimeShiftAvailable(bool available)
+{
+    m_btnRewind->setVisible(available);
+    m_btnForward->setVisible(available);
+    m_btnLive->setVisible(available);
+}
+
+void RadioPage::setRecording(bool recording)
+{
+    m_btnRecord->setColor(recording ? QColor("#E53935") : QColor("#FFF"));
+    m_btnRecord->setToolTip(recording ? tr("Остановить запись") : tr("Записывать эфир"));
+}
+
 void RadioPage::setPlaybackState(bool isPlaying)
 {
     m_isPlaying = isPlaying;
@@ -2,11 +2,14 @@
 
 #include <QWidget>
 #include <QPointer>
-#include <QListWidget>
+#include <QListView>
 #include "StationManager.h"
+#include "StationModel.h"
 #include "../include/AbstractPlayer.h"
 
-class QListWidget;
+class QLabel;
+class QLineEdit;
+class QListView;
 class QSlider;
 class QSpinBox;
 class IconButton;
@@ -15,40 +18,49 @@ class RadioPage : public QWidget {
     Q_OBJECT
 public:
     explicit RadioPage(StationManager* stations,
+                       StationModel* model,
                        AbstractPlayer* player,
                        QWidget* parent = nullptr);
 
-    int currentStationIndex() const { return m_listWidget->currentRow(); }
+    quint64 currentStationId() const { return m_currentStationId; }
 
 public slots:
-    void setStations(const QStringList& names);
     void setPlaybackState(bool isPlaying);
     void setVolume(int value);
     void setMuted(bool muted);
     void onVolumeChanged(int value);
     void stopPlayback();
-    void setCurrentStation(int index);  // New slot to sync list selection
+    void setCurrentStation(quint64 id);  // New slot to sync list selection
+    void setNowPlaying(const QString& title);
+    void setTimeShiftAvailable(bool available);
+    void setRecording(bool recording);
 
     signals:
         void requestAdd();
-    void requestRemove(int index);
-    void requestUpdate(int index);
-    void playStation(int index);
+    void requestImport();
+    void requestRemove(quint64 id);
+    void requestUpdate(quint64 id);
+    void playStation(quint64 id);
     void reconnectRequested();
     void togglePlayback();
     void prev();
     void next();
     void reconnect();
+    void recordToggled();
     void volumeChanged(int value);
     void muteToggled(bool nowMuted);
 
 private:
     StationManager*    m_stations;
     AbstractPlayer*    m_player;
-    QListWidget*       m_listWidget;
+    StationTypeModel*  m_listModel;
+    QListView*         m_listView;
+    QLineEdit*         m_filterEdit;
+    QLabel*            m_nowPlaying;
     QSlider*           m_volumeSlider;
     QSpinBox*          m_volumeSpin;
     QPointer<IconButton>        m_btnAdd;
+    QPointer<IconButton>        m_btnImport;
     QPointer<IconButton>        m_btnRemove;
     QPointer<IconButton>        m_btnUpdate;
     QPointer<IconButton>        m_btnPrev;
@@ -56,9 +68,16 @@ private:
     QPointer<IconButton>        m_btnNext;
     QPointer<IconButton>        m_btnMute;
     QPointer<IconButton>        m_btnReconnect;
+    QPointer<IconButton>        m_btnRewind;
+    QPointer<IconButton>        m_btnForward;
+    QPointer<IconButton>        m_btnLive;
+    QPointer<IconButton>        m_btnRecord;
 
     void setupUi();
     void setupConnections();
+    void selectRow(int row);
+    void restoreCurrentStation();
     bool m_isPlaying = false;
-    int m_currentStationIndex = -1;
+    bool m_syncingSelection = false;
+    quint64 m_currentStationId = 0;
 };
\ No newline at end of file
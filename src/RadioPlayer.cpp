@@ -1,19 +1,34 @@
 #include "RadioPlayer.h"
 #include "StationManager.h"
-#include <QUrl>
+#include "AppSettings.h"
+#include "HlsReader.h"
+#include "IcyReader.h"
+#include <QMediaMetaData>
+#include <QRandomGenerator>
 #include <QDebug>
+#include <cmath>
+
+namespace {
+    const int kRaceWidth     = 3;    // одновременно подключаемых адресов
+    const int kRaceStaggerMs = 250;  // шаг старта следующего зеркала
+    // Сколько поток должен играть с прогрессом, чтобы счётчик попыток
+    // обнулился: сервер, принимающий соединение и тут же рвущий его,
+    // иначе сбрасывал бы счётчик каждый круг и maxAttempts не наступал
+    const int kRecoveredMs   = 5000;
+}
 
 RadioPlayer::RadioPlayer(StationManager* stations, QObject* parent)
     : AbstractPlayer(parent)
     , m_stations(stations)
     , m_player(new QMediaPlayer(this))
     , m_audio(new QAudioOutput(this))
+    , m_retryTimer(new QTimer(this))
+    , m_watchdog(new QTimer(this))
+    , m_standbyLimit(AppSettings::instance()->radioStandbyLimit())
+    , m_fadeTimer(new QTimer(this))
+    , m_crossfadeMs(AppSettings::instance()->radioCrossfadeMs())
 {
-    {
-            QSettings settings(QSettings::IniFormat, QSettings::UserScope,
-                               "MyApp", "LoraRadio");
-            m_currentVolume = settings.value("volume", 50).toInt();
-          }
+    m_currentVolume = AppSettings::instance()->volume();
     m_player->setAudioOutput(m_audio);
     m_audio->setVolume(m_currentVolume / 100.0);
     emit volumeChanged(m_currentVolume);
@@ -21,18 +36,179 @@ RadioPlayer::RadioPlayer(StationManager* stations, QObject* parent)
     connect(m_stations, &StationManager::stationsChanged,
             this, &RadioPlayer::emitStationList);
 
+    attachPlayer();
+
+    m_retryTimer->setSingleShot(true);
+    connect(m_retryTimer, &QTimer::timeout, this, &RadioPlayer::reconnect);
+    m_fadeTimer->setInterval(20);
+    connect(m_fadeTimer, &QTimer::timeout, this, &RadioPlayer::updateCrossfade);
+    m_watchdog->setInterval(1000);
+    connect(m_watchdog, &QTimer::timeout, this, &RadioPlayer::checkStall);
+
+    emitStationList();
+}
+
+RadioPlayer::~RadioPlayer() {
+    m_player->stop();
+    for (const Standby& sb : std::as_const(m_standby))
+        sb.player->stop();
+    for (const Standby& sb : std::as_const(m_racers))
+        sb.player->stop();
+    if (m_fadeOut.player)
+        m_fadeOut.player->stop();
+}
 
+void RadioPlayer::attachPlayer() {
     connect(m_player, &QMediaPlayer::mediaStatusChanged,
             this, &RadioPlayer::onMediaStatusChanged);
 
     connect(m_player, &QMediaPlayer::errorOccurred,
             this, &RadioPlayer::onErrorOccurred);
 
-    emitStationList();
+    // Прогресс потока: для живого эфира растёт позиция, при подкачке — буфер
+    connect(m_player, &QMediaPlayer::positionChanged, this, [this](qint64) {
+        m_lastProgress.restart();
+    });
+    connect(m_player, &QMediaPlayer::bufferProgressChanged, this, [this](float) {
+        m_lastProgress.restart();
+    });
+
+    // ICY StreamTitle — если бэкенд QtMultimedia отдаёт его как Title,
+    // собственное чтение метаданных больше не нужно
+    connect(m_player, &QMediaPlayer::metaDataChanged, this, [this]() {
+        const QString title = m_player->metaData().stringValue(QMediaMetaData::Title).trimmed();
+        if (!title.isEmpty() && !m_backendTitles) {
+            m_backendTitles = true;
+            stopTitles();
+        }
+        if (title.isEmpty() || title == m_nowPlaying) return;
+        m_nowPlaying = title;
+        emit nowPlayingChanged(title);
+    });
 }
 
-RadioPlayer::~RadioPlayer() {
-    m_player->stop();
+RadioPlayer::Standby RadioPlayer::createPlayer(const QUrl& source) {
+    Standby sb;
+    sb.player = new QMediaPlayer(this);
+    sb.audio  = new QAudioOutput(this);
+    sb.player->setAudioOutput(sb.audio);
+    sb.player->setSource(source);
+    return sb;
+}
+
+void RadioPlayer::prepareNext(const QStringList& urls) {
+    const QStringList wanted = urls.mid(0, qMax(0, m_standbyLimit));
+
+    // Соседи сменились — лишние подключения закрываем
+    const QStringList current = m_standby.keys();
+    for (const QString& url : current) {
+        if (!wanted.contains(url))
+            dropStandby(url);
+    }
+
+    for (const QString& url : wanted) {
+        if (url.isEmpty() || m_standby.contains(url) || QUrl(url) == m_source)
+            continue;
+
+        Standby sb = createPlayer(QUrl(url));
+        sb.audio->setMuted(true);
+        connect(sb.player, &QMediaPlayer::errorOccurred, this, [this, url](QMediaPlayer::Error, const QString& error) {
+            qDebug() << "[RadioPlayer] Standby failed:" << url << error;
+            dropStandby(url);
+        });
+        sb.player->play();
+        m_standby.insert(url, sb);
+        qDebug() << "[RadioPlayer] Standby warming:" << url;
+    }
+}
+
+void RadioPlayer::dropStandby(const QString& url) {
+    const Standby sb = m_standby.take(url);
+    if (!sb.player)
+        return;
+    sb.player->disconnect(this);
+    sb.player->stop();
+    sb.player->deleteLater();
+    sb.audio->deleteLater();
+}
+
+RadioPlayer::Standby RadioPlayer::takeStandby(const QString& url) {
+    auto it = m_standby.find(url);
+    if (it == m_standby.end())
+        return {};
+
+    const QMediaPlayer::MediaStatus status = it->player->mediaStatus();
+    if (status != QMediaPlayer::BufferedMedia && status != QMediaPlayer::BufferingMedia
+        && status != QMediaPlayer::LoadedMedia) {
+        // Ещё не подключился или сломался — обычный путь не медленнее
+        dropStandby(url);
+        return {};
+    }
+
+    const Standby sb = m_standby.take(url);
+    sb.player->disconnect(this);
+    qDebug() << "[RadioPlayer] Switching to warm standby:" << url;
+    return sb;
+}
+
+void RadioPlayer::retirePlayer(const Standby& sb, const QUrl& source) {
+    // Уходящий плеер сам становится резервом (назад по списку — тоже
+    // мгновенно); лишний закроет следующий prepareNext()
+    sb.player->disconnect(this);
+    const QString url = source.toString();
+    if (m_standbyLimit > 0 && !url.isEmpty() && !m_standby.contains(url)
+        && sb.player->playbackState() == QMediaPlayer::PlayingState) {
+        sb.audio->setMuted(true);
+        connect(sb.player, &QMediaPlayer::errorOccurred, this, [this, url](QMediaPlayer::Error, const QString&) {
+            dropStandby(url);
+        });
+        m_standby.insert(url, sb);
+        return;
+    }
+    sb.player->stop();
+    sb.player->deleteLater();
+    sb.audio->deleteLater();
+}
+
+void RadioPlayer::startCrossfade(const Standby& outgoing, const QUrl& source) {
+    m_fadeOut = outgoing;
+    m_fadeOutSource = source;
+    // Уходящий затухает от своей громкости, а не от громкости новой станции
+    m_fadeOutVolume = outgoing.audio->volume();
+    // Входящий молчит, пока не наберёт буфер; уходящий играет как играл
+    m_audio->setVolume(0.0);
+    const QMediaPlayer::MediaStatus status = m_player->mediaStatus();
+    if (status == QMediaPlayer::BufferedMedia || status == QMediaPlayer::LoadedMedia)
+        beginFadeRamp();
+    qDebug() << "[RadioPlayer] Crossfade from" << source << "to" << m_source;
+}
+
+void RadioPlayer::beginFadeRamp() {
+    if (!m_fadeOut.player || m_fadeTimer->isActive())
+        return;
+    m_fadeClock.start();
+    m_fadeTimer->start();
+}
+
+void RadioPlayer::updateCrossfade() {
+    // Равная мощность: cos²+sin² = 1 — на середине перехода нет провала
+    const double halfPi = 1.5707963267948966;
+    const double t = qMin(1.0, double(m_fadeClock.elapsed()) / qMax(1, m_crossfadeMs));
+    m_audio->setVolume(m_currentVolume / 100.0 * std::sin(t * halfPi));
+    if (m_fadeOut.audio)
+        m_fadeOut.audio->setVolume(m_fadeOutVolume * std::cos(t * halfPi));
+    if (t >= 1.0)
+        finishCrossfade();
+}
+
+void RadioPlayer::finishCrossfade() {
+    m_fadeTimer->stop();
+    if (!m_fadeOut.player)
+        return;
+    m_audio->setVolume(m_currentVolume / 100.0);
+    retirePlayer(m_fadeOut, m_fadeOutSource);
+    m_fadeOut = {};
+    m_fadeOutSource.clear();
 }
 
 void RadioPlayer::emitStationList() {
@@ -43,23 +219,209 @@ void RadioPlayer::emitStationList() {
 }
 
 void RadioPlayer::play(const QString& url) {
-    m_player->stop();
-    m_player->setSource(QUrl(url));
-    m_player->play();
+    playCandidates(QStringList{ url });
+}
+
+void RadioPlayer::playCandidates(const QStringList& urls) {
+    if (urls.isEmpty())
+        return;
+    const QString url = urls.first();
+    dropRacers();
+    m_candidates = urls;
+    m_candidateIndex = 0;
+    resetReconnect();
+    finishCrossfade();  // прошлый переход ещё идёт — завершаем сразу
+
+    if (!m_nowPlaying.isEmpty()) {
+        m_nowPlaying.clear();
+        emit nowPlayingChanged(QString());
+    }
+    m_backendTitles = false;
+
+    const QUrl previous = m_source;
+    const bool fade = m_crossfadeMs > 0 && !previous.isEmpty() && QUrl(url) != previous
+                      && m_player->playbackState() == QMediaPlayer::PlayingState;
+    m_source = QUrl(url);
+    m_wantPlaying = true;
+
+    Standby next = takeStandby(url);
+    if (!next.player && !fade) {
+        m_player->stop();
+        m_player->setSource(m_source);
+        m_player->play();
+    } else {
+        // Новый путь декодирования; прежний либо доигрывает под
+        // кроссфейд, либо сразу уходит в резерв
+        if (!next.player)
+            next = createPlayer(m_source);
+        const Standby outgoing{m_player, m_audio};
+        m_player->disconnect(this);
+        m_player = next.player;
+        m_audio  = next.audio;
+        m_audio->setVolume(m_currentVolume / 100.0);
+        m_audio->setMuted(m_muted);
+        attachPlayer();
+        if (fade)
+            startCrossfade(outgoing, previous);
+        else
+            retirePlayer(outgoing, previous);
+        if (m_player->playbackState() != QMediaPlayer::PlayingState)
+            m_player->play();
+    }
+    m_lastProgress.start();
+    m_watchdog->start();
+    startRace();
+    watchTitles();
     emit playbackStateChanged(true);
 }
 
+void RadioPlayer::startRace() {
+    const int gen = ++m_raceGen;
+    const int width = qMin(int(m_candidates.size()), kRaceWidth);
+    for (int i = 1; i < width; ++i) {
+        QTimer::singleShot(kRaceStaggerMs * i, this, [this, gen, i]() {
+            // Основной уже играет — запасные не нужны
+            if (gen != m_raceGen || !m_wantPlaying
+                || m_player->mediaStatus() == QMediaPlayer::BufferedMedia)
+                return;
+            addRacer(i);
+        });
+    }
+}
+
+void RadioPlayer::addRacer(int index) {
+    const QString url = m_candidates.at(index);
+    Standby sb = takeStandby(url);
+    if (!sb.player)
+        sb = createPlayer(QUrl(url));
+    sb.audio->setMuted(true);
+    connect(sb.player, &QMediaPlayer::mediaStatusChanged, this, [this, index](QMediaPlayer::MediaStatus status) {
+        if (status == QMediaPlayer::BufferedMedia)
+            promoteRacer(index);
+    });
+    connect(sb.player, &QMediaPlayer::errorOccurred, this, [this, index](QMediaPlayer::Error, const QString& error) {
+        const Standby lost = m_racers.take(index);
+        if (!lost.player)
+            return;
+        qDebug() << "[RadioPlayer] Mirror failed:" << m_candidates.value(index) << error;
+        lost.player->disconnect(this);
+        lost.player->stop();
+        lost.player->deleteLater();
+        lost.audio->deleteLater();
+        // Все проиграли, основной тоже мёртв — дальше обычное переподключение
+        if (m_racers.isEmpty() && m_player->error() != QMediaPlayer::NoError)
+            scheduleReconnect(error);
+    });
+    if (sb.player->playbackState() != QMediaPlayer::PlayingState)
+        sb.player->play();
+    m_racers.insert(index, sb);
+    qDebug() << "[RadioPlayer] Racing mirror:" << url;
+
+    // Резерв мог быть уже с буфером — побеждает сразу
+    if (sb.player->mediaStatus() == QMediaPlayer::BufferedMedia)
+        promoteRacer(index);
+}
+
+void RadioPlayer::promoteRacer(int index) {
+    const Standby winner = m_racers.take(index);
+    if (!winner.player)
+        return;
+    winner.player->disconnect(this);
+    dropRacers();
+    resetReconnect();
+
+    // Проигравший основной закрываем, победитель становится m_player
+    m_player->disconnect(this);
+    m_player->stop();
+    m_player->deleteLater();
+    m_audio->deleteLater();
+    m_player = winner.player;
+    m_audio  = winner.audio;
+    // Идёт кроссфейд — громкость поднимет его рампа
+    m_audio->setVolume(m_fadeOut.player ? 0.0 : m_currentVolume / 100.0);
+    m_audio->setMuted(m_muted);
+    attachPlayer();
+    m_candidateIndex = index;
+    m_source = QUrl(m_candidates.at(index));
+    m_lastProgress.restart();
+    m_bufferedSince.start();  // победитель уже с буфером
+    beginFadeRamp();
+    watchTitles();
+    qDebug() << "[RadioPlayer] Mirror won the race:" << m_source;
+}
+
+void RadioPlayer::dropRacers() {
+    ++m_raceGen;
+    for (const Standby& sb : std::as_const(m_racers)) {
+        sb.player->disconnect(this);
+        sb.player->stop();
+        sb.player->deleteLater();
+        sb.audio->deleteLater();
+    }
+    m_racers.clear();
+}
+
+void RadioPlayer::watchTitles() {
+    stopTitles();
+    if (m_backendTitles || m_source.isEmpty() || HlsReader::isHlsUrl(m_source)
+        || !AppSettings::instance()->radioIcyTitles())
+        return;
+    if (!m_titles) {
+        m_titles = new IcyReader(this);
+        connect(m_titles, &IcyReader::connected, this, [this](int session) {
+            // Сервер без icy-metaint: названий не будет, второй поток не нужен
+            if (session == m_titleSession && !m_titles->hasMetadata())
+                stopTitles();
+        });
+        connect(m_titles, &IcyReader::metadata, this, [this](int session, const QString& title) {
+            if (session != m_titleSession || m_backendTitles || title == m_nowPlaying)
+                return;
+            m_nowPlaying = title;
+            emit nowPlayingChanged(title);
+        });
+    }
+    m_titles->start(++m_titleSession, { m_source }, {});
+}
+
+void RadioPlayer::stopTitles() {
+    if (!m_titles)
+        return;
+    ++m_titleSession;
+    m_titles->stop();
+}
+
 void RadioPlayer::stop() {
+    m_wantPlaying = false;
+    stopTitles();
+    dropRacers();
+    finishCrossfade();
+    // Без воспроизведения резерв только занимает канал
+    const QStringList standby = m_standby.keys();
+    for (const QString& url : standby)
+        dropStandby(url);
+    resetReconnect();
+    m_watchdog->stop();
     m_player->stop();
     emit playbackStateChanged(false);
 }
 
 void RadioPlayer::togglePlayback() {
     if (m_player->playbackState() == QMediaPlayer::PlayingState) {
+        // Пауза — намеренная тишина, сторож и переподключение не нужны
+        m_wantPlaying = false;
+        finishCrossfade();
+        dropRacers();
+        resetReconnect();
+        m_watchdog->stop();
+        stopTitles();
         m_player->pause();
         emit playbackStateChanged(false);
-    } else if (m_currentIndex >= 0) {
+    } else if (!m_source.isEmpty()) {
+        m_wantPlaying = true;
+        watchTitles();
         m_player->play();
+        m_lastProgress.start();
+        m_watchdog->start();
         emit playbackStateChanged(true);
     }
 }
@@ -68,7 +430,10 @@ void RadioPlayer::setVolume(int value)
 {
     if (m_currentVolume != value) {
         m_currentVolume = value;
-        m_audio->setVolume(value / 100.0);
+        // Во время кроссфейда громкости выходов ведёт updateCrossfade():
+        // новое значение — для входящего, уходящий доигрывает на своей
+        if (!m_fadeOut.player)
+            m_audio->setVolume(value / 100.0);
         qDebug() << "[RadioPlayer] Volume set to:" << m_currentVolume;
         emit volumeChanged(value);
     }
@@ -79,26 +444,166 @@ int RadioPlayer::volume() const {
 }
 
 void RadioPlayer::setMuted(bool muted) {
+    m_muted = muted;
     m_audio->setMuted(muted);
+    if (m_fadeOut.audio)
+        m_fadeOut.audio->setMuted(muted);
     emit mutedChanged(muted);
 }
 
 bool RadioPlayer::isMuted() const {
-    return m_audio->isMuted();
+    return m_muted;
 }
 
 
 void RadioPlayer::onMediaStatusChanged(QMediaPlayer::MediaStatus status) {
-    if (status == QMediaPlayer::StalledMedia ||
-        status == QMediaPlayer::EndOfMedia   ||
-        status == QMediaPlayer::InvalidMedia)
-    {
-        if (status == QMediaPlayer::EndOfMedia)
-            emit playbackStateChanged(false);
+    switch (status) {
+        case QMediaPlayer::LoadedMedia:
+            // Пришли только заголовки — восстановлением это ещё не считается
+            m_lastProgress.restart();
+            break;
+        case QMediaPlayer::BufferedMedia:
+            m_lastProgress.restart();
+            if (!m_bufferedSince.isValid())
+                m_bufferedSince.start();
+            dropRacers();  // основной успел первым
+            beginFadeRamp();
+            break;
+        case QMediaPlayer::EndOfMedia:
+            // Живой поток не кончается сам — это обрыв
+            if (m_wantPlaying)
+                scheduleReconnect(QStringLiteral("end of media"));
+            else
+                emit playbackStateChanged(false);
+            break;
+        case QMediaPlayer::InvalidMedia:
+            if (m_wantPlaying)
+                scheduleReconnect(QStringLiteral("invalid media"));
+            break;
+        case QMediaPlayer::StalledMedia:
+            // Решение принимает сторож: короткие провалы буфера — норма
+            qDebug() << "[RadioPlayer] Stream stalled";
+            m_bufferedSince.invalidate();
+            break;
+        default:
+            break;
     }
 }
 
 void RadioPlayer::onErrorOccurred(QMediaPlayer::Error, const QString& errorString) {
     qWarning() << "Stream error:" << errorString;
-    emit errorOccurred(errorString);
+    if (m_wantPlaying)
+        scheduleReconnect(errorString);
+    else
+        emit errorOccurred(errorString);
+}
+
+void RadioPlayer::checkStall() {
+    if (!m_wantPlaying || m_retryTimer->isActive())
+        return;
+    if (m_lastProgress.isValid() && m_lastProgress.elapsed() >= m_policy.stallTimeoutMs) {
+        dropRacers();  // никто не дал звук за отведённое время
+        scheduleReconnect(QStringLiteral("stalled"));
+        return;
+    }
+    checkRecovered();
+}
+
+void RadioPlayer::checkRecovered() {
+    // Буфер полон, прогресс идёт (за последний тик сторожа) и держится
+    // kRecoveredMs — только тогда попытки считаются успешными
+    if (m_attempt == 0 || !m_bufferedSince.isValid()
+        || m_bufferedSince.elapsed() < kRecoveredMs
+        || m_lastProgress.elapsed() > m_watchdog->interval() * 2)
+        return;
+
+    ReconnectEvent ev;
+    ev.kind    = ReconnectEvent::Recovered;
+    ev.attempt = m_attempt;
+    ev.reason  = m_lastReason;
+    ev.source  = m_source;
+    qDebug() << "[RadioPlayer] Recovered after" << m_attempt << "attempt(s)";
+    m_attempt = 0;
+    emit reconnectEvent(ev);
+}
+
+void RadioPlayer::scheduleReconnect(const QString& reason) {
+    if (m_retryTimer->isActive() || m_source.isEmpty())
+        return;  // попытка уже запланирована
+    if (!m_racers.isEmpty()) {
+        // Зеркала ещё подключаются — решит гонка
+        qDebug() << "[RadioPlayer] Primary failed, waiting for mirrors:" << reason;
+        return;
+    }
+
+    m_lastReason = reason;
+    m_bufferedSince.invalidate();
+    if (m_attempt >= m_policy.maxAttempts) {
+        ReconnectEvent ev;
+        ev.kind    = ReconnectEvent::GaveUp;
+        ev.attempt = m_attempt;
+        ev.reason  = reason;
+        ev.source  = m_source;
+        qWarning() << "[RadioPlayer] Giving up after" << m_attempt << "attempt(s):" << reason;
+        m_wantPlaying = false;
+        m_watchdog->stop();
+        stopTitles();
+        finishCrossfade();
+        m_player->stop();
+        emit reconnectEvent(ev);
+        emit errorOccurred(reason);
+        emit playbackStateChanged(false);
+        return;
+    }
+
+    // Экспонента с «равным» джиттером: половина паузы фиксирована, половина
+    // случайна — множество клиентов не ломится на сервер одновременно
+    const qint64 exp = qint64(m_policy.baseDelayMs) << qMin(m_attempt, 16);
+    const int capped = int(qMin<qint64>(exp, m_policy.maxDelayMs));
+    const int delay = capped / 2 + int(QRandomGenerator::global()->bounded(capped / 2 + 1));
+    ++m_attempt;
+
+    ReconnectEvent ev;
+    ev.kind    = ReconnectEvent::Scheduled;
+    ev.attempt = m_attempt;
+    ev.delayMs = delay;
+    ev.reason  = reason;
+    ev.source  = m_source;
+    qDebug() << "[RadioPlayer] Reconnect" << m_attempt << "of" << m_policy.maxAttempts
+             << "in" << delay << "ms:" << reason;
+    m_retryTimer->start(delay);
+    emit reconnectEvent(ev);
+}
+
+void RadioPlayer::reconnect() {
+    if (!m_wantPlaying)
+        return;
+
+    // Обрыв посреди эфира: следующая попытка — на следующее зеркало по кругу
+    if (m_candidates.size() > 1) {
+        m_candidateIndex = (m_candidateIndex + 1) % m_candidates.size();
+        m_source = QUrl(m_candidates.at(m_candidateIndex));
+        qDebug() << "[RadioPlayer] Failing over to mirror" << m_candidateIndex << m_source;
+    }
+
+    ReconnectEvent ev;
+    ev.kind    = ReconnectEvent::Attempt;
+    ev.attempt = m_attempt;
+    ev.reason  = m_lastReason;
+    ev.source  = m_source;
+    emit reconnectEvent(ev);
+
+    m_player->stop();
+    m_player->setSource(QUrl());
+    m_player->setSource(m_source);
+    m_player->play();
+    m_lastProgress.restart();
+    watchTitles();
+}
+
+void RadioPlayer::resetReconnect() {
+    m_retryTimer->stop();
+    m_bufferedSince.invalidate();
+    m_attempt = 0;
+    m_lastReason.clear();
 }
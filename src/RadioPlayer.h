@@ -1,20 +1,42 @@
-
+#pragma once
 #include "../include/AbstractPlayer.h"
 #include "AutoStartRegistry.h"
 #include <QMediaPlayer>
 #include <QAudioOutput>
-#include <QSettings>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QTimer>
+#include <QUrl>
 
+class IcyReader;
 class StationManager;
 
 class RadioPlayer : public AbstractPlayer {
     Q_OBJECT
 public:
+    // Политика автопереподключения: экспоненциальная пауза с джиттером,
+    // ограничение попыток и сторож «нет прогресса буфера N мс»
+    struct ReconnectPolicy {
+        int maxAttempts    = 8;
+        int baseDelayMs    = 250;
+        int maxDelayMs     = 30000;
+        int stallTimeoutMs = 10000;
+    };
+
+    struct ReconnectEvent {
+        enum Kind { Scheduled, Attempt, Recovered, GaveUp };
+        Kind    kind = Scheduled;
+        int     attempt = 0;   // номер попытки, 1..maxAttempts
+        int     delayMs = 0;   // пауза перед попыткой (Scheduled)
+        QString reason;        // ошибка/«stalled»/«end of media»
+        QUrl    source;
+    };
+
     explicit RadioPlayer(StationManager* stations, QObject* parent = nullptr);
     ~RadioPlayer() override;
 
     void play(const QString& url) override;
+    void playCandidates(const QStringList& urls) override;
     void stop() override;
     void togglePlayback() override;
 
@@ -22,9 +44,14 @@ public:
     int volume() const override;
     void setMuted(bool muted) override;
     bool isMuted() const override;
+    void prepareNext(const QStringList& urls) override;
+
+    void setReconnectPolicy(const ReconnectPolicy& policy) { m_policy = policy; }
+    ReconnectPolicy reconnectPolicy() const { return m_policy; }
 
     signals:
         void stationsChanged(const QStringList& names);
+        void reconnectEvent(const RadioPlayer::ReconnectEvent& event);
 
 private slots:
     void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
@@ -32,11 +59,82 @@ private slots:
                          const QString& errorString);
 
 private:
+    // Отдельный путь декодирования: плеер со своим выходом
+    struct Standby {
+        QMediaPlayer* player = nullptr;
+        QAudioOutput* audio  = nullptr;
+    };
+
     void emitStationList();
+    void scheduleReconnect(const QString& reason);
+    void reconnect();
+    void checkStall();
+    void checkRecovered();
+    void resetReconnect();
+    void attachPlayer();
+    Standby createPlayer(const QUrl& source);
+    Standby takeStandby(const QString& url);
+    void dropStandby(const QString& url);
+    void retirePlayer(const Standby& sb, const QUrl& source);
+    void startCrossfade(const Standby& outgoing, const QUrl& source);
+    void beginFadeRamp();
+    void updateCrossfade();
+    void finishCrossfade();
+    void startRace();
+    void addRacer(int index);
+    void promoteRacer(int index);
+    void watchTitles();
+    void stopTitles();
+    void dropRacers();
 
     StationManager* m_stations;
     QMediaPlayer*   m_player;
     QAudioOutput*   m_audio;
     int             m_currentVolume;
-    int             m_currentIndex{-1};
+    bool            m_muted = false;
+
+    // Источник уже разрешён при play() — переподключение его переиспользует
+    QUrl            m_source;
+    bool            m_wantPlaying = false;
+    QString         m_nowPlaying;
+
+    ReconnectPolicy m_policy;
+    QTimer*         m_retryTimer;
+    QTimer*         m_watchdog;
+    QElapsedTimer   m_lastProgress;   // последний рост позиции/буфера
+    QElapsedTimer   m_bufferedSince;  // непрерывно в BufferedMedia
+    int             m_attempt = 0;
+    QString         m_lastReason;
+
+    // Тёплый резерв: соседние станции, уже подключённые и буферизующие
+    // с заглушённым выходом; play() просто подменяет ими текущий плеер
+    QHash<QString, Standby> m_standby;
+    int                     m_standbyLimit;
+
+    // Кроссфейд: уходящий плеер доигрывает, пока входящий набирает буфер,
+    // затем громкости сводятся по кривой равной мощности за m_crossfadeMs
+    Standby                 m_fadeOut;
+    QUrl                    m_fadeOutSource;
+    QTimer*                 m_fadeTimer;
+    QElapsedTimer           m_fadeClock;
+    float                   m_fadeOutVolume = 1.0f;  // громкость уходящего до затухания
+    int                     m_crossfadeMs;
+
+    // Зеркала станции. Happy Eyeballs: если основной адрес не дал звук за
+    // kRaceStaggerMs, следующий подключается параллельно (заглушённым) —
+    // играет тот, кто первым набрал буфер. Обрыв переключает на следующий
+    QStringList             m_candidates;
+    int                     m_candidateIndex = 0;
+    QHash<int, Standby>     m_racers;        // индекс в m_candidates -> плеер
+    int                     m_raceGen = 0;   // отменяет запоздавшие старты
+
+    // QtMultimedia сам Icy-MetaData не запрашивает, и большинство его
+    // бэкендов StreamTitle не отдают: названия треков читает отдельное
+    // подключение IcyReader без звука. Как только бэкенд прислал Title
+    // сам — подключение закрывается
+    IcyReader*              m_titles = nullptr;
+    int                     m_titleSession = 0;
+    bool                    m_backendTitles = false;
 };
+
+Q_DECLARE_METATYPE(RadioPlayer::ReconnectEvent)
@@ -0,0 +1,76 @@
+#include "SongHistory.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+    const qint64 kMaxHistoryBytes = 512 * 1024;
+
+    QString historyField(QString text)
+    {
+        // Разделители формата внутри полей не нужны
+        text.replace(QLatin1Char('\t'), QLatin1Char(' '));
+        text.replace(QLatin1Char('\n'), QLatin1Char(' '));
+        text.replace(QLatin1Char('\r'), QLatin1Char(' '));
+        return text;
+    }
+}
+
+SongHistory::SongHistory(const QString& path, QObject* parent)
+    : QObject(parent)
+    , m_path(path)
+{
+    if (m_path.isEmpty()) {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dir);
+        m_path = QDir(dir).filePath(QStringLiteral("history.tsv"));
+    }
+}
+
+void SongHistory::append(const QString& station, const QString& title)
+{
+    if (title.isEmpty() || (title == m_lastTitle && station == m_lastStation))
+        return;
+    m_lastStation = station;
+    m_lastTitle = title;
+
+    QFile f(m_path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "[SongHistory] Cannot open" << m_path << f.errorString();
+        return;
+    }
+    const QString line = QString("%1\t%2\t%3\n")
+                             .arg(QDateTime::currentDateTime().toString(Qt::ISODate),
+                                  historyField(station), historyField(title));
+    f.write(line.toUtf8());
+    const qint64 size = f.size();
+    f.close();
+
+    if (size > kMaxHistoryBytes)
+        trim();
+}
+
+void SongHistory::trim()
+{
+    QFile f(m_path);
+    if (!f.open(QIODevice::ReadOnly))
+        return;
+    f.seek(f.size() - kMaxHistoryBytes / 2);
+    QByteArray tail = f.readAll();
+    f.close();
+
+    // Начинаем с целой строки
+    const qsizetype nl = tail.indexOf('\n');
+    if (nl >= 0)
+        tail.remove(0, nl + 1);
+
+    QSaveFile out(m_path);
+    if (out.open(QIODevice::WriteOnly)) {
+        out.write(tail);
+        out.commit();
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+// SongHistory — журнал сыгранных треков (ICY StreamTitle) в
+// history.tsv: строка «время<TAB>станция<TAB>трек» на смену трека.
+// Файл только дописывается; при превышении лимита остаётся свежая половина.
+class SongHistory : public QObject {
+    Q_OBJECT
+public:
+    explicit SongHistory(const QString& path = QString(), QObject* parent = nullptr);
+
+    void append(const QString& station, const QString& title);
+    QString path() const { return m_path; }
+
+private:
+    void trim();
+
+    QString m_path;
+    QString m_lastStation;
+    QString m_lastTitle;
+};
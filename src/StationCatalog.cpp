@@ -0,0 +1,369 @@
+#include "StationCatalog.h"
+#include "StationImporter.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSqlError>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+    const char* kConnection       = "catalog";
+    const char* kImportConnection = "catalog-import";
+    const int   kPageSize         = 200;
+
+    QString defaultCatalogPath()
+    {
+        QString configPath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+        if (configPath.isEmpty())
+            configPath = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/MyApp";
+        QDir().mkpath(configPath);
+        return QDir(configPath).filePath("catalog.sqlite");
+    }
+
+    QString likeEscaped(QString text)
+    {
+        text.replace('\\', "\\\\");
+        text.replace('%', "\\%");
+        text.replace('_', "\\_");
+        return text;
+    }
+}
+
+StationCatalog::StationCatalog(const QString& dbPath, QObject* parent)
+    : QObject(parent)
+    , m_path(dbPath.isEmpty() ? defaultCatalogPath() : dbPath)
+{
+    m_importPool.setMaxThreadCount(1);
+
+    m_db = QSqlDatabase::addDatabase("QSQLITE", kConnection);
+    m_db.setDatabaseName(m_path);
+    if (!m_db.open()) {
+        qWarning() << "[StationCatalog] Cannot open" << m_path << m_db.lastError().text();
+        return;
+    }
+    createSchema(m_db);
+    qDebug() << "[StationCatalog] Opened" << m_path << "entries:" << count() << "fts5:" << m_hasFts;
+}
+
+StationCatalog::~StationCatalog()
+{
+    m_cancelImport = true;
+    m_importPool.waitForDone();
+    m_db.close();
+}
+
+bool StationCatalog::createSchema(QSqlDatabase& db)
+{
+    QSqlQuery q(db);
+    q.exec("PRAGMA journal_mode=WAL");
+    q.exec("PRAGMA synchronous=NORMAL");
+
+    const bool ok =
+        q.exec("CREATE TABLE IF NOT EXISTS stations("
+               " id INTEGER PRIMARY KEY,"
+               " uuid TEXT UNIQUE,"
+               " name TEXT NOT NULL,"
+               " url TEXT NOT NULL,"
+               " tags TEXT, genre TEXT, country TEXT, codec TEXT,"
+               " bitrate INTEGER DEFAULT 0,"
+               " votes INTEGER DEFAULT 0)") &&
+        q.exec("CREATE INDEX IF NOT EXISTS idx_stations_votes ON stations(votes DESC)") &&
+        q.exec("CREATE INDEX IF NOT EXISTS idx_stations_country ON stations(country, votes DESC)") &&
+        q.exec("CREATE INDEX IF NOT EXISTS idx_stations_codec ON stations(codec, votes DESC)");
+    if (!ok) {
+        qWarning() << "[StationCatalog] Schema error:" << q.lastError().text();
+        return false;
+    }
+
+    // FTS5 — внешний контент поверх stations; префиксные индексы для
+    // поиска по мере набора. Без FTS5 в сборке SQLite — поиск через LIKE
+    m_hasFts = q.exec("CREATE VIRTUAL TABLE IF NOT EXISTS stations_fts USING fts5("
+                      " name, tags, genre,"
+                      " content='stations', content_rowid='id',"
+                      " tokenize='unicode61 remove_diacritics 2',"
+                      " prefix='2 3')");
+    if (!m_hasFts)
+        qWarning() << "[StationCatalog] FTS5 unavailable, falling back to LIKE:" << q.lastError().text();
+    return true;
+}
+
+int StationCatalog::count() const
+{
+    QSqlQuery q(m_db);
+    return q.exec("SELECT COUNT(*) FROM stations") && q.next() ? q.value(0).toInt() : 0;
+}
+
+QStringList StationCatalog::countries() const
+{
+    QStringList result;
+    QSqlQuery q(m_db);
+    q.setForwardOnly(true);
+    if (q.exec("SELECT country FROM stations WHERE country <> '' "
+               "GROUP BY country ORDER BY COUNT(*) DESC LIMIT 250")) {
+        while (q.next())
+            result.append(q.value(0).toString());
+    }
+    return result;
+}
+
+QStringList StationCatalog::codecs() const
+{
+    QStringList result;
+    QSqlQuery q(m_db);
+    q.setForwardOnly(true);
+    if (q.exec("SELECT codec FROM stations WHERE codec <> '' "
+               "GROUP BY codec ORDER BY COUNT(*) DESC LIMIT 50")) {
+        while (q.next())
+            result.append(q.value(0).toString());
+    }
+    return result;
+}
+
+QString StationCatalog::ftsExpression(const QString& text)
+{
+    // Каждое слово — префиксный терм в кавычках, термы через AND:
+    // спецсимволы синтаксиса FTS5 в запрос не попадают
+    QStringList terms;
+    for (QString word : text.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts)) {
+        word.remove('"');
+        if (!word.isEmpty())
+            terms.append(QString("\"%1\"*").arg(word));
+    }
+    return terms.join(' ');
+}
+
+QSqlQuery StationCatalog::search(const CatalogQuery& query) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList where;
+    QVariantList binds;
+    QString sql;
+    const QString fts = m_hasFts ? ftsExpression(query.text) : QString();
+    if (!fts.isEmpty()) {
+        sql = "SELECT s.id, s.name, s.url, s.country, s.codec, s.bitrate"
+              " FROM (SELECT rowid, rank FROM stations_fts WHERE stations_fts MATCH ?) m"
+              " JOIN stations s ON s.id = m.rowid";
+        binds << fts;
+    } else {
+        sql = "SELECT s.id, s.name, s.url, s.country, s.codec, s.bitrate FROM stations s";
+        const QString text = query.text.trimmed();
+        if (!text.isEmpty()) {
+            where << "s.name LIKE ? ESCAPE '\\'";
+            binds << QString("%%1%").arg(likeEscaped(text));
+        }
+    }
+    if (!query.country.isEmpty()) {
+        where << "s.country = ?";
+        binds << query.country;
+    }
+    if (!query.codec.isEmpty()) {
+        where << "s.codec = ?";
+        binds << query.codec;
+    }
+    if (query.minBitrate > 0) {
+        where << "s.bitrate >= ?";
+        binds << query.minBitrate;
+    }
+    if (!where.isEmpty())
+        sql += " WHERE " + where.join(" AND ");
+    sql += fts.isEmpty() ? " ORDER BY s.votes DESC" : " ORDER BY m.rank";
+
+    QSqlQuery q(m_db);
+    q.setForwardOnly(true);
+    q.prepare(sql);
+    for (const QVariant& v : std::as_const(binds))
+        q.addBindValue(v);
+    if (!q.exec())
+        qWarning() << "[StationCatalog] Query failed:" << q.lastError().text();
+
+    qDebug() << "[StationCatalog] search" << query.text << "in" << timer.nsecsElapsed() / 1000 << "us";
+    return q;
+}
+
+void StationCatalog::importDump(const QString& path)
+{
+    if (m_importing.exchange(true))
+        return;
+    m_cancelImport = false;
+
+    m_importPool.start([this, path]() {
+        int imported = 0;
+        QString error;
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", kImportConnection);
+            db.setDatabaseName(m_path);
+            if (!db.open()) {
+                error = db.lastError().text();
+            } else {
+                QSqlQuery q(db);
+                q.exec("PRAGMA synchronous=OFF");
+                db.transaction();
+                q.exec("DELETE FROM stations");
+
+                QSqlQuery insert(db);
+                insert.prepare("INSERT OR IGNORE INTO stations"
+                               "(uuid, name, url, tags, genre, country, codec, bitrate, votes)"
+                               " VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?)");
+
+                const bool ok = StationImporter::forEachRadioBrowserObject(path,
+                    [&](const QJsonObject& o) {
+                        if (m_cancelImport)
+                            return false;
+                        QString url = o.value("url_resolved").toString().trimmed();
+                        if (url.isEmpty())
+                            url = o.value("url").toString().trimmed();
+                        const QString name = o.value("name").toString().trimmed();
+                        if (url.isEmpty() || name.isEmpty())
+                            return true;
+
+                        // В Radio-Browser жанр — это теги; первый тег считаем основным
+                        const QString tags = o.value("tags").toString();
+                        QString genre = o.value("genre").toString();
+                        if (genre.isEmpty())
+                            genre = tags.section(',', 0, 0).trimmed();
+
+                        const QString uuid = o.value("stationuuid").toString();
+                        insert.addBindValue(uuid.isEmpty() ? QVariant() : QVariant(uuid));
+                        insert.addBindValue(name);
+                        insert.addBindValue(url);
+                        insert.addBindValue(tags);
+                        insert.addBindValue(genre);
+                        insert.addBindValue(o.value("country").toString());
+                        insert.addBindValue(o.value("codec").toString());
+                        insert.addBindValue(o.value("bitrate").toInt());
+                        insert.addBindValue(o.value("votes").toInt());
+                        if (insert.exec())
+                            ++imported;
+                        return true;
+                    },
+                    [this](qint64 done, qint64 total) {
+                        QMetaObject::invokeMethod(this, [this, done, total]() {
+                            emit importProgress(done, total);
+                        }, Qt::QueuedConnection);
+                    });
+
+                if (!ok || m_cancelImport) {
+                    db.rollback();
+                    if (!m_cancelImport)
+                        error = tr("Файл не найден или повреждён");
+                } else {
+                    // Внешний контент: индекс FTS перестраивается одним проходом
+                    if (m_hasFts)
+                        q.exec("INSERT INTO stations_fts(stations_fts) VALUES('rebuild')");
+                    db.commit();
+                    q.exec("ANALYZE");
+                }
+                q.exec("PRAGMA synchronous=NORMAL");
+                db.close();
+            }
+        }
+        QSqlDatabase::removeDatabase(kImportConnection);
+        m_importing = false;
+
+        qDebug() << "[StationCatalog] Import finished:" << imported << "entries" << error;
+        QMetaObject::invokeMethod(this, [this, imported, error]() {
+            if (!error.isEmpty())
+                emit importFailed(error);
+            else
+                emit importFinished(imported, m_cancelImport);
+        }, Qt::QueuedConnection);
+    });
+}
+
+CatalogModel::CatalogModel(StationCatalog* catalog, QObject* parent)
+    : QAbstractListModel(parent)
+    , m_catalog(catalog)
+{
+}
+
+void CatalogModel::setQuery(const CatalogQuery& query)
+{
+    beginResetModel();
+    m_lastQuery = query;
+    m_rows.clear();
+    m_cursor = m_catalog->search(query);
+    m_atEnd = !m_cursor.isActive();
+    m_rows = readPage();
+    endResetModel();
+}
+
+QVector<CatalogEntry> CatalogModel::readPage()
+{
+    QVector<CatalogEntry> page;
+    if (m_atEnd)
+        return page;
+
+    page.reserve(kPageSize);
+    while (page.size() < kPageSize) {
+        if (!m_cursor.next()) {
+            m_atEnd = true;
+            m_cursor.finish();
+            break;
+        }
+        CatalogEntry e;
+        e.id      = m_cursor.value(0).toLongLong();
+        e.name    = m_cursor.value(1).toString();
+        e.url     = m_cursor.value(2).toString();
+        e.country = m_cursor.value(3).toString();
+        e.codec   = m_cursor.value(4).toString();
+        e.bitrate = m_cursor.value(5).toInt();
+        page.append(e);
+    }
+    return page;
+}
+
+int CatalogModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+bool CatalogModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && !m_atEnd;
+}
+
+void CatalogModel::fetchMore(const QModelIndex& parent)
+{
+    if (parent.isValid())
+        return;
+    const QVector<CatalogEntry> page = readPage();
+    if (page.isEmpty())
+        return;
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + page.size() - 1);
+    m_rows += page;
+    endInsertRows();
+}
+
+QVariant CatalogModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size())
+        return QVariant();
+
+    const CatalogEntry& e = m_rows.at(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+            return e.name;
+        case Qt::ToolTipRole: {
+            QStringList parts;
+            if (!e.country.isEmpty()) parts << e.country;
+            if (!e.codec.isEmpty())   parts << e.codec;
+            if (e.bitrate > 0)        parts << tr("%1 кбит/с").arg(e.bitrate);
+            parts << e.url;
+            return parts.join(QStringLiteral(" · "));
+        }
+        case UrlRole:
+            return e.url;
+        case CountryRole:
+            return e.country;
+        case CodecRole:
+            return e.codec;
+        case BitrateRole:
+            return e.bitrate;
+        default:
+            return QVariant();
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+
+// Фильтр каталога: текст ищется по FTS5 (name, tags, genre) с префиксным
+// совпадением, остальные поля — точные фасеты
+struct CatalogQuery {
+    QString text;
+    QString country;
+    QString codec;
+    int     minBitrate = 0;
+};
+
+struct CatalogEntry {
+    qint64  id = 0;
+    QString name;
+    QString url;
+    QString country;
+    QString codec;
+    int     bitrate = 0;
+};
+
+// StationCatalog — встроенный SQLite-каталог станций (дампы Radio-Browser).
+// Главное соединение только читает; импорт идёт в пуле потоков через
+// собственное соединение (WAL позволяет читать во время записи).
+class StationCatalog : public QObject {
+    Q_OBJECT
+public:
+    explicit StationCatalog(const QString& dbPath = QString(), QObject* parent = nullptr);
+    ~StationCatalog() override;
+
+    bool isOpen() const { return m_db.isOpen(); }
+    bool hasFullText() const { return m_hasFts; }
+    int  count() const;
+    QStringList countries() const;
+    QStringList codecs() const;
+
+    // Запрос выполнен и стоит перед первой строкой (forward-only курсор)
+    QSqlQuery search(const CatalogQuery& query) const;
+
+    void importDump(const QString& path);
+    void cancelImport() { m_cancelImport = true; }
+    bool isImporting() const { return m_importing; }
+
+signals:
+    void importProgress(qint64 done, qint64 total);
+    void importFinished(int count, bool canceled);
+    void importFailed(const QString& error);
+
+private:
+    bool createSchema(QSqlDatabase& db);
+    static QString ftsExpression(const QString& text);
+
+    QString          m_path;
+    QSqlDatabase     m_db;
+    QThreadPool      m_importPool;
+    bool             m_hasFts = false;
+    std::atomic_bool m_cancelImport { false };
+    std::atomic_bool m_importing { false };
+};
+
+// CatalogModel — результаты поиска, подгружаемые страницами по мере
+// прокрутки (canFetchMore/fetchMore) с открытого курсора SQLite
+class CatalogModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    enum Roles {
+        UrlRole = Qt::UserRole,
+        CountryRole,
+        CodecRole,
+        BitrateRole
+    };
+
+    explicit CatalogModel(StationCatalog* catalog, QObject* parent = nullptr);
+
+    void setQuery(const CatalogQuery& query);
+    void refresh() { setQuery(m_lastQuery); }
+    const CatalogEntry& entryAt(int row) const { return m_rows.at(row); }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+private:
+    QVector<CatalogEntry> readPage();
+
+    StationCatalog*       m_catalog;
+    CatalogQuery          m_lastQuery;
+    QSqlQuery             m_cursor;
+    QVector<CatalogEntry> m_rows;
+    bool                  m_atEnd = true;
+};
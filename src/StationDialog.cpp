@@ -21,6 +21,7 @@ StationDialog::StationDialog(const Station &st, QWidget *parent)
     setWindowTitle(tr("Правка станции"));
     ui->nameEdit->setText(st.name);
     ui->urlEdit->setText(st.url);
+    ui->mirrorsEdit->setPlainText(st.mirrors.join(QLatin1Char('\n')));
 
     connect(ui->buttonOk,     &QPushButton::clicked, this, &QDialog::accept);
     connect(ui->buttonCancel, &QPushButton::clicked, this, &QDialog::reject);
@@ -36,5 +37,12 @@ Station StationDialog::station() const
     Station st;
     st.name = ui->nameEdit->text();
     st.url  = ui->urlEdit->text();
+    // Зеркала — по одному в строке; пустые и повторы основного отбрасываем
+    const QStringList lines = ui->mirrorsEdit->toPlainText().split(QLatin1Char('\n'));
+    for (const QString& line : lines) {
+        const QString mirror = line.trimmed();
+        if (!mirror.isEmpty() && mirror != st.url.trimmed() && !st.mirrors.contains(mirror))
+            st.mirrors << mirror;
+    }
     return st;
 }
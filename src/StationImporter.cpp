@@ -0,0 +1,454 @@
+#include "StationImporter.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QSemaphore>
+#include <QSet>
+#include <QThread>
+#include <QXmlStreamReader>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+    struct Entry {
+        QString name;
+        QString url;
+        int     order = 0;  // номер FileN в PLS
+    };
+
+    struct Range {
+        qint64 begin;
+        qint64 end;
+    };
+
+    const qint64 kChunkBytes = 4 * 1024 * 1024;
+
+    QByteArray lineAt(const char* data, qint64 begin, qint64 end)
+    {
+        while (end > begin && (data[end - 1] == '\r' || data[end - 1] == ' ' || data[end - 1] == '\t'))
+            --end;
+        while (begin < end && (data[begin] == ' ' || data[begin] == '\t'))
+            ++begin;
+        return QByteArray::fromRawData(data + begin, end - begin);
+    }
+
+    qint64 nextLineStart(const char* data, qint64 size, qint64 pos)
+    {
+        const void* nl = std::memchr(data + pos, '\n', size_t(size - pos));
+        return nl ? (static_cast<const char*>(nl) - data) + 1 : size;
+    }
+
+    // Граница куска M3U — сразу после строки с URL, чтобы #EXTINF
+    // не оторвался от своей ссылки
+    qint64 m3uBoundary(const char* data, qint64 size, qint64 pos)
+    {
+        qint64 line = nextLineStart(data, size, pos);
+        while (line < size) {
+            const void* nl = std::memchr(data + line, '\n', size_t(size - line));
+            const qint64 end = nl ? static_cast<const char*>(nl) - data : size;
+            const QByteArray text = lineAt(data, line, end);
+            if (!text.isEmpty() && !text.startsWith('#'))
+                return qMin(end + 1, size);
+            line = end + 1;
+        }
+        return size;
+    }
+
+    QVector<Range> lineChunks(const char* data, qint64 size, bool m3u)
+    {
+        QVector<Range> chunks;
+        qint64 begin = 0;
+        while (begin < size) {
+            qint64 end = begin + kChunkBytes;
+            end = end >= size ? size : (m3u ? m3uBoundary(data, size, end) : nextLineStart(data, size, end));
+            chunks.append({ begin, end });
+            begin = end;
+        }
+        return chunks;
+    }
+
+    template <typename Fn>
+    void forEachLine(const char* data, const Range& r, Fn&& fn)
+    {
+        qint64 pos = r.begin;
+        while (pos < r.end) {
+            const void* nl = std::memchr(data + pos, '\n', size_t(r.end - pos));
+            const qint64 end = nl ? static_cast<const char*>(nl) - data : r.end;
+            const QByteArray line = lineAt(data, pos, end);
+            if (!line.isEmpty())
+                fn(line);
+            pos = end + 1;
+        }
+    }
+
+    QVector<Entry> parseM3U(const char* data, const Range& r, const std::atomic_bool& cancel)
+    {
+        QVector<Entry> out;
+        QString title;
+        forEachLine(data, r, [&](const QByteArray& line) {
+            if (cancel.load(std::memory_order_relaxed))
+                return;
+            if (line.startsWith("#EXTINF")) {
+                const int comma = line.indexOf(',');
+                title = comma >= 0 ? QString::fromUtf8(line.mid(comma + 1)).trimmed() : QString();
+            } else if (!line.startsWith('#')) {
+                const QString url = QString::fromUtf8(line);
+                out.append({ title.isEmpty() ? url : title, url, 0 });
+                title.clear();
+            }
+        });
+        return out;
+    }
+
+    // PLS: FileN=/TitleN= могут идти в любом порядке, склеиваются по N
+    QVector<Entry> parsePLS(const char* data, const Range& r, const std::atomic_bool& cancel)
+    {
+        QVector<Entry> out;
+        QHash<int, int> slotByNumber;
+        auto entryFor = [&](int n) -> Entry& {
+            auto it = slotByNumber.constFind(n);
+            if (it != slotByNumber.constEnd())
+                return out[it.value()];
+            slotByNumber.insert(n, out.size());
+            out.append({ QString(), QString(), n });
+            return out.last();
+        };
+        forEachLine(data, r, [&](const QByteArray& line) {
+            if (cancel.load(std::memory_order_relaxed))
+                return;
+            const int eq = line.indexOf('=');
+            if (eq <= 0)
+                return;
+            const QByteArray key = line.left(eq).toLower();
+            const QString value = QString::fromUtf8(line.mid(eq + 1)).trimmed();
+            bool ok = false;
+            if (key.startsWith("file")) {
+                const int n = key.mid(4).toInt(&ok);
+                if (ok) entryFor(n).url = value;
+            } else if (key.startsWith("title")) {
+                const int n = key.mid(5).toInt(&ok);
+                if (ok) entryFor(n).name = value;
+            }
+        });
+        return out;
+    }
+
+    // Разбор кусков Radio-Browser JSON: каждый кусок — последовательность
+    // объектов верхнего уровня, DOM строится только для куска
+    QVector<Entry> parseJsonChunk(const char* data, const Range& r, const std::atomic_bool& cancel)
+    {
+        QVector<Entry> out;
+        QByteArray wrapped;
+        wrapped.reserve(r.end - r.begin + 2);
+        wrapped.append('[');
+        wrapped.append(data + r.begin, r.end - r.begin);
+        wrapped.append(']');
+
+        QJsonParseError err;
+        const QJsonDocument doc = QJsonDocument::fromJson(wrapped, &err);
+        if (!doc.isArray()) {
+            qWarning() << "[StationImporter] JSON chunk error:" << err.errorString();
+            return out;
+        }
+        const QJsonArray arr = doc.array();
+        out.reserve(arr.size());
+        for (const QJsonValue& v : arr) {
+            if (cancel.load(std::memory_order_relaxed))
+                break;
+            const QJsonObject o = v.toObject();
+            QString url = o.value("url_resolved").toString().trimmed();
+            if (url.isEmpty())
+                url = o.value("url").toString().trimmed();
+            const QString name = o.value("name").toString().trimmed();
+            out.append({ name.isEmpty() ? url : name, url, 0 });
+        }
+        return out;
+    }
+
+    // Один быстрый проход без разбора значений: находим объекты верхнего
+    // уровня массива и режем по их границам куски ~kChunkBytes
+    QVector<Range> jsonChunks(const char* data, qint64 size)
+    {
+        QVector<Range> chunks;
+        int depth = 0;
+        bool inString = false;
+        bool escape = false;
+        qint64 chunkBegin = -1;
+        for (qint64 i = 0; i < size; ++i) {
+            const char c = data[i];
+            if (inString) {
+                if (escape)         escape = false;
+                else if (c == '\\') escape = true;
+                else if (c == '"')  inString = false;
+                continue;
+            }
+            switch (c) {
+                case '"': inString = true; break;
+                case '{': case '[':
+                    if (depth == 1 && c == '{' && chunkBegin < 0)
+                        chunkBegin = i;
+                    ++depth;
+                    break;
+                case '}': case ']':
+                    --depth;
+                    if (depth == 1 && c == '}' && chunkBegin >= 0 && i + 1 - chunkBegin >= kChunkBytes) {
+                        chunks.append({ chunkBegin, i + 1 });
+                        chunkBegin = -1;
+                    } else if (depth == 0 && chunkBegin >= 0) {
+                        // конец массива: хвост без закрывающей скобки
+                        qint64 end = i;
+                        while (end > chunkBegin && data[end - 1] != '}')
+                            --end;
+                        chunks.append({ chunkBegin, end });
+                        chunkBegin = -1;
+                    }
+                    break;
+                default: break;
+            }
+        }
+        return chunks;
+    }
+
+    QString normalizedUrl(const QString& url)
+    {
+        QString u = url.trimmed();
+        const int scheme = u.indexOf(QLatin1String("://"));
+        if (scheme > 0) {
+            // Схема и хост без учёта регистра, путь — как есть
+            int hostEnd = u.indexOf(QLatin1Char('/'), scheme + 3);
+            if (hostEnd < 0) hostEnd = u.size();
+            u = u.left(hostEnd).toLower() + u.mid(hostEnd);
+        }
+        while (u.endsWith(QLatin1Char('/')))
+            u.chop(1);
+        return u;
+    }
+
+    StationImporter::Format detectFormat(const QString& path, const char* data, qint64 size)
+    {
+        const QString ext = QFileInfo(path).suffix().toLower();
+        if (ext == "m3u" || ext == "m3u8") return StationImporter::Format::M3U;
+        if (ext == "pls")                  return StationImporter::Format::PLS;
+        if (ext == "xspf")                 return StationImporter::Format::XSPF;
+        if (ext == "json")                 return StationImporter::Format::RadioBrowserJson;
+
+        const QByteArray head = QByteArray(data, int(qMin<qint64>(size, 64))).trimmed().toLower();
+        if (head.startsWith("[playlist]")) return StationImporter::Format::PLS;
+        if (head.startsWith('['))          return StationImporter::Format::RadioBrowserJson;
+        if (head.startsWith('<'))          return StationImporter::Format::XSPF;
+        return StationImporter::Format::M3U;
+    }
+}
+
+StationImporter::StationImporter(QObject* parent)
+    : QObject(parent)
+{
+    // +1 поток под управляющую задачу, которая ждёт разбор кусков
+    m_pool.setMaxThreadCount(qMax(2, QThread::idealThreadCount() + 1));
+}
+
+StationImporter::~StationImporter()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+quint64 StationImporter::normalizedUrlHash(const QString& url)
+{
+    return StationManager::urlHash(normalizedUrl(url));
+}
+
+bool StationImporter::forEachRadioBrowserObject(const QString& path,
+                                                const std::function<bool(const QJsonObject&)>& fn,
+                                                const std::function<void(qint64, qint64)>& progress)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 size = file.size();
+    QByteArray fallback;
+    const char* data = reinterpret_cast<const char*>(size > 0 ? file.map(0, size) : nullptr);
+    if (!data) {
+        fallback = file.readAll();
+        data = fallback.constData();
+    }
+
+    for (const Range& r : jsonChunks(data, size)) {
+        QByteArray wrapped;
+        wrapped.reserve(r.end - r.begin + 2);
+        wrapped.append('[');
+        wrapped.append(data + r.begin, r.end - r.begin);
+        wrapped.append(']');
+        const QJsonArray arr = QJsonDocument::fromJson(wrapped).array();
+        for (const QJsonValue& v : arr) {
+            if (!fn(v.toObject()))
+                return false;
+        }
+        if (progress)
+            progress(r.end, size);
+    }
+    return true;
+}
+
+void StationImporter::start(const QString& path, const QString& type,
+                            const QVector<Station>& existing, Format format)
+{
+    if (m_running.exchange(true))
+        return;
+    m_cancel = false;
+    m_lastReported = 0;
+    m_pool.start([this, path, type, existing, format]() {
+        run(path, type, existing, format);
+    });
+}
+
+void StationImporter::cancel()
+{
+    m_cancel = true;
+}
+
+void StationImporter::reportProgress(qint64 done, qint64 total)
+{
+    // Не чаще, чем раз на ~1% — очередь GUI не заваливаем
+    const qint64 step = qMax<qint64>(total / 100, 1);
+    qint64 last = m_lastReported.load();
+    if (done < total && done - last < step)
+        return;
+    if (!m_lastReported.compare_exchange_strong(last, done))
+        return;
+    QMetaObject::invokeMethod(this, [this, done, total]() {
+        emit progress(done, total);
+    }, Qt::QueuedConnection);
+}
+
+void StationImporter::run(const QString& path, const QString& type,
+                          const QVector<Station>& existing, Format format)
+{
+    auto fail = [this](const QString& error) {
+        m_running = false;
+        QMetaObject::invokeMethod(this, [this, error]() { emit failed(error); }, Qt::QueuedConnection);
+    };
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail(file.errorString());
+
+    const qint64 size = file.size();
+    QByteArray fallback;
+    const char* data = reinterpret_cast<const char*>(size > 0 ? file.map(0, size) : nullptr);
+    if (!data) {
+        fallback = file.readAll();
+        data = fallback.constData();
+    }
+    if (format == Format::Auto)
+        format = detectFormat(path, data, size);
+
+    QVector<QVector<Entry>> results;
+
+    if (format == Format::XSPF) {
+        // XML не делится на независимые куски — потоковый разбор в одном потоке
+        QVector<Entry> out;
+        QXmlStreamReader xml(QByteArray::fromRawData(data, size));
+        Entry current;
+        bool inTrack = false;
+        while (!xml.atEnd() && !m_cancel) {
+            xml.readNext();
+            if (xml.isStartElement()) {
+                if (xml.name() == QLatin1String("track")) {
+                    current = Entry();
+                    inTrack = true;
+                } else if (inTrack && xml.name() == QLatin1String("location") && current.url.isEmpty()) {
+                    current.url = xml.readElementText().trimmed();
+                } else if (inTrack && xml.name() == QLatin1String("title")) {
+                    current.name = xml.readElementText().trimmed();
+                }
+            } else if (xml.isEndElement() && xml.name() == QLatin1String("track")) {
+                out.append(current);
+                inTrack = false;
+                reportProgress(xml.characterOffset(), size);
+            }
+        }
+        if (xml.hasError() && !m_cancel)
+            qWarning() << "[StationImporter] XSPF error:" << xml.errorString();
+        results.append(out);
+    } else {
+        const QVector<Range> chunks = format == Format::RadioBrowserJson
+                                      ? jsonChunks(data, size)
+                                      : lineChunks(data, size, format == Format::M3U);
+        results.resize(chunks.size());
+        QVector<Entry>* out = results.data();
+
+        std::atomic<int>    nextChunk { 0 };
+        std::atomic<qint64> bytesDone { 0 };
+        auto worker = [&]() {
+            for (int i = nextChunk++; i < chunks.size() && !m_cancel; i = nextChunk++) {
+                const Range& r = chunks.at(i);
+                switch (format) {
+                    case Format::PLS:              out[i] = parsePLS(data, r, m_cancel); break;
+                    case Format::RadioBrowserJson: out[i] = parseJsonChunk(data, r, m_cancel); break;
+                    default:                       out[i] = parseM3U(data, r, m_cancel); break;
+                }
+                reportProgress(bytesDone += r.end - r.begin, size);
+            }
+        };
+
+        // Управляющий поток разбирает куски наравне с помощниками
+        const int helpers = qMin(int(chunks.size()) - 1, m_pool.maxThreadCount() - 1);
+        QSemaphore done;
+        for (int h = 0; h < helpers; ++h)
+            m_pool.start([&worker, &done]() { worker(); done.release(); });
+        worker();
+        done.acquire(qMax(helpers, 0));
+    }
+
+    if (m_cancel) {
+        m_running = false;
+        QMetaObject::invokeMethod(this, [this]() { emit finished({}, true); }, Qt::QueuedConnection);
+        return;
+    }
+
+    // Слияние в исходном порядке + дедупликация
+    QSet<quint64> seen;
+    seen.reserve(existing.size());
+    for (const Station& st : existing)
+        seen.insert(normalizedUrlHash(st.url));
+
+    QVector<Station> stations;
+    if (format == Format::PLS) {
+        QMap<int, Entry> byNumber;
+        for (const auto& part : std::as_const(results)) {
+            for (const Entry& e : part) {
+                Entry& merged = byNumber[e.order];
+                if (!e.url.isEmpty())  merged.url = e.url;
+                if (!e.name.isEmpty()) merged.name = e.name;
+            }
+        }
+        results = { byNumber.values() };
+    }
+
+    for (const auto& part : std::as_const(results)) {
+        for (const Entry& e : part) {
+            if (e.url.isEmpty())
+                continue;
+            const quint64 hash = normalizedUrlHash(e.url);
+            if (seen.contains(hash))
+                continue;
+            seen.insert(hash);
+            Station st;
+            st.name = e.name.isEmpty() ? e.url : e.name;
+            st.url  = e.url;
+            st.type = type;
+            stations.append(st);
+        }
+    }
+
+    qDebug() << "[StationImporter] Parsed" << path << "->" << stations.size() << "new stations";
+    m_running = false;
+    QMetaObject::invokeMethod(this, [this, stations]() {
+        emit finished(stations, false);
+    }, Qt::QueuedConnection);
+}
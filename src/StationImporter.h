@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include "StationManager.h"
+
+class QJsonObject;
+
+// StationImporter — импорт больших списков станций (M3U/PLS/XSPF и дампы
+// Radio-Browser в JSON). Файл отображается в память и разбирается потоково:
+// M3U/PLS и JSON делятся на куски по границам записей и разбираются
+// параллельно, XSPF читается QXmlStreamReader'ом. Дубликаты (по
+// нормализованному URL, в т.ч. уже существующие станции) отбрасываются.
+class StationImporter : public QObject {
+    Q_OBJECT
+public:
+    enum class Format { Auto, M3U, PLS, XSPF, RadioBrowserJson };
+
+    explicit StationImporter(QObject* parent = nullptr);
+    ~StationImporter() override;
+
+    // existing — текущие станции, их URL тоже участвуют в дедупликации
+    void start(const QString& path, const QString& type,
+               const QVector<Station>& existing, Format format = Format::Auto);
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+    static quint64 normalizedUrlHash(const QString& url);
+
+    // Потоковый обход дампа Radio-Browser по объектам (для каталога):
+    // DOM строится только для текущего куска. fn возвращает false — стоп
+    static bool forEachRadioBrowserObject(const QString& path,
+                                          const std::function<bool(const QJsonObject&)>& fn,
+                                          const std::function<void(qint64, qint64)>& progress = {});
+
+signals:
+    void progress(qint64 done, qint64 total);
+    void finished(const QVector<Station>& stations, bool canceled);
+    void failed(const QString& error);
+
+private:
+    void run(const QString& path, const QString& type,
+             const QVector<Station>& existing, Format format);
+    void reportProgress(qint64 done, qint64 total);
+
+    QThreadPool       m_pool;
+    std::atomic_bool  m_cancel { false };
+    std::atomic_bool  m_running { false };
+    std::atomic<qint64> m_lastReported { 0 };
+};
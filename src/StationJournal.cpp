@@ -0,0 +1,131 @@
+#include "StationJournal.h"
+#include <QJsonDocument>
+#include <QDebug>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    bool syncToDisk(QFile& f)
+    {
+        if (!f.flush())
+            return false;
+#ifdef Q_OS_WIN
+        return _commit(f.handle()) == 0;
+#else
+        return ::fsync(f.handle()) == 0;
+#endif
+    }
+
+    void readLines(const QString& path, QVector<QJsonObject>& out)
+    {
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly))
+            return;
+        while (!f.atEnd()) {
+            const QByteArray line = f.readLine().trimmed();
+            if (line.isEmpty())
+                continue;
+            // Последняя строка может быть оборвана падением посреди записи
+            const QJsonDocument doc = QJsonDocument::fromJson(line);
+            if (doc.isObject())
+                out.append(doc.object());
+            else
+                qWarning() << "[StationJournal] Skipping damaged entry in" << path;
+        }
+    }
+}
+
+StationJournal::StationJournal(const QString& path, QObject* parent)
+    : QObject(parent)
+    , m_path(path)
+{
+    openFile();
+}
+
+StationJournal::~StationJournal()
+{
+    QMutexLocker lock(&m_mutex);
+    m_file.close();
+}
+
+bool StationJournal::openFile()
+{
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "[StationJournal] Cannot open" << m_path << m_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool StationJournal::append(const QJsonObject& op)
+{
+    QMutexLocker lock(&m_mutex);
+    if (!m_file.isOpen() && !openFile())
+        return false;
+
+    QByteArray line = QJsonDocument(op).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    if (m_file.write(line) != line.size() || !syncToDisk(m_file)) {
+        qWarning() << "[StationJournal] Append failed:" << m_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+qint64 StationJournal::size() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_file.size();
+}
+
+bool StationJournal::hasRotated() const
+{
+    return QFile::exists(rotatedPath());
+}
+
+int StationJournal::rotate()
+{
+    QMutexLocker lock(&m_mutex);
+    m_file.close();
+
+    // Предыдущее сжатие ещё не дописало stations.json — копим в тот же *.old
+    QFile old(rotatedPath());
+    if (old.exists()) {
+        QFile current(m_path);
+        if (old.open(QIODevice::WriteOnly | QIODevice::Append) && current.open(QIODevice::ReadOnly)) {
+            old.write(current.readAll());
+            syncToDisk(old);
+        }
+        old.close();
+        current.close();
+        QFile::remove(m_path);
+    } else {
+        QFile::rename(m_path, rotatedPath());
+    }
+
+    openFile();
+    return ++m_generation;
+}
+
+bool StationJournal::removeRotated(int generation)
+{
+    // Под тем же мьютексом, что и rotate(): если после снятия слепка была
+    // новая ротация, *.old содержит операции, которых в слепке нет
+    QMutexLocker lock(&m_mutex);
+    if (generation != m_generation)
+        return false;
+    return QFile::remove(rotatedPath());
+}
+
+QVector<QJsonObject> StationJournal::readAll() const
+{
+    QMutexLocker lock(&m_mutex);
+    QVector<QJsonObject> ops;
+    readLines(rotatedPath(), ops);
+    readLines(m_path, ops);
+    return ops;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QJsonObject>
+#include <QMutex>
+#include <QVector>
+
+// StationJournal — журнал изменений станций (write-ahead log) рядом со
+// stations.json: по строке JSON на операцию (add/remove/update/move),
+// каждая запись сбрасывается на диск (fsync). При загрузке операции
+// проигрываются поверх последнего stations.json; операции идемпотентны,
+// поэтому повторное проигрывание после незавершённого сжатия безопасно.
+//
+// Сжатие: rotate() переносит журнал в *.old и начинает новый; фоновая
+// запись stations.json затем удаляет *.old через removeRotated().
+class StationJournal : public QObject {
+    Q_OBJECT
+public:
+    explicit StationJournal(const QString& path, QObject* parent = nullptr);
+    ~StationJournal() override;
+
+    bool   append(const QJsonObject& op);
+    qint64 size() const;       // только текущий журнал
+    bool   hasRotated() const;  // прошлое сжатие не завершилось
+
+    int  rotate();                       // возвращает поколение ротации
+    bool removeRotated(int generation);  // потокобезопасно, из фоновой записи
+
+    QVector<QJsonObject> readAll() const;  // *.old, затем текущий; битые строки пропускаются
+
+    QString path() const { return m_path; }
+    QString rotatedPath() const { return m_path + QStringLiteral(".old"); }
+
+private:
+    bool openFile();
+
+    mutable QMutex m_mutex;
+    QString        m_path;
+    QFile          m_file;
+    int            m_generation = 0;
+};
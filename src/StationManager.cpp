@@ -1,10 +1,17 @@
 #include "StationManager.h"
+#include "BackgroundWriter.h"
+#include "AppSettings.h"
+#include "StationSnapshot.h"
+#include "StationJournal.h"
 #include <QDir>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QCoreApplication>
-#include <QSettings>
+#include <QSaveFile>
 #include <QStandardPaths>
+#include <QSet>
+#include <QTimer>
+#include <algorithm>
 
 static QString defaultStationsPath()
 {
@@ -21,16 +28,42 @@ static QString defaultStationsPath()
     return QDir(configPath).filePath("stations.json");
 }
 
+// Ключи громкостей старого формата: volumes/<type>/<md5(url)>
 static QString hashedUrl(const QString& url) {
     return QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Md5).toHex();
 }
 
+static const char* kVolumePrefix = "volumes64/";
+
+// Размер журнала, после которого он сворачивается в stations.json
+static const qint64 kJournalCompactBytes = 256 * 1024;
+static const int    kUndoLimit = 100;
+
+static QJsonObject journalOp(const char* op, quint64 id)
+{
+    QJsonObject o;
+    o.insert("op", QLatin1String(op));
+    o.insert("id", qint64(id));
+    return o;
+}
+
 StationManager::StationManager(const QString &jsonPath, QObject *parent)
     : QObject(parent)
     , m_jsonPath(jsonPath.isEmpty()
                  ? defaultStationsPath()
                  : jsonPath)
+    , m_writer(new BackgroundWriter(QStringLiteral("StationsWriter"), 500, this))
+    // Журнал создаётся после писателя и удаляется после него: отложенное
+    // сжатие при выходе ещё обращается к журналу
+    , m_journal(new StationJournal(m_jsonPath + QStringLiteral(".journal"), this))
+    , m_volumeTimer(new QTimer(this))
 {
+    m_volumeTimer->setSingleShot(true);
+    m_volumeTimer->setInterval(400);
+    connect(m_volumeTimer, &QTimer::timeout, this, &StationManager::persistVolumes);
+    loadVolumes();
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &StationManager::persistVolumes);
+
     if (!QFile::exists(m_jsonPath)) {
         // Создаем директорию если её нет
         QDir().mkpath(QFileInfo(m_jsonPath).path());
@@ -51,6 +84,41 @@ StationManager::StationManager(const QString &jsonPath, QObject *parent)
 }
 
 bool StationManager::load()
+{
+    QVector<Station> loaded;
+    QHash<QString, QVector<quint64>> idsByType;
+    bool assigned = false;
+    m_nextId = qMax(m_nextId, AppSettings::instance()->value("stations/nextId", 1).toULongLong());
+    const bool fromSnapshot = loadSnapshot(loaded, idsByType);
+    if (!fromSnapshot && !loadJson(loaded, assigned))
+        return false;
+
+    // Правки после последней записи stations.json
+    const QVector<QJsonObject> ops = m_journal->readAll();
+    if (replayJournal(loaded, ops))
+        idsByType.clear();
+
+    emit stationsAboutToBeReset();
+    m_stations = loaded;
+    rebuildIndex(idsByType);
+    m_undo.clear();
+    persistNextId();
+
+    // Запись JSON сама обновит слепок. Слепок должен совпадать с JSON,
+    // поэтому проигранный поверх JSON журнал сразу сворачиваем
+    if (assigned || m_journal->hasRotated() || m_journal->size() > kJournalCompactBytes
+        || (!fromSnapshot && !ops.isEmpty()))
+        save();
+    else if (!fromSnapshot)
+        scheduleSnapshot();
+
+    emit stationsChanged();
+    qDebug() << "[StationManager] Loaded" << m_stations.size() << "stations from"
+             << (fromSnapshot ? "snapshot" : "JSON") << "+" << ops.size() << "journal op(s)";
+    return true;
+}
+
+bool StationManager::loadJson(QVector<Station>& loaded, bool& assigned)
 {
     QFile f(m_jsonPath);
     if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
@@ -61,131 +129,702 @@ bool StationManager::load()
     if (!doc.isArray())
         return false;
 
-    m_stations.clear();
-    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "MyApp", "LoraRadio");
+    QSet<quint64> seenIds;
+    quint64 maxId = 0;
     for (auto v : doc.array()) {
-        auto o = v.toObject();
-        Station st;
-        st.name = o.value("name").toString();
-        st.url  = o.value("url").toString();
-        st.type = o.value("type").toString("radio"); // по умолчанию radio
+        Station st = stationFromJson(v.toObject());
         if (!st.name.isEmpty() && !st.url.isEmpty()) {
-            QString key = QString("volumes/%1/%2").arg(st.type).arg(hashedUrl(st.url));
-            st.volume = settings.value(key, 50).toInt();
-            m_stations.append(st);
+            st.volume = volumeForUrl(st.type, st.url);
+            if (st.id != 0 && seenIds.contains(st.id))
+                st.id = 0; // дубликат — выдадим новый ниже
+            if (st.id != 0) {
+                seenIds.insert(st.id);
+                maxId = qMax(maxId, st.id);
+            }
+            loaded.append(st);
+        }
+    }
+
+    // Станциям без id (старый формат файла) выдаём новые и сразу сохраняем,
+    // чтобы id оставались стабильными между запусками
+    m_nextId = qMax(m_nextId, maxId + 1);
+    for (auto &st : loaded) {
+        if (st.id == 0) {
+            st.id = m_nextId++;
+            assigned = true;
+        }
+    }
+    return true;
+}
+
+bool StationManager::replayJournal(QVector<Station>& stations, const QVector<QJsonObject>& ops)
+{
+    if (ops.isEmpty())
+        return false;
+
+    // Операции идемпотентны: add пропускает уже существующий id, remove —
+    // отсутствующий, update/move задают итоговое значение. Поэтому *.old,
+    // частично вошедший в stations.json, проигрывается без вреда
+    QHash<quint64, int> rows;
+    bool rowsValid = false;
+    const auto rowOfId = [&](quint64 id) {
+        if (!rowsValid) {
+            rows.clear();
+            rows.reserve(stations.size());
+            for (int r = 0; r < stations.size(); ++r)
+                rows.insert(stations.at(r).id, r);
+            rowsValid = true;
+        }
+        return rows.value(id, -1);
+    };
+    const auto insertAt = [&](Station st, int row) {
+        if (st.id == 0 || st.url.isEmpty() || rowOfId(st.id) >= 0)
+            return;
+        st.volume = volumeForUrl(st.type, st.url);
+        if (row < 0 || row >= stations.size()) {
+            rows.insert(st.id, stations.size());
+            stations.append(st);
+        } else {
+            stations.insert(row, st);
+            rowsValid = false;
+        }
+        m_nextId = qMax(m_nextId, st.id + 1);
+    };
+    const auto removeId = [&](quint64 id) {
+        const int row = rowOfId(id);
+        if (row < 0)
+            return;
+        stations.remove(row);
+        rowsValid = false;
+    };
+
+    for (const QJsonObject &op : ops) {
+        const QString kind = op.value("op").toString();
+        const quint64 id = quint64(op.value("id").toInteger(0));
+        if (kind == QLatin1String("add")) {
+            if (op.contains("stations")) {
+                for (const auto v : op.value("stations").toArray())
+                    insertAt(stationFromJson(v.toObject()), -1);
+            } else {
+                insertAt(stationFromJson(op), op.value("row").toInt(-1));
+            }
+        } else if (kind == QLatin1String("remove")) {
+            if (op.contains("ids")) {
+                for (const auto v : op.value("ids").toArray())
+                    removeId(quint64(v.toInteger(0)));
+            } else {
+                removeId(id);
+            }
+        } else if (kind == QLatin1String("update")) {
+            const int row = rowOfId(id);
+            if (row < 0)
+                continue;
+            Station &st = stations[row];
+            const Station updated = stationFromJson(op);
+            if (updated.url != st.url || updated.type != st.type)
+                st.volume = volumeForUrl(updated.type, updated.url);
+            st.name    = updated.name;
+            st.url     = updated.url;
+            st.type    = updated.type;
+            // Нет ключа "mirrors" — зеркала убрали, список пустой
+            st.mirrors = updated.mirrors;
+        } else if (kind == QLatin1String("move")) {
+            const int from = rowOfId(id);
+            if (from < 0)
+                continue;
+            const int to = qBound(0, op.value("row").toInt(), int(stations.size()) - 1);
+            if (from == to)
+                continue;
+            stations.move(from, to);
+            rowsValid = false;
         }
     }
-    emit stationsChanged();
     return true;
 }
 
-void StationManager::saveStationVolume(const Station& st) {
-    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "MyApp", "LoraRadio");
-    QString key = QString("volumes/%1/%2").arg(st.type).arg(hashedUrl(st.url));
-    settings.setValue(key, st.volume);
-    settings.sync();
-    qDebug() << "[StationManager] Saved volume for" << st.url << ":" << st.volume;
+QString StationManager::snapshotPath(int slot) const
+{
+    return QString("%1.%2.snap").arg(m_jsonPath).arg(slot);
 }
 
-bool StationManager::save() const
+bool StationManager::loadSnapshot(QVector<Station>& stations, QHash<QString, QVector<quint64>>& idsByType)
 {
-    QJsonArray arr;
-    for (auto &st : m_stations) {
-        QJsonObject o;
-        o.insert("name", st.name);
-        o.insert("url",  st.url);
-        o.insert("type", st.type);
-        arr.append(o);
+    for (int slot = 0; slot < 2; ++slot) {
+        // Строки станций ссылаются на отображение, поэтому слепок живёт
+        // вместе с менеджером (дочерний объект)
+        auto *snapshot = new StationSnapshot(this);
+        if (!snapshot->open(snapshotPath(slot), m_jsonPath)) {
+            delete snapshot;
+            continue;
+        }
+
+        stations = snapshot->stations(m_volumes);
+        idsByType = snapshot->idsByType();
+        m_nextId = qMax(m_nextId, snapshot->nextId());
+        m_snapshotSlot = slot;
+        return true;
     }
+    return false;
+}
+
+void StationManager::scheduleSnapshot() const
+{
+    const QString jsonPath = m_jsonPath;
+    const QString snapPath = snapshotPath(m_snapshotSlot == 0 ? 1 : 0);
+    const QVector<Station> stations = m_stations;
+    const quint64 nextId = m_nextId;
+    m_writer->schedule([jsonPath, snapPath, stations, nextId]() {
+        if (!StationSnapshot::write(snapPath, jsonPath, stations, nextId))
+            qWarning() << "[StationManager] Failed to write snapshot" << snapPath;
+    });
+}
+
+void StationManager::rebuildIndex(const QHash<QString, QVector<quint64>>& idsByType)
+{
+    m_rowById.clear();
+    m_localById.clear();
+    m_idsByType.clear();
+    m_idsByUrl.clear();
+    m_urlIndexValid = false;
+    m_rowById.reserve(m_stations.size());
+    m_localById.reserve(m_stations.size());
+
+    for (int row = 0; row < m_stations.size(); ++row)
+        m_rowById.insert(m_stations.at(row).id, row);
+
+    if (!idsByType.isEmpty()) {
+        // Списки по типам уже готовы в слепке
+        m_idsByType = idsByType;
+        for (auto it = m_idsByType.constBegin(); it != m_idsByType.constEnd(); ++it) {
+            const auto &ids = it.value();
+            for (int i = 0; i < ids.size(); ++i)
+                m_localById.insert(ids.at(i), i);
+        }
+        return;
+    }
+
+    for (const Station &st : std::as_const(m_stations)) {
+        auto &ids = m_idsByType[st.type];
+        m_localById.insert(st.id, ids.size());
+        ids.append(st.id);
+    }
+}
+
+void StationManager::ensureUrlIndex() const
+{
+    if (m_urlIndexValid)
+        return;
+    m_idsByUrl.clear();
+    m_idsByUrl.reserve(m_stations.size());
+    for (const Station &st : m_stations)
+        m_idsByUrl.insert(st.url, st.id);
+    m_urlIndexValid = true;
+}
+
+void StationManager::indexInsertLocal(quint64 id, const QString& type)
+{
+    // Список типа упорядочен по глобальной позиции; для добавления в конец
+    // lower_bound сразу даёт end(), сдвигать ничего не нужно
+    auto &ids = m_idsByType[type];
+    const int row = m_rowById.value(id, -1);
+    auto it = std::lower_bound(ids.begin(), ids.end(), row,
+                               [this](quint64 other, int r) { return m_rowById.value(other) < r; });
+    const int pos = int(it - ids.begin());
+    ids.insert(pos, id);
+    for (int i = pos; i < ids.size(); ++i)
+        m_localById[ids.at(i)] = i;
+}
+
+void StationManager::indexRemoveLocal(quint64 id, const QString& type)
+{
+    auto &ids = m_idsByType[type];
+    const int pos = m_localById.take(id);
+    if (pos < 0 || pos >= ids.size())
+        return;
+    ids.remove(pos);
+    for (int i = pos; i < ids.size(); ++i)
+        m_localById[ids.at(i)] = i;
+}
+
+quint64 StationManager::urlHash(const QString& url)
+{
+    quint64 h = 14695981039346656037ULL;
+    for (QChar c : url) {
+        h ^= c.unicode();
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void StationManager::loadVolumes()
+{
+    const AppSettings *settings = AppSettings::instance();
+    const QString prefix = QString::fromLatin1(kVolumePrefix);
+    const QStringList keys = settings->keys(prefix);
+    m_volumes.reserve(keys.size());
+    for (const QString &key : keys) {
+        bool ok = false;
+        const quint64 hash = key.mid(prefix.size()).toULongLong(&ok, 16);
+        if (ok)
+            m_volumes.insert(hash, settings->value(key).toInt());
+    }
+    m_hasLegacyVolumes = !settings->keys(QStringLiteral("volumes/")).isEmpty();
+}
+
+int StationManager::volumeForUrl(const QString& type, const QString& url)
+{
+    const quint64 hash = urlHash(url);
+    auto it = m_volumes.constFind(hash);
+    if (it != m_volumes.constEnd())
+        return it.value();
+
+    // Перенос громкости из старого MD5-ключа — только если такие ключи есть
+    if (m_hasLegacyVolumes) {
+        const QString legacyKey = QString("volumes/%1/%2").arg(type).arg(hashedUrl(url));
+        const QVariant legacy = AppSettings::instance()->value(legacyKey);
+        if (legacy.isValid()) {
+            const int volume = legacy.toInt();
+            m_volumes.insert(hash, volume);
+            m_dirtyVolumes.insert(hash);
+            m_volumeTimer->start();
+            return volume;
+        }
+    }
+    return 50;
+}
+
+void StationManager::setStationVolume(quint64 id, int volume)
+{
+    const int row = rowOf(id);
+    if (row < 0 || m_stations.at(row).volume == volume)
+        return;
+
+    m_stations[row].volume = volume;
+    const quint64 hash = urlHash(m_stations.at(row).url);
+    m_volumes.insert(hash, volume);
+    m_dirtyVolumes.insert(hash);
+    m_volumeTimer->start();  // перезапуск: пишем, когда ползунок отпустили
+}
+
+void StationManager::persistVolumes()
+{
+    m_volumeTimer->stop();
+    if (m_dirtyVolumes.isEmpty())
+        return;
+
+    AppSettings *settings = AppSettings::instance();
+    for (quint64 hash : std::as_const(m_dirtyVolumes))
+        settings->setValue(QString::fromLatin1(kVolumePrefix) + QString::number(hash, 16), m_volumes.value(hash, 50));
+    qDebug() << "[StationManager] Persisted" << m_dirtyVolumes.size() << "station volume(s)";
+    m_dirtyVolumes.clear();
+}
+
+void StationManager::save() const
+{
+    // Всё, что было в журнале до этого момента, войдёт в stations.json;
+    // *.old удаляется только если за время записи не было новой ротации
+    const int generation = m_journal->rotate();
+    StationJournal *journal = m_journal;
+
+    // Снимок дешёвый (implicit sharing), сериализация — уже в фоне
+    const QString path = m_jsonPath;
+    const QString snapPath = snapshotPath(m_snapshotSlot == 0 ? 1 : 0);
+    const QVector<Station> snapshot = m_stations;
+    const quint64 nextId = m_nextId;
+    m_writer->schedule([path, snapPath, snapshot, nextId, journal, generation]() {
+        if (!writeStationsFile(path, snapshot)) {
+            qWarning() << "[StationManager] Failed to write" << path;
+            return;
+        }
+        journal->removeRotated(generation);
+        // Слепок привязан к только что записанному JSON
+        if (!StationSnapshot::write(snapPath, path, snapshot, nextId))
+            qWarning() << "[StationManager] Failed to write snapshot" << snapPath;
+    });
+}
+
+void StationManager::flush()
+{
+    persistVolumes();
+    m_writer->flush();
+}
+
+bool StationManager::writeStationsFile(const QString& path, const QVector<Station>& stations)
+{
+    QJsonArray arr;
+    for (auto &st : stations)
+        arr.append(stationToJson(st));
     QJsonDocument doc(arr);
 
-    QFile f(m_jsonPath);
-    QFileInfo info(f);
-    QDir().mkpath(info.path());
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Text))
+    QDir().mkpath(QFileInfo(path).path());
+
+    // QSaveFile пишет во временный файл и атомарно подменяет им старый —
+    // падение посреди записи не оставит обрезанный stations.json
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
         return false;
 
-    f.write(doc.toJson(QJsonDocument::Indented));
-    return true;
+    f.write(doc.toJson(QJsonDocument::Compact));
+    return f.commit();
+}
+
+QJsonObject StationManager::stationToJson(const Station& st)
+{
+    QJsonObject o;
+    o.insert("id",   qint64(st.id));
+    o.insert("name", st.name);
+    o.insert("url",  st.url);
+    o.insert("type", st.type);
+    // Без зеркал ключа нет — файл остаётся прежнего вида
+    if (!st.mirrors.isEmpty())
+        o.insert("mirrors", QJsonArray::fromStringList(st.mirrors));
+    return o;
+}
+
+Station StationManager::stationFromJson(const QJsonObject& o)
+{
+    Station st;
+    st.id   = quint64(o.value("id").toInteger(0));
+    st.name = o.value("name").toString();
+    st.url  = o.value("url").toString();
+    st.type = o.value("type").toString("radio"); // по умолчанию radio
+    for (const QJsonValue& v : o.value("mirrors").toArray()) {
+        const QString mirror = v.toString().trimmed();
+        if (!mirror.isEmpty() && mirror != st.url && !st.mirrors.contains(mirror))
+            st.mirrors << mirror;
+    }
+    return st;
+}
+
+void StationManager::record(const QJsonObject& op, const QJsonObject& inverse)
+{
+    // Одна короткая запись с fsync вместо перезаписи всего stations.json
+    m_journal->append(op);
+    if (!m_undoing && !inverse.isEmpty()) {
+        m_undo.append(inverse);
+        if (m_undo.size() > kUndoLimit)
+            m_undo.removeFirst();
+    }
+    if (m_journal->size() > kJournalCompactBytes)
+        save();
 }
 
 QVector<Station> StationManager::stationsForType(const QString& type) const
 {
     QVector<Station> result;
-    for (const auto &st : m_stations)
-        if (st.type == type)
-            result.append(st);
+    const auto &ids = idsForType(type);
+    result.reserve(ids.size());
+    for (quint64 id : ids)
+        result.append(m_stations.at(m_rowById.value(id)));
     return result;
 }
 
-int StationManager::lastStationIndex(const QString& type) const
+const Station* StationManager::stationById(quint64 id) const
+{
+    const int row = rowOf(id);
+    return row >= 0 ? &m_stations.at(row) : nullptr;
+}
+
+int StationManager::rowOf(quint64 id) const
+{
+    return m_rowById.value(id, -1);
+}
+
+int StationManager::localIndexOf(quint64 id) const
+{
+    return m_localById.value(id, -1);
+}
+
+quint64 StationManager::idAt(const QString& type, int localIndex) const
+{
+    const auto &ids = idsForType(type);
+    if (localIndex < 0 || localIndex >= ids.size())
+        return 0;
+    return ids.at(localIndex);
+}
+
+int StationManager::countForType(const QString& type) const
+{
+    return idsForType(type).size();
+}
+
+const QVector<quint64>& StationManager::idsForType(const QString& type) const
+{
+    static const QVector<quint64> empty;
+    auto it = m_idsByType.constFind(type);
+    return it != m_idsByType.constEnd() ? it.value() : empty;
+}
+
+quint64 StationManager::idForUrl(const QString& url) const
+{
+    ensureUrlIndex();
+    return m_idsByUrl.value(url, 0);
+}
+
+quint64 StationManager::lastStationId(const QString& type) const
 {
-    QSettings settings(QSettings::IniFormat, QSettings::UserScope,
-                       "MyApp", "LoraRadio");
-    return settings.value(QString("player/%1/lastIndex").arg(type), -1).toInt();
+    const AppSettings *settings = AppSettings::instance();
+    const QString idKey = QString("player/%1/lastId").arg(type);
+    if (settings->contains(idKey))
+        return settings->value(idKey).toULongLong();
+
+    // Старые версии хранили локальный индекс
+    return idAt(type, settings->value(QString("player/%1/lastIndex").arg(type), -1).toInt());
 }
 
-void StationManager::setLastStationIndex(int index, const QString& type)
+void StationManager::setLastStationId(quint64 id)
 {
-    QSettings settings(QSettings::IniFormat, QSettings::UserScope,
-                       "MyApp", "LoraRadio");
-    int prev = settings.value(QString("player/%1/lastIndex").arg(type), -1).toInt();
-    if (prev == index)
+    const Station *st = stationById(id);
+    if (!st)
         return;
 
-    settings.setValue(QString("player/%1/lastIndex").arg(type), index);
-    settings.sync();
-    emit lastStationIndexChanged(index);
+    AppSettings *settings = AppSettings::instance();
+    const QString idKey = QString("player/%1/lastId").arg(st->type);
+    if (settings->contains(idKey) && settings->value(idKey).toULongLong() == id)
+        return;
+
+    settings->setValue(idKey, id);
+    emit lastStationChanged(id);
+}
+
+void StationManager::persistNextId()
+{
+    AppSettings *settings = AppSettings::instance();
+    if (settings->value("stations/nextId", 0).toULongLong() != m_nextId)
+        settings->setValue("stations/nextId", m_nextId);
 }
 
-void StationManager::addStation(const Station &st)
+quint64 StationManager::addStation(const Station &st)
 {
     Station newSt = st;
-    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "MyApp", "LoraRadio");
-    QString key = QString("volumes/%1/%2").arg(st.type).arg(hashedUrl(st.url));
-    newSt.volume = settings.value(key, 50).toInt();
-    m_stations.append(newSt);
-    emit stationAdded(m_stations.size() - 1);
-    emit stationsChanged();
+    newSt.id = m_nextId++;
+    persistNextId();
+    newSt.volume = volumeForUrl(st.type, st.url);
+    insertStation(newSt, m_stations.size());
+    return newSt.id;
 }
 
-void StationManager::removeStation(int index)
+void StationManager::insertStation(const Station &st, int row)
 {
-    qDebug() << "[StationManager] removeStation called with index:" << index;
-    qDebug() << "[StationManager] Total stations before removal:" << m_stations.size();
+    if (rowOf(st.id) >= 0)
+        return;
+    row = qBound(0, row, int(m_stations.size()));
+
+    emit stationAboutToBeAdded(row);
+    m_stations.insert(row, st);
+
+    for (int r = row; r < m_stations.size(); ++r)
+        m_rowById[m_stations.at(r).id] = r;
+    indexInsertLocal(st.id, st.type);
+    if (m_urlIndexValid)
+        m_idsByUrl.insert(st.url, st.id);
 
-    if (index < 0 || index >= m_stations.size()) {
-        qWarning() << "[StationManager] Invalid index:" << index;
+    emit stationAdded(st.id);
+
+    QJsonObject op = stationToJson(st);
+    op.insert("op", "add");
+    op.insert("row", row);
+    record(op, journalOp("remove", st.id));
+}
+
+int StationManager::addStations(const QVector<Station> &stations)
+{
+    if (stations.isEmpty())
+        return 0;
+
+    const int first = m_stations.size();
+    const int last  = first + stations.size() - 1;
+    emit stationsAboutToBeAppended(first, last);
+
+    m_stations.reserve(m_stations.size() + stations.size());
+    m_rowById.reserve(m_stations.size() + stations.size());
+    m_localById.reserve(m_stations.size() + stations.size());
+    for (const Station &st : stations) {
+        Station newSt = st;
+        newSt.id = m_nextId++;
+        newSt.volume = volumeForUrl(st.type, st.url);
+        m_stations.append(newSt);
+
+        // Добавление в конец: локальный порядок типа не сдвигается
+        m_rowById.insert(newSt.id, m_stations.size() - 1);
+        auto &ids = m_idsByType[newSt.type];
+        m_localById.insert(newSt.id, ids.size());
+        ids.append(newSt.id);
+        if (m_urlIndexValid)
+            m_idsByUrl.insert(newSt.url, newSt.id);
+    }
+
+    persistNextId();
+    qDebug() << "[StationManager] Added" << stations.size() << "stations in one batch";
+    emit stationsAppended(first, last);
+
+    QJsonArray added;
+    QJsonArray ids;
+    for (int row = first; row <= last; ++row) {
+        added.append(stationToJson(m_stations.at(row)));
+        ids.append(qint64(m_stations.at(row).id));
+    }
+    QJsonObject op;
+    op.insert("op", "add");
+    op.insert("stations", added);
+    QJsonObject inverse;
+    inverse.insert("op", "remove");
+    inverse.insert("ids", ids);
+    record(op, inverse);
+    return stations.size();
+}
+
+void StationManager::removeStation(quint64 id)
+{
+    qDebug() << "[StationManager] removeStation called with id:" << id;
+
+    const int row = rowOf(id);
+    if (row < 0) {
+        qWarning() << "[StationManager] Invalid id:" << id;
         return;
     }
 
-    qDebug() << "[StationManager] Removing station:" << m_stations.at(index).name;
-    m_stations.remove(index);
+    const Station removed = m_stations.at(row);
+    qDebug() << "[StationManager] Removing station:" << removed.name;
+
+    emit stationAboutToBeRemoved(id, row);
+
+    indexRemoveLocal(id, removed.type);
+    if (m_urlIndexValid)
+        m_idsByUrl.remove(removed.url, id);
+    m_rowById.remove(id);
+    m_stations.remove(row);
+    for (int r = row; r < m_stations.size(); ++r)
+        m_rowById[m_stations.at(r).id] = r;
+
     qDebug() << "[StationManager] Total stations after removal:" << m_stations.size();
 
-    emit stationRemoved(index);
+    emit stationRemoved(id);
+
+    QJsonObject inverse = stationToJson(removed);
+    inverse.insert("op", "add");
+    inverse.insert("row", row);
+    record(journalOp("remove", id), inverse);
+}
+
+void StationManager::removeStations(const QSet<quint64>& ids)
+{
+    // Откат импорта: одна перезагрузка модели вместо тысяч удалений строк
+    emit stationsAboutToBeReset();
+    QJsonArray removed;
+    m_stations.removeIf([&](const Station &st) {
+        if (!ids.contains(st.id))
+            return false;
+        removed.append(qint64(st.id));
+        return true;
+    });
+    rebuildIndex();
     emit stationsChanged();
+
+    QJsonObject op;
+    op.insert("op", "remove");
+    op.insert("ids", removed);
+    record(op, QJsonObject());
 }
 
-void StationManager::updateStation(int index, const Station &st)
+void StationManager::updateStation(quint64 id, const Station &st)
 {
-    if (index < 0 || index >= m_stations.size()) return;
+    const int row = rowOf(id);
+    if (row < 0) return;
 
-    const Station &old = m_stations.at(index);
+    const Station old = m_stations.at(row);
     Station updated = st;
+    updated.id = id;
+    if (updated.type.isEmpty())
+        updated.type = old.type;
 
-    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "MyApp", "LoraRadio");
-    if (old.url != st.url || old.type != st.type) {
+    if (old.url != updated.url || old.type != updated.type) {
         // Если URL или type изменились, загружаем volume для нового ключа (default 50)
-        QString newKey = QString("volumes/%1/%2").arg(st.type).arg(hashedUrl(st.url));
-        updated.volume = settings.value(newKey, 50).toInt();
+        updated.volume = volumeForUrl(updated.type, updated.url);
     }
 
-    m_stations[index] = updated;
+    m_stations[row] = updated;
 
-    bool structuralChange = (old.name != st.name) || (old.url != st.url) || (old.type != st.type);
+    if (m_urlIndexValid && old.url != updated.url) {
+        m_idsByUrl.remove(old.url, id);
+        m_idsByUrl.insert(updated.url, id);
+    }
+    if (old.type != updated.type) {
+        indexRemoveLocal(id, old.type);
+        indexInsertLocal(id, updated.type);
+    }
+
+    bool structuralChange = (old.name != updated.name) || (old.url != updated.url) || (old.type != updated.type)
+                            || (old.mirrors != updated.mirrors);
     if (structuralChange) {
-        emit stationUpdated(index);
-        emit stationsChanged();
+        emit stationUpdated(id);
+
+        QJsonObject op = stationToJson(updated);
+        op.insert("op", "update");
+        QJsonObject inverse = stationToJson(old);
+        inverse.insert("op", "update");
+        record(op, inverse);
     }
-}
\ No newline at end of file
+}
+
+void StationManager::moveStation(quint64 id, int row)
+{
+    const int from = rowOf(id);
+    if (from < 0)
+        return;
+    const int to = qBound(0, row, int(m_stations.size()) - 1);
+    if (from == to)
+        return;
+
+    const QString type = m_stations.at(from).type;
+    emit stationAboutToBeMoved(from, to);
+
+    indexRemoveLocal(id, type);
+    m_stations.move(from, to);
+    for (int r = qMin(from, to); r <= qMax(from, to); ++r)
+        m_rowById[m_stations.at(r).id] = r;
+    indexInsertLocal(id, type);
+
+    emit stationMoved(id);
+
+    QJsonObject op = journalOp("move", id);
+    op.insert("row", to);
+    QJsonObject inverse = journalOp("move", id);
+    inverse.insert("row", from);
+    record(op, inverse);
+}
+
+bool StationManager::undo()
+{
+    if (m_undo.isEmpty())
+        return false;
+
+    const QJsonObject op = m_undo.takeLast();
+    const QString kind = op.value("op").toString();
+    const quint64 id = quint64(op.value("id").toInteger(0));
+
+    // Откат сам пишется в журнал как обычная правка, но в стек не попадает
+    m_undoing = true;
+    if (kind == QLatin1String("add")) {
+        Station st = stationFromJson(op);
+        st.volume = volumeForUrl(st.type, st.url);
+        insertStation(st, op.value("row").toInt(m_stations.size()));
+    } else if (kind == QLatin1String("remove")) {
+        if (op.contains("ids")) {
+            QSet<quint64> ids;
+            for (const auto v : op.value("ids").toArray())
+                ids.insert(quint64(v.toInteger(0)));
+            removeStations(ids);
+        } else {
+            removeStation(id);
+        }
+    } else if (kind == QLatin1String("update")) {
+        updateStation(id, stationFromJson(op));
+    } else if (kind == QLatin1String("move")) {
+        moveStation(id, op.value("row").toInt());
+    }
+    m_undoing = false;
+
+    qDebug() << "[StationManager] Undo:" << kind << id;
+    return true;
+}
@@ -2,19 +2,33 @@
 
 #include <QObject>
 #include <QVector>
+#include <QHash>
+#include <QMultiHash>
+#include <QSet>
 #include <QString>
-#include <QSettings>
+#include <QStringList>
 #include <QCryptographicHash>
+#include <QJsonObject>
 
 struct Station {
+    quint64 id = 0;  // стабильный id, хранится в stations.json
     QString name;
     QString url;
     QString type; // "radio" или "youtube"
-    int volume;
+    int volume = 50;
+    QStringList mirrors;  // запасные URL (зеркала/качество) по приоритету
+
+    // Все кандидаты для воспроизведения: основной URL, затем зеркала
+    QStringList urls() const { return QStringList{ url } + mirrors; }
 };
 
 Q_DECLARE_METATYPE(Station)
 
+class BackgroundWriter;
+class StationSnapshot;
+class StationJournal;
+class QTimer;
+
 class StationManager : public QObject {
     Q_OBJECT
 public:
@@ -23,24 +37,105 @@ public:
     const QVector<Station>& stations() const { return m_stations; }
     QVector<Station> stationsForType(const QString& type) const;
 
-    int  lastStationIndex(const QString& type) const;
-    void setLastStationIndex(int index, const QString& type);
+    // Адресация по стабильному id — все операции O(1) через индексы ниже
+    const Station* stationById(quint64 id) const;
+    int     rowOf(quint64 id) const;                          // позиция в stations(), -1
+    int     localIndexOf(quint64 id) const;                   // позиция внутри своего типа, -1
+    quint64 idAt(const QString& type, int localIndex) const;  // 0 если нет
+    int     countForType(const QString& type) const;
+    const QVector<quint64>& idsForType(const QString& type) const;
+    quint64 idForUrl(const QString& url) const;               // 0 если нет
+
+    // Быстрый стабильный 64-битный хэш URL (FNV-1a) — ключ громкостей станций
+    static quint64 urlHash(const QString& url);
+
+    quint64 lastStationId(const QString& type) const;
+    void    setLastStationId(quint64 id);
+
+    bool canUndo() const { return !m_undo.isEmpty(); }
 
 public slots:
     bool load();
-    bool save() const;
-    void addStation(const Station &st);
-    void removeStation(int index);
-    void updateStation(int index, const Station &st);
-    void saveStationVolume(const Station& st);
+    // Правки станций дописываются в журнал (StationJournal) и не трогают
+    // stations.json. save() — сжатие: журнал уходит в *.old, а полный
+    // stations.json пишется в фоне через QSaveFile. flush() пишет немедленно.
+    void save() const;
+    void flush();
+    quint64 addStation(const Station &st);
+    // Пакетное добавление (импорт): одна вставка в модели и одна запись на диск
+    int addStations(const QVector<Station> &stations);
+    void removeStation(quint64 id);
+    void updateStation(quint64 id, const Station &st);
+    void moveStation(quint64 id, int row);
+    // Откат последней правки списка за сессию
+    bool undo();
+    // Громкость применяется сразу в памяти; на диск уходит только последнее
+    // значение после паузы (перетаскивание ползунка = одна запись)
+    void setStationVolume(quint64 id, int volume);
     signals:
+    // stationsChanged — полная перезагрузка списка (load); точечные правки
+    // приходят через stationAdded/stationRemoved/stationUpdated
+    void stationsAboutToBeReset();
     void stationsChanged();
-    void stationAdded(int index);
-    void stationRemoved(int index);
-    void stationUpdated(int index);
-    void lastStationIndexChanged(int index);
+    void stationAboutToBeAdded(int row);
+    void stationAdded(quint64 id);
+    void stationsAboutToBeAppended(int first, int last);
+    void stationsAppended(int first, int last);
+    void stationAboutToBeRemoved(quint64 id, int row);
+    void stationRemoved(quint64 id);
+    void stationUpdated(quint64 id);
+    void stationAboutToBeMoved(int from, int to);
+    void stationMoved(quint64 id);
+    void lastStationChanged(quint64 id);
 
 private:
+    static bool writeStationsFile(const QString& path, const QVector<Station>& stations);
+    static QJsonObject stationToJson(const Station& st);
+    static Station stationFromJson(const QJsonObject& o);
+    bool loadJson(QVector<Station>& stations, bool& assigned);
+    bool loadSnapshot(QVector<Station>& stations, QHash<QString, QVector<quint64>>& idsByType);
+    bool replayJournal(QVector<Station>& stations, const QVector<QJsonObject>& ops);
+    void record(const QJsonObject& op, const QJsonObject& inverse);
+    void insertStation(const Station& st, int row);
+    void removeStations(const QSet<quint64>& ids);
+    void scheduleSnapshot() const;
+    QString snapshotPath(int slot) const;
+    void rebuildIndex(const QHash<QString, QVector<quint64>>& idsByType = {});
+    void ensureUrlIndex() const;
+    void loadVolumes();
+    int  volumeForUrl(const QString& type, const QString& url);
+    void persistVolumes();
+    void indexInsertLocal(quint64 id, const QString& type);
+    void indexRemoveLocal(quint64 id, const QString& type);
+    void persistNextId();
+
     QString m_jsonPath;
     QVector<Station> m_stations;
+    BackgroundWriter* m_writer;
+    StationJournal*   m_journal;
+
+    // Обратные операции для undo(); только в пределах сессии
+    QVector<QJsonObject>             m_undo;
+    bool                             m_undoing = false;
+
+    // Индексы поддерживаются инкрементально в add/remove/update
+    QHash<quint64, int>              m_rowById;
+    QHash<quint64, int>              m_localById;
+    QHash<QString, QVector<quint64>> m_idsByType;
+    // Индекс URL строится лениво: при старте со слепка он не нужен,
+    // а его построение прочитало бы все строки URL с диска
+    mutable QMultiHash<QString, quint64> m_idsByUrl;
+    mutable bool                     m_urlIndexValid = false;
+    // Только растёт и хранится в настройках: id удалённой станции не
+    // достаётся новой (иначе на неё укажет старый player/<type>/lastId)
+    quint64                          m_nextId = 1;
+
+    // Слепок пишется в слот, который сейчас не отображён в память
+    // (в Windows отображённый файл нельзя подменить)
+    int                              m_snapshotSlot = -1;
+
+    QHash<quint64, int>              m_volumes;       // urlHash -> громкость
+    QSet<quint64>                    m_dirtyVolumes;
+    QTimer*                          m_volumeTimer;
+    bool                             m_hasLegacyVolumes = false;
 };
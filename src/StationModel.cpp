@@ -0,0 +1,170 @@
+#include "StationModel.h"
+#include "StationSearchIndex.h"
+
+StationModel::StationModel(StationManager* stations, QObject* parent)
+    : QAbstractListModel(parent)
+    , m_stations(stations)
+{
+    connect(m_stations, &StationManager::stationsAboutToBeReset, this, [this]() {
+        m_changing = true;
+        beginResetModel();
+    });
+    connect(m_stations, &StationManager::stationsChanged, this, [this]() {
+        endResetModel();
+        m_changing = false;
+    });
+
+    connect(m_stations, &StationManager::stationAboutToBeAdded, this, [this](int row) {
+        m_changing = true;
+        beginInsertRows(QModelIndex(), row, row);
+    });
+    connect(m_stations, &StationManager::stationAdded, this, [this](quint64) {
+        endInsertRows();
+        m_changing = false;
+    });
+
+    connect(m_stations, &StationManager::stationsAboutToBeAppended, this, [this](int first, int last) {
+        m_changing = true;
+        beginInsertRows(QModelIndex(), first, last);
+    });
+    connect(m_stations, &StationManager::stationsAppended, this, [this](int, int) {
+        endInsertRows();
+        m_changing = false;
+    });
+
+    connect(m_stations, &StationManager::stationAboutToBeRemoved, this, [this](quint64, int row) {
+        m_changing = true;
+        beginRemoveRows(QModelIndex(), row, row);
+    });
+    connect(m_stations, &StationManager::stationRemoved, this, [this](quint64) {
+        endRemoveRows();
+        m_changing = false;
+    });
+
+    connect(m_stations, &StationManager::stationAboutToBeMoved, this, [this](int from, int to) {
+        m_changing = true;
+        // Для beginMoveRows позиция назначения — строка «до» которой вставляем
+        beginMoveRows(QModelIndex(), from, from, QModelIndex(), to > from ? to + 1 : to);
+    });
+    connect(m_stations, &StationManager::stationMoved, this, [this](quint64) {
+        endMoveRows();
+        m_changing = false;
+    });
+
+    connect(m_stations, &StationManager::stationUpdated, this, [this](quint64 id) {
+        const int row = m_stations->rowOf(id);
+        if (row < 0) return;
+        const QModelIndex idx = index(row);
+        emit dataChanged(idx, idx);
+    });
+
+    // Индекс создаётся после подписок модели: его changed() пересчитывает
+    // фильтры прокси, а к этому моменту end*Rows()/endResetModel() уже
+    // должны отработать — иначе прокси строит отображение посреди вставки
+    m_searchIndex = new StationSearchIndex(stations, this);
+}
+
+int StationModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_stations->stations().size();
+}
+
+QVariant StationModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_stations->stations().size())
+        return QVariant();
+
+    const Station& st = stationAt(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+            return st.name.isEmpty() ? st.url : st.name;
+        case Qt::ToolTipRole:
+        case UrlRole:
+            return st.url;
+        case IdRole:
+            return st.id;
+        case TypeRole:
+            return st.type;
+        case VolumeRole:
+            return st.volume;
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> StationModel::roleNames() const
+{
+    QHash<int, QByteArray> names = QAbstractListModel::roleNames();
+    names.insert(UrlRole,    "url");
+    names.insert(IdRole,     "stationId");
+    names.insert(TypeRole,   "type");
+    names.insert(VolumeRole, "volume");
+    return names;
+}
+
+StationTypeModel::StationTypeModel(StationModel* source, const QString& type, QObject* parent)
+    : QSortFilterProxyModel(parent)
+    , m_source(source)
+    , m_type(type)
+{
+    setSourceModel(m_source);
+
+    // Станции добавили/изменили — активный фильтр пересчитываем целиком
+    connect(m_source->searchIndex(), &StationSearchIndex::changed, this, [this]() {
+        if (m_filterText.isEmpty()) return;
+        m_matches = m_source->searchIndex()->search(m_filterText);
+        applyFilter();
+    });
+}
+
+void StationTypeModel::setFilterText(const QString& text)
+{
+    const QString trimmed = text.trimmed();
+    if (trimmed == m_filterText) return;
+
+    StationSearchIndex *index = m_source->searchIndex();
+    if (trimmed.isEmpty())
+        m_matches.clear();
+    else if (StationSearchIndex::canRefine(m_filterText, trimmed))
+        m_matches = index->refine(m_matches, trimmed);
+    else
+        m_matches = index->search(trimmed);
+    m_filterText = trimmed;
+    applyFilter();
+}
+
+void StationTypeModel::applyFilter()
+{
+    // Скрытие строк фильтром — не выбор пользователя
+    m_filtering = true;
+    invalidateFilter();
+    m_filtering = false;
+}
+
+void StationTypeModel::setStationType(const QString& type)
+{
+    if (m_type == type) return;
+    m_type = type;
+    applyFilter();
+}
+
+quint64 StationTypeModel::idAt(int row) const
+{
+    if (row < 0 || row >= rowCount()) return 0;
+    return index(row, 0).data(StationModel::IdRole).toULongLong();
+}
+
+int StationTypeModel::rowOfId(quint64 id) const
+{
+    const int sourceRow = m_source->stationManager()->rowOf(id);
+    if (sourceRow < 0) return -1;
+    return mapFromSource(m_source->index(sourceRow)).row();
+}
+
+bool StationTypeModel::filterAcceptsRow(int sourceRow, const QModelIndex&) const
+{
+    const Station& st = m_source->stationAt(sourceRow);
+    if (st.type != m_type)
+        return false;
+    return m_filterText.isEmpty() || m_matches.contains(st.id);
+}
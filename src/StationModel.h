@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QSet>
+#include <QSortFilterProxyModel>
+#include "StationManager.h"
+
+class StationSearchIndex;
+
+// StationModel — общая модель поверх StationManager. Строка модели = позиция
+// в StationManager::stations(); изменения приходят точечными
+// rowsInserted/rowsRemoved/dataChanged вместо пересборки списков.
+class StationModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    enum Roles {
+        UrlRole = Qt::UserRole,
+        IdRole,
+        TypeRole,
+        VolumeRole
+    };
+
+    explicit StationModel(StationManager* stations, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    const Station& stationAt(int row) const { return m_stations->stations().at(row); }
+    StationManager* stationManager() const { return m_stations; }
+    StationSearchIndex* searchIndex() const { return m_searchIndex; }
+
+    // true пока идёт структурное изменение — представления не должны
+    // воспринимать сдвиг текущей строки как выбор пользователя
+    bool isChanging() const { return m_changing; }
+
+private:
+    StationManager*     m_stations;
+    StationSearchIndex* m_searchIndex = nullptr;
+    bool                m_changing = false;
+};
+
+// StationTypeModel — срез общей модели по типу станции ("radio"/"youtube")
+// с необязательным текстовым фильтром (StationSearchIndex).
+class StationTypeModel : public QSortFilterProxyModel {
+    Q_OBJECT
+public:
+    explicit StationTypeModel(StationModel* source, const QString& type, QObject* parent = nullptr);
+
+    QString stationType() const { return m_type; }
+    void setStationType(const QString& type);
+
+    // Фильтр по мере набора: если запрос лишь дописан, сужается прошлый
+    // результат, иначе — поиск по индексу
+    QString filterText() const { return m_filterText; }
+    void setFilterText(const QString& text);
+
+    quint64 idAt(int row) const;
+    int rowOfId(quint64 id) const;
+    bool isChanging() const { return m_source->isChanging() || m_filtering; }
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    void applyFilter();
+
+    StationModel* m_source;
+    QString       m_type;
+    QString       m_filterText;
+    QSet<quint64> m_matches;
+    bool          m_filtering = false;
+};
@@ -0,0 +1,280 @@
+#include "StationSearchIndex.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Доля триграмм терма, которая должна найтись для нечёткого совпадения
+    const double kFuzzyRatio = 0.7;
+    const int    kFuzzyMinLength = 4;
+
+    quint64 trigramKey(const QChar* p)
+    {
+        return (quint64(p[0].unicode()) << 32) | (quint64(p[1].unicode()) << 16) | p[2].unicode();
+    }
+
+    quint32 prefixKey(QChar a, QChar b = QChar())
+    {
+        return (quint32(a.unicode()) << 16) | b.unicode();
+    }
+
+    QSet<quint64> trigramsOf(const QString& s)
+    {
+        QSet<quint64> result;
+        for (int i = 0; i + 3 <= s.size(); ++i)
+            result.insert(trigramKey(s.constData() + i));
+        return result;
+    }
+
+    QSet<quint32> prefixesOf(const QString& s)
+    {
+        QSet<quint32> result;
+        for (int i = 0; i < s.size(); ++i) {
+            if (i > 0 && s.at(i - 1) != QLatin1Char(' '))
+                continue;
+            if (s.at(i) == QLatin1Char(' '))
+                continue;
+            result.insert(prefixKey(s.at(i)));
+            if (i + 1 < s.size() && s.at(i + 1) != QLatin1Char(' '))
+                result.insert(prefixKey(s.at(i), s.at(i + 1)));
+        }
+        return result;
+    }
+
+    int fuzzyThreshold(int trigramCount)
+    {
+        return qMax(1, int(std::ceil(trigramCount * kFuzzyRatio)));
+    }
+
+    bool termMatches(const QString& text, const QString& term)
+    {
+        if (term.size() < 3)
+            return text.startsWith(term) || text.contains(QLatin1Char(' ') + term);
+        if (text.contains(term))
+            return true;
+        if (term.size() < kFuzzyMinLength)
+            return false;
+
+        // Опечатка/перестановка: большая часть триграмм терма есть в тексте
+        const QSet<quint64> termGrams = trigramsOf(term);
+        int hits = 0;
+        for (quint64 g : termGrams) {
+            for (int i = 0; i + 3 <= text.size(); ++i) {
+                if (trigramKey(text.constData() + i) == g) {
+                    ++hits;
+                    break;
+                }
+            }
+        }
+        return hits >= fuzzyThreshold(termGrams.size());
+    }
+}
+
+StationSearchIndex::StationSearchIndex(StationManager* stations, QObject* parent)
+    : QObject(parent)
+    , m_stations(stations)
+{
+    connect(m_stations, &StationManager::stationsChanged, this, [this]() {
+        // Полная перезагрузка — пересобираем сразу после неё, а не на
+        // первом нажатии клавиши
+        m_built = false;
+        m_text.clear();
+        m_trigrams.clear();
+        m_prefixes.clear();
+        scheduleBuild();
+        emit changed();
+    });
+    connect(m_stations, &StationManager::stationAdded, this, [this](quint64 id) {
+        if (m_built) insert(id);
+        emit changed();
+    });
+    connect(m_stations, &StationManager::stationsAppended, this, [this](int first, int last) {
+        if (m_built) {
+            for (int row = first; row <= last; ++row)
+                insert(m_stations->stations().at(row).id);
+        }
+        emit changed();
+    });
+    connect(m_stations, &StationManager::stationAboutToBeRemoved, this, [this](quint64 id, int) {
+        if (m_built) remove(id);
+    });
+    connect(m_stations, &StationManager::stationRemoved, this, &StationSearchIndex::changed);
+    connect(m_stations, &StationManager::stationUpdated, this, [this](quint64 id) {
+        if (m_built) {
+            remove(id);
+            insert(id);
+        }
+        emit changed();
+    });
+
+    // Менеджер к этому моменту уже загружен
+    scheduleBuild();
+}
+
+QString StationSearchIndex::normalized(const QString& text)
+{
+    // Без регистра и диакритики, всё кроме букв и цифр — один пробел
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString out;
+    out.reserve(decomposed.size());
+    bool space = true;
+    for (QChar c : decomposed) {
+        if (c.category() == QChar::Mark_NonSpacing)
+            continue;
+        if (c.isLetterOrNumber()) {
+            out.append(c.toCaseFolded());
+            space = false;
+        } else if (!space) {
+            out.append(QLatin1Char(' '));
+            space = true;
+        }
+    }
+    if (out.endsWith(QLatin1Char(' ')))
+        out.chop(1);
+    return out;
+}
+
+void StationSearchIndex::scheduleBuild()
+{
+    // Очередью: загрузка (и первый показ окна) не ждёт построения
+    QMetaObject::invokeMethod(this, &StationSearchIndex::ensureBuilt, Qt::QueuedConnection);
+}
+
+void StationSearchIndex::ensureBuilt()
+{
+    if (m_built)
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+    const auto& stations = m_stations->stations();
+    m_text.reserve(stations.size());
+    for (const Station& st : stations)
+        insert(st.id);
+    m_built = true;
+    qDebug() << "[StationSearchIndex] Built for" << stations.size() << "stations in" << timer.elapsed() << "ms";
+}
+
+void StationSearchIndex::insert(quint64 id)
+{
+    const Station* st = m_stations->stationById(id);
+    if (!st)
+        return;
+
+    const QString text = normalized(st->name.isEmpty() ? st->url : st->name);
+    m_text.insert(id, text);
+    for (quint64 g : trigramsOf(text))
+        m_trigrams[g].append(id);
+    for (quint32 p : prefixesOf(text))
+        m_prefixes[p].append(id);
+}
+
+void StationSearchIndex::remove(quint64 id)
+{
+    const QString text = m_text.take(id);
+    for (quint64 g : trigramsOf(text)) {
+        auto it = m_trigrams.find(g);
+        if (it == m_trigrams.end()) continue;
+        it->removeOne(id);
+        if (it->isEmpty()) m_trigrams.erase(it);
+    }
+    for (quint32 p : prefixesOf(text)) {
+        auto it = m_prefixes.find(p);
+        if (it == m_prefixes.end()) continue;
+        it->removeOne(id);
+        if (it->isEmpty()) m_prefixes.erase(it);
+    }
+}
+
+bool StationSearchIndex::matches(const QString& text, const QStringList& terms) const
+{
+    for (const QString& term : terms) {
+        if (!termMatches(text, term))
+            return false;
+    }
+    return true;
+}
+
+QSet<quint64> StationSearchIndex::candidates(const QString& term) const
+{
+    QSet<quint64> result;
+    if (term.size() < 3) {
+        const quint32 key = term.size() == 1 ? prefixKey(term.at(0)) : prefixKey(term.at(0), term.at(1));
+        const auto ids = m_prefixes.value(key);
+        result = QSet<quint64>(ids.cbegin(), ids.cend());
+        return result;
+    }
+
+    // Кандидаты — станции, где нашлось достаточно триграмм терма;
+    // для точной подстроки это все триграммы, для нечёткой — порог
+    const QSet<quint64> grams = trigramsOf(term);
+    const int needed = term.size() < kFuzzyMinLength ? grams.size() : fuzzyThreshold(grams.size());
+    QHash<quint64, int> hits;
+    for (quint64 g : grams) {
+        auto it = m_trigrams.constFind(g);
+        if (it == m_trigrams.constEnd()) continue;
+        for (quint64 id : it.value())
+            ++hits[id];
+    }
+    for (auto it = hits.constBegin(); it != hits.constEnd(); ++it) {
+        if (it.value() >= needed)
+            result.insert(it.key());
+    }
+    return result;
+}
+
+QSet<quint64> StationSearchIndex::search(const QString& query)
+{
+    QStringList terms = normalized(query).split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    if (terms.isEmpty())
+        return {};
+
+    ensureBuilt();
+
+    // Кандидатов даёт самый длинный (обычно самый избирательный) терм
+    std::sort(terms.begin(), terms.end(), [](const QString& a, const QString& b) { return a.size() > b.size(); });
+    QSet<quint64> result;
+    for (quint64 id : candidates(terms.first())) {
+        if (matches(m_text.value(id), terms))
+            result.insert(id);
+    }
+    return result;
+}
+
+bool StationSearchIndex::canRefine(const QString& previousQuery, const QString& query)
+{
+    const QString prev = normalized(previousQuery);
+    const QString next = normalized(query);
+    if (prev.isEmpty() || !next.startsWith(prev))
+        return false;
+
+    // Дописанный последний терм не должен сменить режим сопоставления:
+    // префикс слова (<3) -> подстрока, точное (<4) -> нечёткое. Нечёткий
+    // результат при дописывании не только сужается: порог ceil(0.7·n)
+    // растёт медленнее числа триграмм («class» не находит «Klassik»,
+    // «classi» — находит), поэтому нечёткий терм — только полный поиск
+    const QString prevLast = prev.section(QLatin1Char(' '), -1);
+    const QString nextLast = next.section(QLatin1Char(' '), prev.count(QLatin1Char(' ')),
+                                          prev.count(QLatin1Char(' ')));
+    const auto mode = [](int len) { return len < 3 ? 0 : (len < kFuzzyMinLength ? 1 : 2); };
+    const int prevMode = mode(prevLast.size());
+    return prevMode < 2 && prevMode == mode(nextLast.size());
+}
+
+QSet<quint64> StationSearchIndex::refine(const QSet<quint64>& previous, const QString& query)
+{
+    const QStringList terms = normalized(query).split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    if (terms.isEmpty())
+        return {};
+
+    ensureBuilt();
+
+    QSet<quint64> result;
+    result.reserve(previous.size());
+    for (quint64 id : previous) {
+        if (matches(m_text.value(id), terms))
+            result.insert(id);
+    }
+    return result;
+}
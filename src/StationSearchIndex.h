@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include "StationManager.h"
+
+// StationSearchIndex — индекс для фильтра списков по мере набора.
+// Короткие термы (1–2 символа) ищутся по префиксам слов, длинные — по
+// триграммам: подстрока или нечёткое совпадение (≥70% триграмм терма).
+// Индекс строится сразу после загрузки списка (очередью, не задерживая
+// старт) и дальше поддерживается точечно по сигналам StationManager.
+class StationSearchIndex : public QObject {
+    Q_OBJECT
+public:
+    explicit StationSearchIndex(StationManager* stations, QObject* parent = nullptr);
+
+    // Полный поиск по индексу
+    QSet<quint64> search(const QString& query);
+    // Сужение прошлого результата, когда запрос лишь дописали
+    QSet<quint64> refine(const QSet<quint64>& previous, const QString& query);
+    // Можно ли сузить результат previousQuery вместо полного поиска
+    static bool canRefine(const QString& previousQuery, const QString& query);
+
+    static QString normalized(const QString& text);
+
+signals:
+    // Набор станций изменился — активные фильтры нужно пересчитать
+    void changed();
+
+private:
+    void scheduleBuild();
+    void ensureBuilt();
+    void insert(quint64 id);
+    void remove(quint64 id);
+    bool matches(const QString& text, const QStringList& terms) const;
+    QSet<quint64> candidates(const QString& term) const;
+
+    StationManager* m_stations;
+    bool            m_built = false;
+
+    QHash<quint64, QString>            m_text;       // нормализованное имя
+    QHash<quint64, QVector<quint64>>   m_trigrams;   // триграмма -> id
+    QHash<quint32, QVector<quint64>>   m_prefixes;   // 1–2 первых символа слова -> id
+};
@@ -0,0 +1,306 @@
+#include "StationSnapshot.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+    const char    kMagic[4]  = { 'L', 'R', 'S', 'S' };
+    const quint32 kVersion   = 2;
+    const quint32 kEndianTag = 0x01020304;
+
+    struct Header {
+        char    magic[4];
+        quint32 version;
+        quint32 endianTag;
+        quint32 count;
+        quint64 nextId;
+        qint64  jsonSize;
+        qint64  jsonMtimeMs;
+        quint64 jsonHash;
+        quint32 typeCount;
+        quint32 recordsOffset;
+        quint32 typesOffset;
+        quint32 rowsOffset;
+        quint32 stringsOffset;
+        quint32 stringsLength;  // в UTF-16 единицах
+    };
+
+    struct Record {
+        quint64 id;
+        quint64 urlHash;
+        quint32 nameOffset;
+        quint32 nameLength;
+        quint32 urlOffset;
+        quint32 urlLength;
+        quint16 typeIndex;
+        quint16 volume;
+        quint32 mirrorsOffset;  // зеркала одной строкой через '\n'
+        quint32 mirrorsLength;
+        quint32 reserved;
+    };
+
+    struct TypeEntry {
+        quint32 nameOffset;
+        quint32 nameLength;
+        quint32 rowsIndex;   // позиция первой строки в массиве rows
+        quint32 count;
+    };
+
+    quint32 align8(quint32 v) { return (v + 7u) & ~7u; }
+}
+
+StationSnapshot::StationSnapshot(QObject* parent)
+    : QObject(parent)
+{
+}
+
+StationSnapshot::~StationSnapshot()
+{
+    close();
+}
+
+void StationSnapshot::close()
+{
+    if (m_data)
+        m_file.unmap(const_cast<uchar*>(m_data));
+    m_data = nullptr;
+    m_size = 0;
+    m_file.close();
+}
+
+quint64 StationSnapshot::hashBytes(const QByteArray& bytes)
+{
+    quint64 h = 14695981039346656037ULL;
+    for (char c : bytes) {
+        h ^= quint8(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+bool StationSnapshot::open(const QString& path, const QString& jsonPath)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_size = m_file.size();
+    if (m_size < qint64(sizeof(Header))) {
+        close();
+        return false;
+    }
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        qWarning() << "[StationSnapshot] Cannot map" << path << m_file.errorString();
+        close();
+        return false;
+    }
+
+    const Header* h = reinterpret_cast<const Header*>(m_data);
+    const bool headerOk =
+        std::memcmp(h->magic, kMagic, sizeof(kMagic)) == 0 &&
+        h->version == kVersion &&
+        h->endianTag == kEndianTag &&
+        qint64(h->recordsOffset) + qint64(h->count) * qint64(sizeof(Record)) <= m_size &&
+        qint64(h->typesOffset) + qint64(h->typeCount) * qint64(sizeof(TypeEntry)) <= m_size &&
+        qint64(h->rowsOffset) + qint64(h->count) * 4 <= m_size &&
+        qint64(h->stringsOffset) + qint64(h->stringsLength) * 2 <= m_size;
+    if (!headerOk) {
+        qWarning() << "[StationSnapshot] Ignoring incompatible snapshot" << path;
+        close();
+        return false;
+    }
+
+    // Актуальность: размер и mtime JSON; если mtime сменился (копирование,
+    // touch), сверяем хэш содержимого — это всё равно дешевле разбора JSON
+    const QFileInfo jsonInfo(jsonPath);
+    if (!jsonInfo.exists() || jsonInfo.size() != h->jsonSize) {
+        close();
+        return false;
+    }
+    if (jsonInfo.lastModified().toMSecsSinceEpoch() != h->jsonMtimeMs) {
+        QFile json(jsonPath);
+        if (!json.open(QIODevice::ReadOnly) || hashBytes(json.readAll()) != h->jsonHash) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+int StationSnapshot::count() const
+{
+    return m_data ? int(reinterpret_cast<const Header*>(m_data)->count) : 0;
+}
+
+quint64 StationSnapshot::nextId() const
+{
+    return m_data ? reinterpret_cast<const Header*>(m_data)->nextId : 1;
+}
+
+QString StationSnapshot::stringAt(quint32 offset, quint32 length) const
+{
+    const Header* h = reinterpret_cast<const Header*>(m_data);
+    if (quint64(offset) + length > h->stringsLength)
+        return QString();
+    const QChar* base = reinterpret_cast<const QChar*>(m_data + h->stringsOffset);
+    return QString::fromRawData(base + offset, qsizetype(length));
+}
+
+QVector<Station> StationSnapshot::stations(const QHash<quint64, int>& volumes) const
+{
+    QVector<Station> result;
+    if (!m_data)
+        return result;
+
+    const Header* h = reinterpret_cast<const Header*>(m_data);
+    const Record* records = reinterpret_cast<const Record*>(m_data + h->recordsOffset);
+    const TypeEntry* types = reinterpret_cast<const TypeEntry*>(m_data + h->typesOffset);
+
+    // Имена типов — несколько коротких строк, их копируем
+    QVector<QString> typeNames;
+    typeNames.reserve(h->typeCount);
+    for (quint32 t = 0; t < h->typeCount; ++t)
+        typeNames.append(QString(stringAt(types[t].nameOffset, types[t].nameLength)));
+
+    result.resize(h->count);
+    for (quint32 i = 0; i < h->count; ++i) {
+        const Record& r = records[i];
+        Station& st = result[i];
+        st.id     = r.id;
+        st.name   = stringAt(r.nameOffset, r.nameLength);
+        st.url    = stringAt(r.urlOffset, r.urlLength);
+        st.type   = r.typeIndex < typeNames.size() ? typeNames.at(r.typeIndex) : QStringLiteral("radio");
+        st.volume = volumes.value(r.urlHash, int(r.volume));
+        if (r.mirrorsLength > 0)
+            st.mirrors = stringAt(r.mirrorsOffset, r.mirrorsLength).split(QLatin1Char('\n'));
+    }
+    return result;
+}
+
+QHash<QString, QVector<quint64>> StationSnapshot::idsByType() const
+{
+    QHash<QString, QVector<quint64>> result;
+    if (!m_data)
+        return result;
+
+    const Header* h = reinterpret_cast<const Header*>(m_data);
+    const Record* records = reinterpret_cast<const Record*>(m_data + h->recordsOffset);
+    const TypeEntry* types = reinterpret_cast<const TypeEntry*>(m_data + h->typesOffset);
+    const quint32* rows = reinterpret_cast<const quint32*>(m_data + h->rowsOffset);
+
+    for (quint32 t = 0; t < h->typeCount; ++t) {
+        const TypeEntry& te = types[t];
+        if (quint64(te.rowsIndex) + te.count > h->count)
+            continue;
+        QVector<quint64> ids;
+        ids.reserve(te.count);
+        for (quint32 k = 0; k < te.count; ++k) {
+            const quint32 row = rows[te.rowsIndex + k];
+            if (row < h->count)
+                ids.append(records[row].id);
+        }
+        result.insert(QString(stringAt(te.nameOffset, te.nameLength)), ids);
+    }
+    return result;
+}
+
+bool StationSnapshot::write(const QString& path, const QString& jsonPath, const QVector<Station>& stations,
+                            quint64 nextId)
+{
+    QFile json(jsonPath);
+    if (!json.open(QIODevice::ReadOnly))
+        return false;
+    const QByteArray jsonBytes = json.readAll();
+    json.close();
+    const QFileInfo jsonInfo(jsonPath);
+
+    QByteArray strings;
+    auto addString = [&strings](const QString& s, quint32& offset, quint32& length) {
+        offset = quint32(strings.size() / 2);
+        length = quint32(s.size());
+        strings.append(reinterpret_cast<const char*>(s.constData()), s.size() * 2);
+    };
+
+    QVector<Record> records(stations.size());
+    QVector<TypeEntry> types;
+    QVector<QVector<quint32>> rowsByType;
+    QHash<QString, quint16> typeIndex;
+    quint64 maxId = 0;
+
+    for (int i = 0; i < stations.size(); ++i) {
+        const Station& st = stations.at(i);
+        Record& r = records[i];
+        std::memset(&r, 0, sizeof(Record));
+        r.id      = st.id;
+        r.urlHash = StationManager::urlHash(st.url);
+        r.volume  = quint16(qBound(0, st.volume, 100));
+        addString(st.name, r.nameOffset, r.nameLength);
+        addString(st.url,  r.urlOffset,  r.urlLength);
+        addString(st.mirrors.join(QLatin1Char('\n')), r.mirrorsOffset, r.mirrorsLength);
+
+        auto it = typeIndex.constFind(st.type);
+        if (it == typeIndex.constEnd()) {
+            it = typeIndex.insert(st.type, quint16(types.size()));
+            TypeEntry te;
+            std::memset(&te, 0, sizeof(TypeEntry));
+            addString(st.type, te.nameOffset, te.nameLength);
+            types.append(te);
+            rowsByType.append(QVector<quint32>());
+        }
+        r.typeIndex = it.value();
+        rowsByType[it.value()].append(quint32(i));
+        maxId = qMax(maxId, st.id);
+    }
+
+    QByteArray rows;
+    quint32 rowsIndex = 0;
+    for (int t = 0; t < types.size(); ++t) {
+        types[t].rowsIndex = rowsIndex;
+        types[t].count     = quint32(rowsByType.at(t).size());
+        rows.append(reinterpret_cast<const char*>(rowsByType.at(t).constData()),
+                    rowsByType.at(t).size() * sizeof(quint32));
+        rowsIndex += types[t].count;
+    }
+
+    Header h;
+    std::memset(&h, 0, sizeof(Header));
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version       = kVersion;
+    h.endianTag     = kEndianTag;
+    h.count         = quint32(stations.size());
+    h.nextId        = qMax(nextId, maxId + 1);
+    h.jsonSize      = jsonInfo.size();
+    h.jsonMtimeMs   = jsonInfo.lastModified().toMSecsSinceEpoch();
+    h.jsonHash      = hashBytes(jsonBytes);
+    h.typeCount     = quint32(types.size());
+    h.recordsOffset = align8(sizeof(Header));
+    h.typesOffset   = align8(h.recordsOffset + quint32(records.size() * sizeof(Record)));
+    h.rowsOffset    = align8(h.typesOffset + quint32(types.size() * sizeof(TypeEntry)));
+    h.stringsOffset = align8(h.rowsOffset + quint32(rows.size()));
+    h.stringsLength = quint32(strings.size() / 2);
+
+    QByteArray out;
+    out.reserve(h.stringsOffset + strings.size());
+    auto pad = [&out](quint32 offset) { out.append(QByteArray(int(offset) - out.size(), '\0')); };
+
+    out.append(reinterpret_cast<const char*>(&h), sizeof(Header));
+    pad(h.recordsOffset);
+    out.append(reinterpret_cast<const char*>(records.constData()), records.size() * sizeof(Record));
+    pad(h.typesOffset);
+    out.append(reinterpret_cast<const char*>(types.constData()), types.size() * sizeof(TypeEntry));
+    pad(h.rowsOffset);
+    out.append(rows);
+    pad(h.stringsOffset);
+    out.append(strings);
+
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+    f.write(out);
+    return f.commit();
+}
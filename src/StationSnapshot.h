@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include "StationManager.h"
+
+// StationSnapshot — компактный бинарный слепок stations.json для быстрого
+// холодного старта. Файл отображается в память (QFile::map); строки
+// отдаются через QString::fromRawData без копирования, поэтому страницы
+// таблицы строк читаются с диска только когда строку реально показывают.
+// Слепок привязан к JSON по размеру, mtime и хэшу содержимого.
+//
+// Формат (little-endian): Header | Record[count] | TypeEntry[typeCount] |
+// quint32 rows[] (индексы записей по типам) | UTF-16 таблица строк.
+class StationSnapshot : public QObject {
+    Q_OBJECT
+public:
+    explicit StationSnapshot(QObject* parent = nullptr);
+    ~StationSnapshot() override;
+
+    bool open(const QString& path, const QString& jsonPath);
+    bool isOpen() const { return m_data != nullptr; }
+
+    int     count() const;
+    quint64 nextId() const;
+
+    // volumes — актуальные громкости по StationManager::urlHash; для станций
+    // без записи берётся значение, сохранённое в слепке
+    QVector<Station> stations(const QHash<quint64, int>& volumes) const;
+    QHash<QString, QVector<quint64>> idsByType() const;
+
+    // nextId — счётчик менеджера: он не откатывается, даже если станции
+    // с наибольшими id удалены
+    static bool write(const QString& path, const QString& jsonPath, const QVector<Station>& stations,
+                      quint64 nextId);
+    static quint64 hashBytes(const QByteArray& bytes);
+
+private:
+    void close();
+    QString stringAt(quint32 offset, quint32 length) const;
+
+    QFile        m_file;
+    const uchar* m_data = nullptr;
+    qint64       m_size = 0;
+};
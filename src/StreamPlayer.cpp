@@ -0,0 +1,596 @@
+#include "StreamPlayer.h"
+#include "IcyReader.h"
+#include "HlsReader.h"
+#include "TimeShiftBuffer.h"
+#include "StreamRecorder.h"
+#include "AppSettings.h"
+#include <QAudioDecoder>
+#include <QAudioDevice>
+#include <QAudioSink>
+#include <QMediaDevices>
+#include <QThread>
+#include <QTimer>
+#include <QDebug>
+#include <climits>
+#include <limits>
+#include <cstring>
+
+namespace {
+    const qint64 kInitialStoreBytes = 1024 * 1024;
+    const int    kHoldMarginMs = 2000;  // кольцо PCM — максимум буфера + 5 с
+    const int    kStableMs = 10000;     // столько отыграло зеркало — счётчик переходов сначала
+}
+
+// PcmSource — вход QAudioSink в режиме pull. Читается из потока звука,
+// поэтому берёт данные из кольца без блокировок; нехватку дополняет
+// тишиной и поднимает флаг провала для StreamPlayer::tick()
+class PcmSource : public QIODevice {
+public:
+    PcmSource(PcmRingBuffer* ring, std::atomic<bool>* underrun, QObject* parent)
+        : QIODevice(parent), m_ring(ring), m_underrun(underrun) {}
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override { return m_ring->available() + QIODevice::bytesAvailable(); }
+
+protected:
+    qint64 readData(char* data, qint64 maxlen) override
+    {
+        const qint64 n = m_ring->read(data, maxlen);
+        if (n < maxlen) {
+            std::memset(data + n, 0, size_t(maxlen - n));
+            m_underrun->store(true, std::memory_order_relaxed);
+        }
+        return maxlen;
+    }
+    qint64 writeData(const char*, qint64) override { return -1; }
+
+private:
+    PcmRingBuffer*     m_ring;
+    std::atomic<bool>* m_underrun;
+};
+
+StreamPlayer::StreamPlayer(QObject* parent)
+    : AbstractPlayer(parent)
+    , m_reader(new IcyReader)
+    , m_hls(new HlsReader)
+    , m_netThread(new QThread(this))
+    , m_recorder(new StreamRecorder)
+    , m_ioThread(new QThread(this))
+    , m_tick(new QTimer(this))
+    , m_pcm(new PcmSource(&m_ring, &m_underrun, this))
+{
+    const AppSettings *settings = AppSettings::instance();
+    m_volume = settings->volume();
+    m_minMs  = qMax(50, settings->radioBufferMinMs());
+    m_maxMs  = qMax(m_minMs, settings->radioBufferMaxMs());
+    m_targetMs = m_jitterTargetMs = m_minMs;
+    m_windowSecs = qMax(0, settings->radioTimeShiftMinutes()) * 60;
+
+    // Кольцо выделяется один раз: максимум буфера плюс запас на стартовый
+    // «залп» сервера, который декодируется быстрее реального времени
+    m_format = QMediaDevices::defaultAudioOutput().preferredFormat();
+    if (m_format.sampleFormat() == QAudioFormat::UInt8)
+        m_format.setSampleFormat(QAudioFormat::Int16);  // тишина = нулевые байты
+    m_ring.reset(m_format.bytesForDuration(qint64(qMax(m_maxMs, 10000) + 5000) * 1000));
+
+    // HLS отдаёт сегменты с опережением на полный буфер плюс порцию —
+    // иначе после провала кольцо не наберёт целевую глубину
+    m_hls->setMaxParallel(settings->radioHlsParallel());
+    m_hls->setLeadMs(m_maxMs + 1000);
+
+    m_netThread->setObjectName(QStringLiteral("IcyReader"));
+    m_reader->moveToThread(m_netThread);
+    m_hls->moveToThread(m_netThread);
+    connect(m_netThread, &QThread::finished, m_reader, &QObject::deleteLater);
+    connect(m_netThread, &QThread::finished, m_hls, &QObject::deleteLater);
+    m_netThread->start();
+
+    connect(m_reader, &IcyReader::connected, this, &StreamPlayer::onReaderConnected);
+    connect(m_reader, &IcyReader::jitterMeasured, this, &StreamPlayer::onJitter);
+    connect(m_reader, &IcyReader::metadata, this, [this](int session, const QString& title, qint64 pos) {
+        if (session != m_session) return;
+        qDebug() << "[StreamPlayer] Now playing:" << title;
+        if (m_recording) {
+            StreamRecorder *recorder = m_recorder;
+            QMetaObject::invokeMethod(recorder, [recorder, pos, title]() {
+                recorder->split(pos, title);
+            }, Qt::QueuedConnection);
+        }
+        emit nowPlayingChanged(title);
+    });
+    connect(m_reader, &IcyReader::candidateChosen, this, [this](int session, int offset) {
+        if (session != m_session || m_candidates.isEmpty()) return;
+        m_candidateIndex = (m_candidateIndex + offset) % m_candidates.size();
+        m_source = QUrl(m_candidates.at(m_candidateIndex));
+    });
+    connect(m_reader, &IcyReader::failed,   this, &StreamPlayer::onReaderFailed);
+    connect(m_reader, &IcyReader::finished, this, &StreamPlayer::onReaderFinished);
+    connect(m_hls, &HlsReader::connected, this, &StreamPlayer::onReaderConnected);
+    connect(m_hls, &HlsReader::failed,    this, &StreamPlayer::onReaderFailed);
+    connect(m_hls, &HlsReader::finished,  this, &StreamPlayer::onReaderFinished);
+
+    m_ioThread->setObjectName(QStringLiteral("StreamRecorder"));
+    m_recorder->moveToThread(m_ioThread);
+    connect(m_ioThread, &QThread::finished, m_recorder, &QObject::deleteLater);
+    m_ioThread->start(QThread::LowPriority);
+    connect(m_recorder, &StreamRecorder::fileStarted, this, [](const QString& path) {
+        qDebug() << "[StreamPlayer] Recording to" << path;
+    });
+    connect(m_recorder, &StreamRecorder::failed, this, [this](const QString& error) {
+        qWarning() << "[StreamPlayer] Recording stopped:" << error;
+        if (!m_recording) return;
+        m_recording = false;
+        emit recordingChanged(false);
+    });
+
+    m_tick->setInterval(100);
+    connect(m_tick, &QTimer::timeout, this, &StreamPlayer::tick);
+}
+
+StreamPlayer::~StreamPlayer()
+{
+    teardown();
+    m_netThread->quit();
+    m_netThread->wait();
+    // Рекордер дописывает остаток до выхода из его потока
+    StreamRecorder *recorder = m_recorder;
+    QMetaObject::invokeMethod(recorder, [recorder]() { recorder->stop(); }, Qt::BlockingQueuedConnection);
+    m_ioThread->quit();
+    m_ioThread->wait();
+}
+
+void StreamPlayer::play(const QString& url)
+{
+    playCandidates(QStringList{ url });
+}
+
+void StreamPlayer::playCandidates(const QStringList& urls)
+{
+    if (urls.isEmpty())
+        return;
+    stopRecording();  // запись — только своей станции
+    m_candidates = urls;
+    m_candidateIndex = 0;
+    m_failovers = 0;
+    startSession();
+}
+
+void StreamPlayer::startSession()
+{
+    const QString contentType = m_contentType;
+    teardown();
+
+    m_source = QUrl(m_candidates.at(m_candidateIndex));
+    m_connectedClock.invalidate();
+    ++m_session;
+    m_underrunFloorMs = 0;
+    m_byteRate = 0;
+    m_contentType.clear();
+
+    // Окно растёт до битрейт × минуты, когда сервер сообщит битрейт
+    m_store.reset(new TimeShiftBuffer(kInitialStoreBytes));
+    startDecoder(0, false);
+    // Зеркало той же станции в другом формате (см. onReaderConnected):
+    // запись продолжается новым файлом
+    if (m_recording)
+        attachRecorder(contentType);
+    startReader();
+
+    m_state = State::Buffering;
+    m_tick->start();
+    emit nowPlayingChanged(QString());
+    announceFeatures(true);
+    emit playbackStateChanged(true);
+}
+
+void StreamPlayer::startReader()
+{
+    const int session = m_session;
+    const QUrl source = m_source;
+    const QSharedPointer<TimeShiftBuffer> store = m_store;
+    IcyReader *reader = m_reader;
+    HlsReader *hls = m_hls;
+    if (HlsReader::isHlsUrl(source)) {
+        QMetaObject::invokeMethod(hls, [reader, hls, session, source, store]() {
+            reader->stop();  // при переходе с зеркала другого вида
+            hls->start(session, source, store);
+        }, Qt::QueuedConnection);
+    } else {
+        // Гонка начинается с текущего зеркала, остальные — следом по кругу
+        QList<QUrl> urls;
+        for (int i = 0; i < m_candidates.size(); ++i)
+            urls << QUrl(m_candidates.at((m_candidateIndex + i) % m_candidates.size()));
+        QMetaObject::invokeMethod(reader, [reader, hls, session, urls, store]() {
+            hls->stop();
+            reader->start(session, urls, store);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void StreamPlayer::startDecoder(qint64 pos, bool startNow)
+{
+    m_ring.clear();  // потребитель остановлен в stopDecoder()/teardown()
+    m_underrun.store(false);
+
+    m_decoder = new QAudioDecoder(this);
+    // Курсор — дочерний объект декодера: его поток может читать до самого
+    // удаления декодера (deleteLater в stopDecoder)
+    m_feed = new StreamFeed(m_store, pos);
+    m_feed->setParent(m_decoder);
+    m_decoder->setAudioFormat(m_format);
+    m_decoder->setSourceDevice(m_feed);
+    connect(m_decoder, &QAudioDecoder::bufferReady, this, &StreamPlayer::onBufferReady);
+    connect(m_decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), this, [this](QAudioDecoder::Error) {
+        const QString error = m_decoder->errorString();
+        qWarning() << "[StreamPlayer] Decoder error:" << error;
+        stopRecording();
+        teardown();
+        emit errorOccurred(error);
+        announceFeatures(false);
+        emit playbackStateChanged(false);
+    });
+    connect(m_decoder, &QAudioDecoder::finished, this, [this]() {
+        qDebug() << "[StreamPlayer] Decoder finished";
+        stopRecording();
+        teardown();
+        announceFeatures(false);
+        emit playbackStateChanged(false);
+    });
+
+    // Формат декодер определяет по данным: в эфире стартуем по подключению,
+    // при перемотке данные уже есть
+    m_decoderStarted = startNow;
+    if (startNow)
+        m_decoder->start();
+}
+
+void StreamPlayer::stopDecoder()
+{
+    if (m_sink) {
+        m_sink->stop();
+        m_sink->deleteLater();
+        m_sink = nullptr;
+    }
+    m_pcm->close();
+
+    // Сначала будим декодер, который может ждать данных в StreamFeed
+    if (m_feed)
+        m_feed->cancel();
+    if (m_decoder) {
+        m_decoder->disconnect(this);
+        m_decoder->stop();
+        m_decoder->deleteLater();  // вместе с курсором
+        m_decoder = nullptr;
+    }
+    m_feed = nullptr;
+}
+
+void StreamPlayer::teardown()
+{
+    m_tick->stop();
+    // Запись не трогаем: рекордер дочитает старое окно, а продолжить её
+    // на новом или закончить решает вызывающий
+    stopDecoder();
+
+    if (m_store)
+        m_store->finish();
+    IcyReader *reader = m_reader;
+    HlsReader *hls = m_hls;
+    QMetaObject::invokeMethod(reader, [reader, hls]() {
+        reader->stop();
+        hls->stop();
+    }, Qt::QueuedConnection);
+    m_store.reset();
+    m_state = State::Stopped;
+}
+
+void StreamPlayer::stop()
+{
+    stopRecording();
+    teardown();
+    announceFeatures(false);
+    emit playbackStateChanged(false);
+}
+
+void StreamPlayer::togglePlayback()
+{
+    if (m_state == State::Paused) {
+        // Продолжаем с места паузы: сеть всё это время писала в окно
+        m_state = m_sink ? State::Playing : State::Buffering;
+        if (m_sink)
+            m_sink->resume();
+        updateHold();
+        emit playbackStateChanged(true);
+    } else if (m_state != State::Stopped && m_windowSecs > 0) {
+        if (m_sink)
+            m_sink->suspend();
+        m_state = State::Paused;
+        updateHold();
+        emit playbackStateChanged(false);
+    } else if (m_state != State::Stopped) {
+        // Без окна пауза живого эфира не копит отставание: переподключаемся заново
+        stop();
+    } else if (!m_candidates.isEmpty()) {
+        m_failovers = 0;
+        startSession();  // с того зеркала, что играло последним
+    }
+}
+
+bool StreamPlayer::supportsFeature(const QString& feature) const
+{
+    if (feature == QLatin1String("timeshift"))
+        return m_windowSecs > 0;
+    return feature == QLatin1String("record");
+}
+
+void StreamPlayer::announceFeatures(bool active)
+{
+    emit featureChanged(QStringLiteral("timeshift"), active && m_windowSecs > 0);
+    emit featureChanged(QStringLiteral("record"), active);
+}
+
+bool StreamPlayer::startRecording(const QString& dir, const QString& label)
+{
+    if (!m_store || m_recording)
+        return false;
+    m_recordDir = dir;
+    m_recordLabel = label;
+    attachRecorder(m_contentType);
+    m_recording = true;
+    emit recordingChanged(true);
+    return true;
+}
+
+void StreamPlayer::attachRecorder(const QString& contentType)
+{
+    // start() сам закрывает прежний файл, дочитав его окно
+    StreamRecorder *recorder = m_recorder;
+    const QSharedPointer<TimeShiftBuffer> store = m_store;
+    const QString dir = m_recordDir;
+    const QString label = m_recordLabel;
+    const int splitMinutes = AppSettings::instance()->radioRecordSplitMinutes();
+    QMetaObject::invokeMethod(recorder, [=]() {
+        recorder->start(store, dir, label, contentType, splitMinutes);
+    }, Qt::QueuedConnection);
+}
+
+void StreamPlayer::stopRecording()
+{
+    if (!m_recording)
+        return;
+    StreamRecorder *recorder = m_recorder;
+    QMetaObject::invokeMethod(recorder, [recorder]() { recorder->stop(); }, Qt::QueuedConnection);
+    m_recording = false;
+    emit recordingChanged(false);
+}
+
+qint64 StreamPlayer::byteRate() const
+{
+    // Битрейт не заявлен — считаем типичные 128 кбит/с
+    return m_byteRate > 0 ? m_byteRate : 128 * 125;
+}
+
+int StreamPlayer::liveDelayMs() const
+{
+    if (!m_store || !m_feed)
+        return 0;
+    // Позиция звучания — курсор декодера минус то, что уже лежит в кольце
+    const qint64 played = m_feed->position() - qint64(bufferedMs()) * byteRate() / 1000;
+    return int(qMax<qint64>(0, m_store->endPos() - played) * 1000 / byteRate());
+}
+
+void StreamPlayer::shiftBy(int deltaMs)
+{
+    if (!m_store || m_windowSecs <= 0 || m_state == State::Stopped)
+        return;
+    const qint64 live = m_store->endPos();
+    const qint64 played = m_feed->position() - qint64(bufferedMs()) * byteRate() / 1000;
+    const qint64 target = played + qint64(deltaMs) * byteRate() / 1000;
+    // Вплотную к краю стартовать нельзя — запас минимального буфера
+    const qint64 edge = qMax(m_store->startPos(), live - qint64(m_minMs) * byteRate() / 1000);
+    seekTo(qBound(m_store->startPos(), target, edge));
+}
+
+void StreamPlayer::goLive()
+{
+    shiftBy(std::numeric_limits<int>::max());
+}
+
+void StreamPlayer::seekTo(qint64 pos)
+{
+    const bool paused = m_state == State::Paused;
+    stopDecoder();
+    startDecoder(pos, true);
+    m_state = paused ? State::Paused : State::Buffering;
+    updateHold();
+    qDebug() << "[StreamPlayer] Time shift:" << liveDelayMs() << "ms behind live";
+}
+
+void StreamPlayer::updateHold()
+{
+    // Подпор: декодер не убегает вперёд кольца PCM (за эфиром данных
+    // в окне много, декодирует он быстрее реального времени)
+    if (m_feed)
+        m_feed->setHeld(m_state == State::Paused || bufferedMs() >= m_maxMs + kHoldMarginMs);
+}
+
+void StreamPlayer::onBufferReady()
+{
+    while (m_decoder && m_decoder->bufferAvailable()) {
+        const QAudioBuffer buffer = m_decoder->read();
+        if (!buffer.isValid())
+            continue;
+        const qint64 written = m_ring.write(buffer.constData<char>(), buffer.byteCount());
+        if (written < buffer.byteCount())
+            qWarning() << "[StreamPlayer] PCM ring full, dropped" << bytesToMs(buffer.byteCount() - written) << "ms";
+    }
+    updateHold();
+
+    // Первый кадр сразу в звук; после провала — по набору целевой глубины
+    if (m_state == State::Buffering && bufferedMs() >= (m_sink ? m_targetMs : 0))
+        startSink();
+}
+
+void StreamPlayer::startSink()
+{
+    if (!m_sink) {
+        m_sink = new QAudioSink(QMediaDevices::defaultAudioOutput(), m_format, this);
+        // Буфер устройства короткий: глубину задержки держит кольцо
+        m_sink->setBufferSize(m_format.bytesForDuration(100 * 1000));
+        applyVolume();
+        m_pcm->open(QIODevice::ReadOnly);
+        m_sink->start(m_pcm);
+    } else {
+        m_sink->resume();
+    }
+    m_underrun.store(false);
+    m_state = State::Playing;
+    qDebug() << "[StreamPlayer] Audio started with" << bufferedMs() << "ms buffered, target" << m_targetMs;
+}
+
+void StreamPlayer::onReaderConnected(int session, const QString& contentType, int kbps)
+{
+    if (session != m_session)
+        return;
+    qDebug() << "[StreamPlayer] Connected:" << contentType << kbps << "kbps";
+    const QString previous = m_contentType;
+    m_contentType = contentType;
+    if (!previous.isEmpty() && previous.section(';', 0, 0).trimmed().compare(
+            contentType.section(';', 0, 0).trimmed(), Qt::CaseInsensitive) != 0) {
+        // Зеркало в другом формате: склейку декодер не разберёт — сессия
+        // заново с этого зеркала, окно теряется
+        qWarning() << "[StreamPlayer] Mirror format differs:" << previous << "->" << contentType;
+        startSession();
+        return;
+    }
+    m_connectedClock.start();
+    if (kbps > 0)
+        m_byteRate = kbps * 125;
+    if (m_windowSecs > 0 && m_store)
+        m_store->setCapacity(qMax(kInitialStoreBytes, byteRate() * m_windowSecs));
+    if (!m_decoderStarted && m_decoder) {
+        m_decoderStarted = true;
+        m_decoder->start();
+    }
+}
+
+bool StreamPlayer::failover(const QString& reason)
+{
+    if (m_candidates.size() < 2)
+        return false;
+    // IcyReader до подключения сам перебрал все адреса — круг пройден
+    if (!m_connectedClock.isValid() && !HlsReader::isHlsUrl(m_source))
+        return false;
+    if (m_connectedClock.isValid() && m_connectedClock.elapsed() >= kStableMs)
+        m_failovers = 0;
+    if (m_failovers >= m_candidates.size() - 1)
+        return false;
+
+    ++m_failovers;
+    m_candidateIndex = (m_candidateIndex + 1) % m_candidates.size();
+    qWarning() << "[StreamPlayer] Failing over to mirror" << m_candidates.at(m_candidateIndex) << "-" << reason;
+    // Окно, декодер и запись остаются: новое зеркало дописывает в то же
+    // окно с края эфира, позиция слушателя не сдвигается
+    m_source = QUrl(m_candidates.at(m_candidateIndex));
+    m_connectedClock.invalidate();
+    ++m_session;
+    startReader();
+    return true;
+}
+
+void StreamPlayer::onReaderFailed(int session, const QString& error)
+{
+    if (session != m_session) return;
+    if (failover(error))
+        return;
+    stopRecording();
+    teardown();
+    emit errorOccurred(error);
+    announceFeatures(false);
+    emit playbackStateChanged(false);
+}
+
+void StreamPlayer::onReaderFinished(int session)
+{
+    if (session != m_session) return;
+    qDebug() << "[StreamPlayer] Stream ended by server";
+    // Живой эфир сам не кончается; HLS с ENDLIST — законный конец, окно
+    // HlsReader закрыл сам
+    if (HlsReader::isHlsUrl(m_source))
+        return;
+    // Зеркал не осталось — декодер доиграет окно и закончит
+    if (!failover(QStringLiteral("stream ended")) && m_store)
+        m_store->finish();
+}
+
+void StreamPlayer::onJitter(int session, int jitterMs)
+{
+    if (session != m_session)
+        return;
+    // Запас в несколько джиттеров покрывает почти все задержки порций
+    m_jitterTargetMs = m_minMs + 4 * jitterMs;
+    updateTarget();
+}
+
+void StreamPlayer::updateTarget()
+{
+    m_targetMs = qBound(m_minMs, qMax(m_jitterTargetMs, m_underrunFloorMs), m_maxMs);
+}
+
+void StreamPlayer::tick()
+{
+    if (m_state == State::Playing && m_underrun.exchange(false)) {
+        // Кольцо опустело: глушим выход и копим глубину заново, с запасом
+        m_underrunFloorMs = qMin(m_maxMs, m_targetMs * 3 / 2);
+        m_sinceUnderrun.restart();
+        updateTarget();
+        m_sink->suspend();
+        m_state = State::Buffering;
+        qDebug() << "[StreamPlayer] Underrun, rebuffering to" << m_targetMs << "ms";
+    }
+
+    // Пол после провала сходит на нет, пока сеть стабильна
+    if (m_underrunFloorMs > 0 && m_sinceUnderrun.elapsed() > 10000) {
+        m_underrunFloorMs = m_underrunFloorMs * 9 / 10;
+        if (m_underrunFloorMs < m_minMs)
+            m_underrunFloorMs = 0;
+        m_sinceUnderrun.restart();
+        updateTarget();
+    }
+
+    if (m_state == State::Buffering && m_sink && bufferedMs() >= m_targetMs)
+        startSink();
+    updateHold();
+}
+
+int StreamPlayer::bufferedMs() const
+{
+    return bytesToMs(m_ring.available());
+}
+
+int StreamPlayer::bytesToMs(qint64 bytes) const
+{
+    return int(m_format.durationForBytes(qint32(qMin<qint64>(bytes, INT_MAX))) / 1000);
+}
+
+void StreamPlayer::applyVolume()
+{
+    if (m_sink)
+        m_sink->setVolume(m_muted ? 0.0 : m_volume / 100.0);
+}
+
+void StreamPlayer::setVolume(int value)
+{
+    if (m_volume == value)
+        return;
+    m_volume = value;
+    applyVolume();
+    emit volumeChanged(value);
+}
+
+void StreamPlayer::setMuted(bool muted)
+{
+    m_muted = muted;
+    applyVolume();
+    emit mutedChanged(muted);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "../include/AbstractPlayer.h"
+#include "PcmRingBuffer.h"
+#include <QAudioFormat>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QUrl>
+#include <atomic>
+
+class IcyReader;
+class StreamRecorder;
+class HlsReader;
+class StreamFeed;
+class TimeShiftBuffer;
+class PcmSource;
+class QAudioDecoder;
+class QAudioSink;
+class QThread;
+class QTimer;
+
+// StreamPlayer — собственный конвейер радио вместо QMediaPlayer:
+// IcyReader (сеть, рабочий поток) -> QAudioDecoder (MP3/AAC/Opus/Vorbis)
+// -> PcmRingBuffer -> QAudioSink. Звук стартует с первого декодированного
+// кадра; после провала буфера — когда набрана целевая глубина, которая
+// подстраивается под измеренный джиттер сети (radio/bufferMinMs..MaxMs).
+// Включается настройкой radio/backend = "native"; HLS (.m3u8) вместо
+// IcyReader читает HlsReader, и SwitchPlayer шлёт его сюда при любом движке.
+// Сеть пишет в TimeShiftBuffer (окно radio/timeShiftMinutes), декодер читает
+// его своим курсором: пауза лишь останавливает курсор, перемотка и возврат
+// в эфир перезапускают декодер с другой позиции — без переподключения.
+// Зеркала станции (playCandidates) IcyReader подключает наперегонки; обрыв
+// посреди эфира переводит на следующее зеркало по кругу. Переход сохраняет
+// окно, позицию слушателя и запись: новое зеркало дописывает в тот же
+// TimeShiftBuffer (на стыке — скачок эфира на разницу задержек зеркал).
+class StreamPlayer : public AbstractPlayer {
+    Q_OBJECT
+public:
+    explicit StreamPlayer(QObject* parent = nullptr);
+    ~StreamPlayer() override;
+
+    void play(const QString& url) override;
+    void playCandidates(const QStringList& urls) override;
+    void stop() override;
+    void togglePlayback() override;
+    bool supportsFeature(const QString& feature) const override;
+    void shiftBy(int deltaMs) override;
+    void goLive() override;
+    bool startRecording(const QString& dir, const QString& label) override;
+    void stopRecording() override;
+    bool isRecording() const override { return m_recording; }
+
+    void setVolume(int value) override;
+    int volume() const override { return m_volume; }
+    void setMuted(bool muted) override;
+    bool isMuted() const override { return m_muted; }
+
+    int bufferedMs() const;
+    int targetBufferMs() const { return m_targetMs; }
+    int liveDelayMs() const;  // отставание от эфира
+
+private:
+    enum class State { Stopped, Buffering, Playing, Paused };
+
+    void startSession();
+    void startReader();
+    bool failover(const QString& reason);
+    void teardown();
+    void startDecoder(qint64 pos, bool startNow);
+    void stopDecoder();
+    void seekTo(qint64 pos);
+    void announceFeatures(bool active);
+    void attachRecorder(const QString& contentType);
+    void updateHold();
+    qint64 byteRate() const;
+    void onBufferReady();
+    void onJitter(int session, int jitterMs);
+    void onReaderConnected(int session, const QString& contentType, int kbps);
+    void onReaderFailed(int session, const QString& error);
+    void onReaderFinished(int session);
+    void tick();
+    void startSink();
+    void updateTarget();
+    void applyVolume();
+    int  bytesToMs(qint64 bytes) const;
+
+    IcyReader*     m_reader;
+    HlsReader*     m_hls;
+    QThread*       m_netThread;
+    StreamRecorder* m_recorder;
+    QThread*       m_ioThread;       // запись на диск — отдельно от сети
+    QTimer*        m_tick;
+    QAudioDecoder* m_decoder = nullptr;
+    QAudioSink*    m_sink = nullptr;
+    PcmSource*     m_pcm;
+    StreamFeed*    m_feed = nullptr; // дочерний объект m_decoder
+    QSharedPointer<TimeShiftBuffer> m_store;
+
+    QAudioFormat   m_format;
+    PcmRingBuffer  m_ring;
+    QUrl           m_source;
+    QStringList    m_candidates;     // адреса станции; m_source — один из них
+    int            m_candidateIndex = 0;
+    int            m_failovers = 0;  // переходов подряд без устойчивой игры
+    QElapsedTimer  m_connectedClock;
+    State          m_state = State::Stopped;
+    int            m_session = 0;
+    bool           m_decoderStarted = false;
+    int            m_windowSecs;
+    int            m_byteRate = 0;   // байт/с из заявленного битрейта
+    QString        m_contentType;
+    bool           m_recording = false;
+    QString        m_recordDir;      // переживают перезапуск сессии той же станции
+    QString        m_recordLabel;
+
+    // Глубина буфера: джиттер задаёт базу, провалы временно поднимают пол
+    int            m_minMs;
+    int            m_maxMs;
+    int            m_targetMs;
+    int            m_jitterTargetMs;
+    int            m_underrunFloorMs = 0;
+    QElapsedTimer  m_sinceUnderrun;
+    std::atomic<bool> m_underrun{false};
+
+    int            m_volume;
+    bool           m_muted = false;
+};
@@ -0,0 +1,185 @@
+#include "StreamRecorder.h"
+#include "TimeShiftBuffer.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+    const int kDrainIntervalMs = 1000;
+    const int kBatchSize = 512 * 1024;
+
+    // Расширение по сигнатуре первых байт, если сервер не назвал тип
+    QString sniffExtension(const char* head, qint64 len)
+    {
+        const QByteArray b = QByteArray::fromRawData(head, qsizetype(qMin<qint64>(len, 4)));
+        if (b.startsWith("ID3"))  return QStringLiteral("mp3");
+        if (b.startsWith("OggS")) return QStringLiteral("ogg");
+        if (b.startsWith("fLaC")) return QStringLiteral("flac");
+        if (b.size() >= 2 && uchar(b[0]) == 0xFF && (uchar(b[1]) & 0xF6) == 0xF0)
+            return QStringLiteral("aac");  // ADTS
+        if (b.size() >= 2 && uchar(b[0]) == 0xFF && (uchar(b[1]) & 0xE0) == 0xE0)
+            return QStringLiteral("mp3");
+        if (b.size() >= 1 && uchar(b[0]) == 0x47)
+            return QStringLiteral("ts");   // HLS, MPEG-TS
+        return QString();
+    }
+
+    QString extensionForType(const QString& contentType)
+    {
+        const QString t = contentType.toLower();
+        if (t.contains(QLatin1String("aac")))   return QStringLiteral("aac");
+        if (t.contains(QLatin1String("ogg")))   return QStringLiteral("ogg");
+        if (t.contains(QLatin1String("flac")))  return QStringLiteral("flac");
+        if (t.contains(QLatin1String("mp2t")))  return QStringLiteral("ts");
+        if (t.contains(QLatin1String("mpeg")))  return QStringLiteral("mp3");
+        return QString();
+    }
+}
+
+StreamRecorder::StreamRecorder(QObject* parent)
+    : QObject(parent)
+{
+}
+
+StreamRecorder::~StreamRecorder()
+{
+    closeFile();
+}
+
+void StreamRecorder::start(QSharedPointer<TimeShiftBuffer> store, const QString& dir,
+                           const QString& label, const QString& contentType, int splitMinutes)
+{
+    stop();
+    if (!m_timer) {
+        m_timer = new QTimer(this);
+        m_timer->setInterval(kDrainIntervalMs);
+        connect(m_timer, &QTimer::timeout, this, &StreamRecorder::drain);
+        m_batch = QByteArray(kBatchSize, Qt::Uninitialized);
+    }
+    if (!QDir().mkpath(dir)) {
+        emit failed(tr("Не удалось создать папку записи: %1").arg(dir));
+        return;
+    }
+
+    m_store = store;
+    m_pos = store->endPos();  // пишем с текущего края эфира
+    m_dir = dir;
+    m_label = label;
+    m_title.clear();
+    m_ext = extensionForType(contentType);
+    m_part = 1;
+    m_splitMs = qint64(qMax(0, splitMinutes)) * 60 * 1000;
+    m_timer->start();
+    qDebug() << "[StreamRecorder] Recording to" << dir;
+}
+
+void StreamRecorder::stop()
+{
+    if (m_store)
+        drain();
+    if (m_timer)
+        m_timer->stop();
+    closeFile();
+    m_store.reset();
+    m_splits.clear();
+}
+
+void StreamRecorder::split(qint64 pos, const QString& title)
+{
+    if (!m_store)
+        return;
+    m_splits.append({ pos, title });
+}
+
+void StreamRecorder::drain()
+{
+    while (m_store) {
+        // До ближайшей границы трека — чтобы резать точно по ней
+        qint64 limit = kBatchSize;
+        if (!m_splits.isEmpty())
+            limit = qMin(limit, qMax<qint64>(0, m_splits.first().pos - m_pos));
+
+        const qint64 n = limit > 0 ? m_store->readAvailable(&m_pos, m_batch.data(), limit) : 0;
+        if (n > 0 && !write(m_batch.constData(), n))
+            return;
+
+        if (!m_splits.isEmpty() && m_pos >= m_splits.first().pos) {
+            const Split next = m_splits.takeFirst();
+            closeFile();
+            m_title = next.title;
+            m_part = 1;
+            continue;
+        }
+        if (n < limit)
+            break;  // всё накопленное записано
+    }
+
+    // Лимит по времени: продолжение того же трека в новом файле
+    if (m_file && m_splitMs > 0 && m_fileClock.elapsed() >= m_splitMs) {
+        closeFile();
+        ++m_part;
+    }
+}
+
+bool StreamRecorder::write(const char* data, qint64 len)
+{
+    if (!m_file) {
+        const QString path = fileName(data, len);
+        m_file = new QFile(path);
+        if (!m_file->open(QIODevice::WriteOnly)) {
+            const QString error = m_file->errorString();
+            delete m_file;
+            m_file = nullptr;
+            qWarning() << "[StreamRecorder] Cannot open" << path << error;
+            m_store.reset();  // без финального drain()
+            stop();
+            emit failed(error);
+            return false;
+        }
+        m_fileClock.start();
+        emit fileStarted(path);
+    }
+
+    // Одна запись на порцию: заметных задержек на диске эфир не ждёт
+    if (m_file->write(data, len) != len || !m_file->flush()) {
+        const QString error = m_file->errorString();
+        qWarning() << "[StreamRecorder] Write failed:" << error;
+        m_store.reset();
+        stop();
+        emit failed(error);
+        return false;
+    }
+    return true;
+}
+
+void StreamRecorder::closeFile()
+{
+    if (!m_file)
+        return;
+    m_file->close();
+    delete m_file;
+    m_file = nullptr;
+}
+
+QString StreamRecorder::fileName(const char* head, qint64 len)
+{
+    // Тип не назван сервером — по сигнатуре (в середине потока может не найтись)
+    if (m_ext.isEmpty())
+        m_ext = sniffExtension(head, len);
+    const QString ext = m_ext.isEmpty() ? QStringLiteral("mp3") : m_ext;
+
+    QString name = QDateTime::currentDateTime().toString(QStringLiteral("yyyy-MM-dd HH-mm-ss"));
+    if (!m_label.isEmpty())
+        name += QStringLiteral(" ") + m_label;
+    if (!m_title.isEmpty())
+        name += QStringLiteral(" - ") + m_title;
+    if (m_part > 1)
+        name += QStringLiteral(" (%1)").arg(m_part);
+
+    static const QRegularExpression forbidden(QStringLiteral("[\\\\/:*?\"<>|\\x00-\\x1F]"));
+    name.replace(forbidden, QStringLiteral("_"));
+    return QDir(m_dir).filePath(name.left(180) + QLatin1Char('.') + ext);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+
+class TimeShiftBuffer;
+class QFile;
+class QTimer;
+
+// StreamRecorder — запись эфира как есть (stream copy): сжатые байты из
+// TimeShiftBuffer своим курсором, без декодирования и перекодирования.
+// Живёт в отдельном потоке ввода-вывода; раз в секунду забирает всё
+// накопленное одной записью, поэтому диск не тормозит воспроизведение,
+// а нагрузка на процессор — копирование памяти. Файл режется по смене
+// ICY-заголовка (split() с точной позицией в потоке) или по лимиту времени.
+class StreamRecorder : public QObject {
+    Q_OBJECT
+public:
+    explicit StreamRecorder(QObject* parent = nullptr);
+    ~StreamRecorder() override;
+
+    // Вызываются в потоке рекордера (invokeMethod)
+    void start(QSharedPointer<TimeShiftBuffer> store, const QString& dir,
+               const QString& label, const QString& contentType, int splitMinutes);
+    void stop();
+    void split(qint64 pos, const QString& title);
+
+signals:
+    void fileStarted(const QString& path);
+    void failed(const QString& error);
+
+private:
+    struct Split {
+        qint64  pos;
+        QString title;
+    };
+
+    void drain();
+    bool write(const char* data, qint64 len);
+    void closeFile();
+    QString fileName(const char* head, qint64 len);
+
+    QTimer*  m_timer = nullptr;         // создаётся в потоке рекордера
+    QFile*   m_file = nullptr;
+    QSharedPointer<TimeShiftBuffer> m_store;
+    QByteArray     m_batch;             // порция чтения, выделена один раз
+    qint64         m_pos = 0;
+    QList<Split>   m_splits;
+    QString        m_dir;
+    QString        m_label;
+    QString        m_title;             // трек текущего/следующего файла
+    QString        m_ext;
+    int            m_part = 1;          // часть трека при резке по времени
+    qint64         m_splitMs = 0;
+    QElapsedTimer  m_fileClock;
+};
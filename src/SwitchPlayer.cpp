@@ -1,28 +1,40 @@
 #include "SwitchPlayer.h"
-#include "RadioPlayer.h"
 #include "YTPlayer.h"
+#include "HlsReader.h"
 #include <QRegularExpression>
 #include <QDebug>
 
-SwitchPlayer::SwitchPlayer(RadioPlayer* radio, YTPlayer* yt, QObject* parent)
-    : AbstractPlayer(parent), m_radio(radio), m_yt(yt)
+SwitchPlayer::SwitchPlayer(AbstractPlayer* radio, YTPlayer* yt, AbstractPlayer* hls, QObject* parent)
+    : AbstractPlayer(parent), m_radio(radio), m_yt(yt), m_hls(hls)
 {
+    attachChild(m_radio);
+    attachChild(m_yt);
+    attachChild(m_hls);
+}
+
+void SwitchPlayer::attachChild(AbstractPlayer* child)
+{
+    if (!child) return;
     // Сделать Qt-родителем, если необходимо — чтобы автоматическое удаление сработало
-    if (m_radio && m_radio->parent() == nullptr) m_radio->setParent(this);
-    if (m_yt    && m_yt->parent()    == nullptr) m_yt->setParent(this);
+    if (child->parent() == nullptr) child->setParent(this);
 
     // Проксирование сигналов от детей наружу
-    if (m_radio) {
-        connect(m_radio, &AbstractPlayer::playbackStateChanged, this, &SwitchPlayer::onChildPlaybackStateChanged);
-        connect(m_radio, &AbstractPlayer::volumeChanged,        this, &SwitchPlayer::onChildVolumeChanged);
-        connect(m_radio, &AbstractPlayer::mutedChanged,         this, &SwitchPlayer::onChildMutedChanged);
-        connect(m_radio, &AbstractPlayer::errorOccurred,        this, &SwitchPlayer::onChildError);
-    }
-    if (m_yt) {
-        connect(m_yt, &AbstractPlayer::playbackStateChanged, this, &SwitchPlayer::onChildPlaybackStateChanged);
-        connect(m_yt, &AbstractPlayer::volumeChanged,        this, &SwitchPlayer::onChildVolumeChanged);
-        connect(m_yt, &AbstractPlayer::mutedChanged,         this, &SwitchPlayer::onChildMutedChanged);
-        connect(m_yt, &AbstractPlayer::errorOccurred,        this, &SwitchPlayer::onChildError);
+    connect(child, &AbstractPlayer::playbackStateChanged, this, &SwitchPlayer::onChildPlaybackStateChanged);
+    connect(child, &AbstractPlayer::volumeChanged,        this, &SwitchPlayer::onChildVolumeChanged);
+    connect(child, &AbstractPlayer::mutedChanged,         this, &SwitchPlayer::onChildMutedChanged);
+    connect(child, &AbstractPlayer::errorOccurred,        this, &SwitchPlayer::onChildError);
+    connect(child, &AbstractPlayer::nowPlayingChanged,    this, &AbstractPlayer::nowPlayingChanged);
+    connect(child, &AbstractPlayer::featureChanged,       this, &AbstractPlayer::featureChanged);
+    connect(child, &AbstractPlayer::recordingChanged,     this, &AbstractPlayer::recordingChanged);
+}
+
+AbstractPlayer* SwitchPlayer::current() const
+{
+    switch (m_currentSource) {
+    case Source::Radio:   return m_radio;
+    case Source::YouTube: return m_yt;
+    case Source::Hls:     return m_hls;
+    default:              return nullptr;
     }
 }
 
@@ -35,10 +47,25 @@ bool SwitchPlayer::looksLikeYouTube(const QString& url) const
     return rx.match(url).hasMatch();
 }
 
+bool SwitchPlayer::routesToHls(const QString& url) const
+{
+    return m_hls && HlsReader::isHlsUrl(QUrl(url));
+}
+
 void SwitchPlayer::play(const QString& url)
 {
+    playCandidates(QStringList{ url });
+}
+
+void SwitchPlayer::playCandidates(const QStringList& urls)
+{
+    if (urls.isEmpty())
+        return;
+    // Движок выбирается по первому адресу: зеркала одной станции однотипны
+    const QString url = urls.first();
     if (looksLikeYouTube(url)) {
         if (m_radio) m_radio->stop();
+        if (m_hls)   m_hls->stop();
         if (m_yt) {
             m_currentSource = Source::YouTube;
             m_yt->play(url);
@@ -46,11 +73,18 @@ void SwitchPlayer::play(const QString& url)
         } else {
             emit errorOccurred("YouTube player not available");
         }
+    } else if (routesToHls(url)) {
+        if (m_radio) m_radio->stop();
+        if (m_yt)    m_yt->stop();
+        m_currentSource = Source::Hls;
+        m_hls->playCandidates(urls);
+        return;
     } else {
-        if (m_yt) m_yt->stop();
+        if (m_yt)  m_yt->stop();
+        if (m_hls) m_hls->stop();
         if (m_radio) {
             m_currentSource = Source::Radio;
-            m_radio->play(url);
+            m_radio->playCandidates(urls);
             return;
         } else {
             emit errorOccurred("Radio player not available");
@@ -62,6 +96,7 @@ void SwitchPlayer::stop()
 {
     if (m_radio) m_radio->stop();
     if (m_yt)    m_yt->stop();
+    if (m_hls)   m_hls->stop();
     m_currentSource = Source::None;
 }
 
@@ -69,6 +104,7 @@ void SwitchPlayer::togglePlayback()
 {
     if (m_currentSource == Source::YouTube && m_yt) m_yt->togglePlayback();
     else if (m_currentSource == Source::Radio && m_radio) m_radio->togglePlayback();
+    else if (m_currentSource == Source::Hls && m_hls) m_hls->togglePlayback();
     else if (m_radio) m_radio->togglePlayback(); // fallback
 }
 
@@ -76,6 +112,7 @@ void SwitchPlayer::setVolume(int value)
 {
     if (m_radio) m_radio->setVolume(value);
     if (m_yt)    m_yt->setVolume(value);
+    if (m_hls)   m_hls->setVolume(value);
     emit volumeChanged(value);
 }
 
@@ -90,6 +127,7 @@ void SwitchPlayer::setMuted(bool muted)
 {
     if (m_radio) m_radio->setMuted(muted);
     if (m_yt)    m_yt->setMuted(muted);
+    if (m_hls)   m_hls->setMuted(muted);
     emit mutedChanged(muted);
 }
 
@@ -100,6 +138,58 @@ bool SwitchPlayer::isMuted() const
     return false;
 }
 
+void SwitchPlayer::prepareNext(const QStringList& urls)
+{
+    // Радио подключается заранее, YouTube заранее разрешает ссылки
+    QStringList radioUrls;
+    QStringList ytUrls;
+    for (const QString& url : urls) {
+        if (looksLikeYouTube(url))
+            ytUrls << url;
+        else if (!routesToHls(url))
+            radioUrls << url;
+    }
+    if (m_radio) m_radio->prepareNext(radioUrls);
+    if (m_yt)    m_yt->prepareNext(ytUrls);
+}
+
+bool SwitchPlayer::supportsFeature(const QString& feature) const
+{
+    AbstractPlayer *child = current();
+    return child && child->supportsFeature(feature);
+}
+
+void SwitchPlayer::shiftBy(int deltaMs)
+{
+    if (AbstractPlayer *child = current())
+        child->shiftBy(deltaMs);
+}
+
+void SwitchPlayer::goLive()
+{
+    if (AbstractPlayer *child = current())
+        child->goLive();
+}
+
+bool SwitchPlayer::startRecording(const QString& dir, const QString& label)
+{
+    AbstractPlayer *child = current();
+    return child && child->startRecording(dir, label);
+}
+
+void SwitchPlayer::stopRecording()
+{
+    // Запись могла остаться у другого ребёнка — останавливаем везде
+    if (m_radio) m_radio->stopRecording();
+    if (m_hls)   m_hls->stopRecording();
+}
+
+bool SwitchPlayer::isRecording() const
+{
+    AbstractPlayer *child = current();
+    return child && child->isRecording();
+}
+
 void SwitchPlayer::onChildPlaybackStateChanged(bool playing) { emit playbackStateChanged(playing); }
 void SwitchPlayer::onChildVolumeChanged(int v)               { emit volumeChanged(v); }
 void SwitchPlayer::onChildMutedChanged(bool m)               { emit mutedChanged(m); }
@@ -1,26 +1,36 @@
 #pragma once
 #include "../include/AbstractPlayer.h"
 
-class RadioPlayer;
 class YTPlayer;
 
 // SwitchPlayer — прокси, который решает, куда посылать play()/stop().
 // Наследует AbstractPlayer, поэтому MainWindow ничего не меняет.
+// HLS (.m3u8) при заданном hls уходит в него (StreamPlayer), остальное радио —
+// в radio.
 class SwitchPlayer : public AbstractPlayer {
     Q_OBJECT
 public:
-    explicit SwitchPlayer(RadioPlayer* radio, YTPlayer* yt, QObject* parent = nullptr);
+    explicit SwitchPlayer(AbstractPlayer* radio, YTPlayer* yt,
+                          AbstractPlayer* hls = nullptr, QObject* parent = nullptr);
     ~SwitchPlayer() override;
     YTPlayer* getYTPlayer() const { return m_yt; }
 
 public slots:
     void play(const QString& url) override;
+    void playCandidates(const QStringList& urls) override;
     void stop() override;
     void togglePlayback() override;
     void setVolume(int value) override;
     int  volume() const override;
     void setMuted(bool muted) override;
     bool isMuted() const override;
+    void prepareNext(const QStringList& urls) override;
+    bool supportsFeature(const QString& feature) const override;
+    void shiftBy(int deltaMs) override;
+    void goLive() override;
+    bool startRecording(const QString& dir, const QString& label) override;
+    void stopRecording() override;
+    bool isRecording() const override;
 
 private slots:
     void onChildPlaybackStateChanged(bool playing);
@@ -30,8 +40,12 @@ private slots:
 
 private:
     bool looksLikeYouTube(const QString& url) const;
+    bool routesToHls(const QString& url) const;
+    void attachChild(AbstractPlayer* child);
+    AbstractPlayer* current() const;
 
-    RadioPlayer* m_radio = nullptr;
+    AbstractPlayer* m_radio = nullptr;  // RadioPlayer или StreamPlayer
     YTPlayer*    m_yt = nullptr;
-    enum class Source { None, Radio, YouTube } m_currentSource = Source::None;
+    AbstractPlayer* m_hls = nullptr;    // StreamPlayer для HLS, если radio не умеет
+    enum class Source { None, Radio, YouTube, Hls } m_currentSource = Source::None;
 };
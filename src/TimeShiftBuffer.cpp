@@ -0,0 +1,185 @@
+#include "TimeShiftBuffer.h"
+#include <QDir>
+#include <QTemporaryFile>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // Выше — окно в отображённый файл, чтобы не держать его в куче
+    const qint64 kMemoryLimit = 32 * 1024 * 1024;
+}
+
+TimeShiftBuffer::TimeShiftBuffer(qint64 capacity)
+{
+    setCapacity(capacity);
+}
+
+TimeShiftBuffer::~TimeShiftBuffer()
+{
+    if (m_file && m_data)
+        m_file->unmap(m_data);
+}
+
+bool TimeShiftBuffer::allocate(qint64 capacity, QByteArray& memory,
+                               std::unique_ptr<QTemporaryFile>& file, uchar*& data)
+{
+    if (capacity > kMemoryLimit) {
+        file = std::make_unique<QTemporaryFile>(QDir::temp().filePath(QStringLiteral("LoraRadio-timeshift-XXXXXX")));
+        if (file->open() && file->resize(capacity)) {
+            data = file->map(0, capacity);
+            if (data)
+                return true;
+        }
+        qWarning() << "[TimeShiftBuffer] Cannot map spill file, keeping window in memory:" << file->errorString();
+        file.reset();
+    }
+    memory = QByteArray(capacity, Qt::Uninitialized);
+    data = reinterpret_cast<uchar*>(memory.data());
+    return true;
+}
+
+void TimeShiftBuffer::setCapacity(qint64 capacity)
+{
+    capacity = qMax<qint64>(capacity, 64 * 1024);
+    QMutexLocker lock(&m_mutex);
+    if (capacity == m_capacity)
+        return;
+
+    QByteArray memory;
+    std::unique_ptr<QTemporaryFile> file;
+    uchar *data = nullptr;
+    allocate(capacity, memory, file, data);
+
+    // Переносим хвост по тем же абсолютным позициям
+    const qint64 from = qMax(m_end - qMin(m_capacity, capacity), qint64(0));
+    for (qint64 p = from; p < m_end; ) {
+        const qint64 src = p % m_capacity;
+        const qint64 dst = p % capacity;
+        const qint64 n = std::min({ m_end - p, m_capacity - src, capacity - dst });
+        std::memcpy(data + dst, m_data + src, size_t(n));
+        p += n;
+    }
+
+    if (m_file && m_data)
+        m_file->unmap(m_data);
+    m_memory = std::move(memory);
+    m_file = std::move(file);
+    m_data = data;
+    m_capacity = capacity;
+    qDebug() << "[TimeShiftBuffer] Window" << capacity / 1024 << "KB" << (m_file ? "(mapped file)" : "");
+}
+
+qint64 TimeShiftBuffer::capacity() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_capacity;
+}
+
+void TimeShiftBuffer::append(const char* data, qsizetype len)
+{
+    QMutexLocker lock(&m_mutex);
+    while (len > 0) {
+        const qint64 off = m_end % m_capacity;
+        const qint64 n = qMin<qint64>(len, m_capacity - off);
+        std::memcpy(m_data + off, data, size_t(n));
+        m_end += n;
+        data += n;
+        len  -= n;
+    }
+    m_changed.wakeAll();
+}
+
+void TimeShiftBuffer::finish()
+{
+    QMutexLocker lock(&m_mutex);
+    m_finished = true;
+    m_changed.wakeAll();
+}
+
+void TimeShiftBuffer::wake()
+{
+    QMutexLocker lock(&m_mutex);
+    m_changed.wakeAll();
+}
+
+qint64 TimeShiftBuffer::startPos() const
+{
+    QMutexLocker lock(&m_mutex);
+    return qMax(m_end - m_capacity, qint64(0));
+}
+
+qint64 TimeShiftBuffer::endPos() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_end;
+}
+
+qint64 TimeShiftBuffer::read(qint64* pos, char* data, qint64 maxlen,
+                             const std::atomic<bool>& hold, const std::atomic<bool>& cancel)
+{
+    QMutexLocker lock(&m_mutex);
+    while (!cancel.load() && (hold.load() || (*pos >= m_end && !m_finished)))
+        m_changed.wait(&m_mutex);
+    if (cancel.load())
+        return -1;
+    const qint64 n = copyLocked(pos, data, maxlen);
+    return n > 0 ? n : -1;
+}
+
+qint64 TimeShiftBuffer::readAvailable(qint64* pos, char* data, qint64 maxlen)
+{
+    QMutexLocker lock(&m_mutex);
+    return copyLocked(pos, data, maxlen);
+}
+
+qint64 TimeShiftBuffer::copyLocked(qint64* pos, char* data, qint64 maxlen)
+{
+    const qint64 start = qMax(m_end - m_capacity, qint64(0));
+    if (*pos < start) {
+        qWarning() << "[TimeShiftBuffer] Reader fell out of the window, skipping" << start - *pos << "bytes";
+        *pos = start;
+    }
+
+    qint64 total = 0;
+    while (total < maxlen && *pos < m_end) {
+        const qint64 off = *pos % m_capacity;
+        const qint64 n = std::min({ maxlen - total, m_end - *pos, m_capacity - off });
+        std::memcpy(data + total, m_data + off, size_t(n));
+        total += n;
+        *pos  += n;
+    }
+    return total;
+}
+
+StreamFeed::StreamFeed(QSharedPointer<TimeShiftBuffer> store, qint64 pos)
+    : m_store(std::move(store))
+    , m_pos(pos)
+{
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+void StreamFeed::setHeld(bool held)
+{
+    if (m_held.exchange(held) != held && !held)
+        m_store->wake();
+}
+
+void StreamFeed::cancel()
+{
+    m_cancelled.store(true);
+    m_store->wake();
+}
+
+qint64 StreamFeed::bytesAvailable() const
+{
+    return qMax<qint64>(0, m_store->endPos() - m_pos.load()) + QIODevice::bytesAvailable();
+}
+
+qint64 StreamFeed::readData(char* data, qint64 maxlen)
+{
+    qint64 pos = m_pos.load();
+    const qint64 n = m_store->read(&pos, data, maxlen, m_held, m_cancelled);
+    m_pos.store(pos);
+    return n;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+
+class QTemporaryFile;
+
+// TimeShiftBuffer — последние N минут сжатого потока как есть, без
+// перекодирования: память = битрейт × окно. Сеть дописывает в конец,
+// самое старое затирается. Позиции абсолютные (байт от начала сессии;
+// зеркало станции при переходе дописывает в то же окно), поэтому чтецы (StreamFeed) могут отставать от эфира и отматывать назад.
+// Большое окно (> 32 МБ) уходит в отображённый в память временный файл.
+class TimeShiftBuffer {
+public:
+    explicit TimeShiftBuffer(qint64 capacity);
+    ~TimeShiftBuffer();
+
+    // Меняет окно, сохраняя последние байты; позиции не сдвигаются
+    void setCapacity(qint64 capacity);
+    qint64 capacity() const;
+
+    void append(const char* data, qsizetype len);
+    void append(const QByteArray& data) { append(data.constData(), data.size()); }
+    void finish();  // конец потока/остановка — будит ждущих чтецов
+    void wake();
+
+    qint64 startPos() const;  // самый старый доступный байт
+    qint64 endPos() const;    // край эфира
+
+    // Ждёт данных (и снятия hold) — для декодера 0 означал бы конец.
+    // Затёртую позицию переносит на самый старый байт
+    qint64 read(qint64* pos, char* data, qint64 maxlen,
+                const std::atomic<bool>& hold, const std::atomic<bool>& cancel);
+    // То же без ожидания: 0 — новых данных нет
+    qint64 readAvailable(qint64* pos, char* data, qint64 maxlen);
+
+private:
+    qint64 copyLocked(qint64* pos, char* data, qint64 maxlen);
+    bool allocate(qint64 capacity, QByteArray& memory,
+                  std::unique_ptr<QTemporaryFile>& file, uchar*& data);
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_changed;
+    QByteArray     m_memory;
+    std::unique_ptr<QTemporaryFile> m_file;
+    uchar*         m_data = nullptr;
+    qint64         m_capacity = 0;
+    qint64         m_end = 0;      // записано за всё время
+    bool           m_finished = false;
+};
+
+// StreamFeed — курсор декодера в TimeShiftBuffer. Пауза и подпор (hold)
+// останавливают чтение, не трогая сеть; перемотка — новый курсор.
+class StreamFeed : public QIODevice {
+public:
+    StreamFeed(QSharedPointer<TimeShiftBuffer> store, qint64 pos);
+
+    qint64 position() const { return m_pos.load(); }
+    void setHeld(bool held);
+    void cancel();
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char* data, qint64 maxlen) override;
+    qint64 writeData(const char*, qint64) override { return -1; }
+
+private:
+    QSharedPointer<TimeShiftBuffer> m_store;
+    std::atomic<qint64> m_pos;
+    std::atomic<bool>   m_held{false};
+    std::atomic<bool>   m_cancelled{false};
+};
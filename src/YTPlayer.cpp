@@ -1,4 +1,7 @@
 #include "YTPlayer.h"
+#include "AppSettings.h"
+#include "YtHelper.h"
+#include "YtResolver.h"
 
 #include <QCoreApplication>
 #include <QDir>
@@ -6,23 +9,12 @@
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
-#include <QSettings>
 #include <QRegularExpression>
 #include <QJsonValue>
 #include <QDebug>
 #include <QThread>
 #include <vlc/vlc.h>
 
-// Helper: write small logs to exe/logs
-static void writeLog(const QString &name, const QString &content) {
-    QString exeDir = QCoreApplication::applicationDirPath();
-    QString logDir = exeDir + QDir::separator() + "logs";
-    QDir().mkpath(logDir);
-    QFile f(logDir + QDir::separator() + name);
-    if (f.open(QIODevice::WriteOnly | QIODevice::Truncate))
-        f.write(content.toUtf8());
-}
-
 YTPlayer::YTPlayer(const QString& cookiesFile_, QObject* parent)
     : AbstractPlayer(parent)
     , m_cookiesFile(cookiesFile_)
@@ -66,24 +58,25 @@ YTPlayer::YTPlayer(const QString& cookiesFile_, QObject* parent)
     libvlc_event_attach(event_manager, libvlc_MediaPlayerEndReached, onMediaEndReached, this);
     libvlc_event_attach(event_manager, libvlc_MediaPlayerEncounteredError, onMediaError, this);
 
-    ytdlpProcess = new QProcess(this);
-    ytdlpTimer = new QTimer(this);
-    ytdlpTimer->setSingleShot(true);
-
-    // signals for yt-dlp
-    connect(ytdlpProcess, &QProcess::readyReadStandardOutput, this, &YTPlayer::onYtdlpReadyRead);
-    connect(ytdlpProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &YTPlayer::onYtdlpFinished);
-    connect(ytdlpTimer, &QTimer::timeout, this, &YTPlayer::onYtdlpTimeout);
+    // yt-dlp — в YtResolver, без ожиданий в GUI-потоке
+    m_resolver = new YtResolver(this);
+    m_resolver->setPrefetchWorkers(AppSettings::instance()->youtubePrefetchWorkers());
+    m_resolver->setHedgeDelay(AppSettings::instance()->youtubeHedgeDelayMs());
+    YtHelper *helper = m_resolver->helper();
+    helper->setEnabled(AppSettings::instance()->youtubeHelperEnabled());
+    if (!AppSettings::instance()->youtubeHelperPython().isEmpty())
+        helper->setPython(AppSettings::instance()->youtubeHelperPython());
+    helper->setLimits(AppSettings::instance()->youtubeHelperMaxRequests(),
+                      AppSettings::instance()->youtubeHelperMaxRssMb());
+    connect(m_resolver, &YtResolver::resolved, this, &YTPlayer::onResolved);
+    connect(m_resolver, &YtResolver::failed, this, &YTPlayer::onResolveFailed);
 
     connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
         this->stop();
     });
-    connect(ytdlpProcess, &QProcess::readyReadStandardError, this, &YTPlayer::onYtdlpReadyReadError);
 
     // load volume from settings
-    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "MyApp", "LoraRadio");
-    currentVolume = settings.value("volume", 50).toInt();
+    currentVolume = AppSettings::instance()->volume();
 
     // Set initial volume and mute
     libvlc_audio_set_volume(m_player, currentVolume);
@@ -99,12 +92,6 @@ YTPlayer::~YTPlayer()
     qDebug() << "[YTPlayer] dtor START";
     stop();
 
-    // Clean up yt-dlp if needed
-    if (ytdlpProcess && ytdlpProcess->state() != QProcess::NotRunning) {
-        ytdlpProcess->kill();
-        ytdlpProcess->waitForFinished(300);
-    }
-
     if (m_currentMedia) {
         libvlc_media_release(m_currentMedia);
         m_currentMedia = nullptr;
@@ -137,6 +124,13 @@ void YTPlayer::onMediaError(const libvlc_event_t *event, void *user_data) {
     Q_UNUSED(event);
     YTPlayer *player = static_cast<YTPlayer*>(user_data);
     qWarning() << "[YTPlayer] Media error encountered";
+    if (player->m_playingCached.exchange(false)) {
+        const int generation = player->m_playGeneration.load();
+        QMetaObject::invokeMethod(player, [player, generation]() {
+            player->retryWithoutCache(generation);
+        }, Qt::QueuedConnection);
+        return;
+    }
     player->playing = false;
     emit player->playbackStateChanged(false);
     emit player->errorOccurred("Playback error: Media failed to load");
@@ -158,66 +152,45 @@ void YTPlayer::play(const QString& url)
     stop();
 
     qDebug() << "[YTPlayer] Play requested for URL:" << url;
-    qDebug() << "[YTPlayer] Current working dir:" << QDir::currentPath();
-    qDebug() << "[YTPlayer] PATH env:" << qgetenv("PATH");
-
-
-
-    // normalize possible 11-char id
-    QString normalized = url.trimmed();
-    QRegularExpression rx("^[A-Za-z0-9_-]{11}$");
-    if (rx.match(normalized).hasMatch())
-        normalized = QStringLiteral("https://www.youtube.com/watch?v=%1").arg(normalized);
-
-    pendingNormalizedUrl = normalized;
-    pendingAllowPlaylist = normalized.contains("list=") || normalized.contains("playlist");
 
-    // stop any previous yt-dlp
-    if (ytdlpProcess->state() != QProcess::NotRunning) {
-        ytdlpProcess->kill();
-        ytdlpProcess->waitForFinished(200);
-    }
-    ytdlpStdoutBuffer.clear();
-    ytdlpTriedManifest = false;
-
-    // Determine yt-dlp executable
-    QFile localYt("thirdparty/libmpv/yt-dlp.exe");  // Keep path as is, or adjust if needed
-    QString prog = localYt.exists() ? localYt.fileName() : QStringLiteral("yt-dlp");
-    ytdlpProcess->setProgram(prog);
-
-    // Build args: get direct audio URL (prefer m4a)
-    QStringList args;
-    args << QStringLiteral("-g")
-         << QStringLiteral("-f") << QStringLiteral("bestaudio[ext=m4a]/bestaudio")
-         << QStringLiteral("--no-check-certificate"); // optional, helps some environments
-
-    if (pendingAllowPlaylist)
-        args << QStringLiteral("--yes-playlist");
-    else
-        args << QStringLiteral("--no-playlist");
-
-    if (!m_cookiesFile.isEmpty())
-        args << QStringLiteral("--cookies") << m_cookiesFile;
-
-    args << pendingNormalizedUrl;
+    pendingNormalizedUrl = YtResolver::normalize(url);
+    ++m_playGeneration;
+    m_playingCached = false;
+    // Прежний запрос отписан в stop(): его ответ придёт с чужим номером
+    m_request = m_resolver->resolve(pendingNormalizedUrl, m_cookiesFile);
+}
 
-    ytdlpProcess->setArguments(args);
+void YTPlayer::onResolved(int requestId, const QString& directUrl, bool fromCache)
+{
+    if (requestId != m_request)
+        return;
+    m_request = 0;
+    qDebug() << "[YTPlayer] Resolved URL" << (fromCache ? "(cache):" : ":") << directUrl.left(400);
+    m_playingCached = fromCache;
+    startMedia(directUrl);
+}
 
-    ytdlpProcess->start();
-    if (!ytdlpProcess->waitForStarted(3000)) {
-        qWarning() << "[YTPlayer] yt-dlp failed to start. Error:" << ytdlpProcess->errorString();
-        emit errorOccurred("yt-dlp failed to start: " + ytdlpProcess->errorString());
+void YTPlayer::onResolveFailed(int requestId, const QString& error)
+{
+    if (requestId != m_request)
         return;
-    }
-    qDebug() << "[YTPlayer] yt-dlp started successfully. PID:" << ytdlpProcess->processId();
-    ytdlpTimer->start(30000); // 30s timeout for live/slow responses
+    m_request = 0;
+    emit errorOccurred(error);
+}
 
+void YTPlayer::retryWithoutCache(int generation)
+{
+    if (generation != m_playGeneration.load())
+        return;  // за это время включили другое
+    qWarning() << "[YTPlayer] Cached stream URL rejected, resolving again";
+    m_resolver->invalidate(pendingNormalizedUrl, m_cookiesFile);
+    m_request = m_resolver->resolve(pendingNormalizedUrl, m_cookiesFile, false);
 }
 
-void YTPlayer::onYtdlpReadyRead()
+void YTPlayer::prepareNext(const QStringList& urls)
 {
-    if (!ytdlpProcess) return;
-    ytdlpStdoutBuffer.append(ytdlpProcess->readAllStandardOutput());
+    // Ссылки соседей разрешаются в фоне — переход стартует из кэша
+    m_resolver->prefetch(urls, m_cookiesFile);
 }
 
 bool YTPlayer::supportsFeature(const QString& feature) const {
@@ -238,81 +211,8 @@ QString YTPlayer::cookiesFile() const {
     return m_cookiesFile;
 }
 
-
-void YTPlayer::onYtdlpReadyReadError() {
-    if (!ytdlpProcess) return;
-    QString err = QString::fromUtf8(ytdlpProcess->readAllStandardError()).trimmed();
-    if (!err.isEmpty()) {
-        qWarning() << "[YTPlayer] yt-dlp stderr (real-time):" << err;
-        writeLog("yt_err_realtime.txt", err + "\n");  // Append to separate file for real-time
-    }
-}
-
-void YTPlayer::onYtdlpTimeout()
-{
-    if (!ytdlpProcess) return;
-    if (ytdlpProcess->state() != QProcess::NotRunning) {
-        ytdlpProcess->kill();
-        ytdlpProcess->waitForFinished(200);
-    }
-    emit errorOccurred("yt-dlp timed out while resolving stream URL");
-}
-
-void YTPlayer::onYtdlpFinished(int exitCode, QProcess::ExitStatus)
+void YTPlayer::startMedia(const QString& directUrl)
 {
-    ytdlpTimer->stop();
-
-    QString stdoutStr = QString::fromUtf8(ytdlpStdoutBuffer).trimmed();
-    QString stderrStr = QString::fromUtf8(ytdlpProcess->readAllStandardError()).trimmed();
-
-    writeLog("yt_out.txt", stdoutStr);
-    writeLog("yt_err.txt", stderrStr);
-
-    qDebug() << "[YTPlayer] yt-dlp exitCode =" << exitCode;
-    qDebug() << "[YTPlayer] yt-dlp stdout (snippet):" << stdoutStr.left(1024);
-    qDebug() << "[YTPlayer] yt-dlp stderr (snippet):" << stderrStr.left(1024);
-
-    bool needFallback = stdoutStr.isEmpty() ||
-                        stderrStr.contains("Requested format is not available") ||
-                        stderrStr.contains("only manifest");
-
-    if (needFallback && !ytdlpTriedManifest) {
-        qDebug() << "[YTPlayer] Trying fallback: request manifest (no -f)";
-        ytdlpTriedManifest = true;
-
-        QString prog = ytdlpProcess->program();
-        QStringList args;
-        args << QStringLiteral("-g")
-             << QStringLiteral("--no-check-certificate")
-             << pendingNormalizedUrl;
-
-        ytdlpProcess->setArguments(args);
-        ytdlpStdoutBuffer.clear();
-        ytdlpProcess->start();
-        if (!ytdlpProcess->waitForStarted(3000)) {
-            qWarning() << "[YTPlayer] yt-dlp failed to start for fallback manifest";
-            emit errorOccurred("yt-dlp failed to start (fallback)");
-            return;
-        }
-        ytdlpTimer->start(30000);
-        return;
-    }
-
-    if (stdoutStr.isEmpty()) {
-        qWarning() << "[YTPlayer] yt-dlp returned empty stdout (after fallback). stderr:" << stderrStr;
-        emit errorOccurred("yt-dlp returned no URL (even after fallback). See logs.");
-        return;
-    }
-
-    QStringList lines = stdoutStr.split('\n', Qt::SkipEmptyParts);
-    for (QString &s : lines) s = s.trimmed();
-    if (lines.isEmpty()) {
-        emit errorOccurred("yt-dlp returned unexpected output");
-        return;
-    }
-    QString directUrl = lines.first();
-    qDebug() << "[YTPlayer] Resolved URL:" << directUrl.left(400);
-
     // ИСПРАВЛЕНО: Остановка и освобождение предыдущего media
     libvlc_media_player_stop(m_player);
 
@@ -363,6 +263,11 @@ void YTPlayer::stop()
         return;
     }
 
+    if (m_request) {
+        m_resolver->cancel(m_request);
+        m_request = 0;
+    }
+
     libvlc_media_player_stop(m_player);
     playing = false;
     emit playbackStateChanged(false);
@@ -389,8 +294,7 @@ void YTPlayer::setVolume(int value)
         libvlc_audio_set_volume(m_player, currentVolume);
     }
 
-    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "MyApp", "LoraRadio");
-    settings.setValue("volume", currentVolume);
+    AppSettings::instance()->setVolume(currentVolume);
     emit volumeChanged(currentVolume);
 }
 
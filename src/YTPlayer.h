@@ -6,8 +6,10 @@
 #include <QLocalSocket>
 #include "../include/AbstractPlayer.h"
 #include <vlc/vlc.h>  // For libVLC types and functions
+#include <atomic>
 
 class AbstractPlayer; // forward (assume exists)
+class YtResolver;
 
 class YTPlayer : public AbstractPlayer {
     Q_OBJECT
@@ -22,6 +24,7 @@ public:
     void togglePlayback();
 
     bool supportsFeature(const QString& feature) const override;
+    void prepareNext(const QStringList& urls) override;
     void setCookiesFile(const QString& path) override;
     QString cookiesFile() const override;
     void setVolume(int value);
@@ -37,11 +40,9 @@ signals:
     void errorOccurred(const QString& message);
 
 private slots:
-    // yt-dlp
-    void onYtdlpReadyRead();
-    void onYtdlpFinished(int exitCode, QProcess::ExitStatus exitStatus);
-    void onYtdlpTimeout();
-    void onYtdlpReadyReadError();
+    // yt-dlp (YtResolver), ответы сверяются по номеру запроса
+    void onResolved(int requestId, const QString& directUrl, bool fromCache);
+    void onResolveFailed(int requestId, const QString& error);
 
     // libVLC events (no slots needed, use static callbacks)
 
@@ -55,16 +56,18 @@ private:
     static void onMediaEndReached(const libvlc_event_t *event, void *user_data);
     static void onMediaError(const libvlc_event_t *event, void *user_data);
 
-    void writeLogFile(const QString& name, const QString& contents);
+    void startMedia(const QString& directUrl);
+    void retryWithoutCache(int generation);
 
-    QProcess* ytdlpProcess = nullptr;
-    QTimer* ytdlpTimer = nullptr;
-    bool ytdlpTriedManifest = false;
-
-    QByteArray ytdlpStdoutBuffer;
+    YtResolver* m_resolver = nullptr;
+    int m_request = 0;  // текущий запрос; 0 — ничего не ждём
     QString m_cookiesFile;
     QString pendingNormalizedUrl;
-    bool pendingAllowPlaylist = false;
+
+    // Ссылка из кэша могла умереть раньше expire (привязка к IP) —
+    // тогда один повтор через yt-dlp
+    std::atomic<bool> m_playingCached{false};
+    std::atomic<int> m_playGeneration{0};  // колбэки libVLC идут из его потока
 
     bool playing = false;
     int currentVolume = 50;
@@ -1,21 +1,23 @@
 #include "YouTubePage.h"
 #include "../include/fluent_icons.h"
 #include <QHBoxLayout>
-#include <QListWidgetItem>
+#include <QLineEdit>
+#include <QListView>
 #include <QSlider>
 #include <QSpinBox>
 #include "IconButton.h"
 using namespace fluent_icons;
 
-YouTubePage::YouTubePage(StationManager* stations, AbstractPlayer* player, QWidget* parent)
+YouTubePage::YouTubePage(StationManager* stations, StationModel* model, AbstractPlayer* player, QWidget* parent)
     : QWidget(parent)
+    , m_listModel(new StationTypeModel(model, QStringLiteral("youtube"), this))
     , m_stations(stations)
     , m_player(player)
 {
     setupUi();
     setupConnections();
-    m_currentStationIndex = m_stations ? m_stations->lastStationIndex(QStringLiteral("youtube")) : -1;
-    if (m_currentStationIndex >= 0) m_resultList->setCurrentRow(m_currentStationIndex);
+    m_currentStationId = m_stations ? m_stations->lastStationId(QStringLiteral("youtube")) : 0;
+    restoreCurrentStation();
 
     int initVol = 50;
     if (m_player) initVol = m_player->volume();
@@ -25,7 +27,13 @@ YouTubePage::YouTubePage(StationManager* stations, AbstractPlayer* player, QWidg
 void YouTubePage::setupUi()
 {
     // Results list
-    m_resultList = new QListWidget(this);
+    m_resultList = new QListView(this);
+    m_resultList->setModel(m_listModel);
+    m_resultList->setUniformItemSizes(true);
+    m_resultList->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText(tr("Поиск"));
+    m_filterEdit->setClearButtonEnabled(true);
 
     // CRUD buttons under the list (same as RadioPage)
     m_btnAdd    = new IconButton(ic_fluent_add_circle_32_filled, 32, QColor("#FFF"), tr("Добавить"), this);
@@ -58,6 +66,7 @@ void YouTubePage::setupUi()
 
     // Center: list + crud buttons
     auto *centerLay = new QVBoxLayout(stationPanel);  // Layout теперь в panel
+    centerLay->addWidget(m_filterEdit);
     centerLay->addWidget(m_resultList, 1);
     centerLay->addLayout(crudLay);
     centerLay->setContentsMargins(0, 0, 0, 0);  // Уберите зазоры
@@ -92,12 +101,18 @@ void YouTubePage::setupUi()
 
 void YouTubePage::setupConnections()
 {
+    // Filter as you type; keep the current station selected when visible
+    connect(m_filterEdit, &QLineEdit::textChanged, this, [this](const QString& text) {
+        m_listModel->setFilterText(text);
+        restoreCurrentStation();
+    });
+
     // When current item changes — emit playRequested (selection via keyboard or list navigation)
-    connect(m_resultList, &QListWidget::currentItemChanged, this,
-        [this](QListWidgetItem *current, QListWidgetItem *previous) {
+    connect(m_resultList->selectionModel(), &QItemSelectionModel::currentChanged, this,
+        [this](const QModelIndex &current, const QModelIndex &previous) {
             Q_UNUSED(previous);
-            if (!current) return;
-            QString url = current->data(Qt::UserRole).toString();
+            if (!current.isValid() || m_syncingSelection || m_listModel->isChanging()) return;
+            QString url = current.data(StationModel::UrlRole).toString();
             if (!url.isEmpty()) {
                 qDebug() << "[YouTubePage] currentItemChanged -> playRequested:" << url;
                 emit playRequested(url);
@@ -105,9 +120,9 @@ void YouTubePage::setupConnections()
     });
 
     // Also handle explicit clicks (single click) — user asked "при выборе в списке — оно играло"
-    connect(m_resultList, &QListWidget::itemClicked, this, [this](QListWidgetItem* it) {
-        if (!it) return;
-        QString url = it->data(Qt::UserRole).toString();
+    connect(m_resultList, &QListView::clicked, this, [this](const QModelIndex &it) {
+        if (!it.isValid()) return;
+        QString url = it.data(StationModel::UrlRole).toString();
         if (!url.isEmpty()) {
             qDebug() << "[YouTubePage] itemClicked -> playRequested:" << url;
             emit playRequested(url);
@@ -115,9 +130,9 @@ void YouTubePage::setupConnections()
     });
 
     // Double-click should also play (common UX)
-    connect(m_resultList, &QListWidget::itemDoubleClicked, this, [this](QListWidgetItem* it) {
-        if (!it) return;
-        QString url = it->data(Qt::UserRole).toString();
+    connect(m_resultList, &QListView::doubleClicked, this, [this](const QModelIndex &it) {
+        if (!it.isValid()) return;
+        QString url = it.data(StationModel::UrlRole).toString();
         if (!url.isEmpty()) {
             qDebug() << "[YouTubePage] itemDoubleClicked -> playRequested:" << url;
             emit playRequested(url);
@@ -139,49 +154,51 @@ void YouTubePage::setupConnections()
     });
 
     auto getSelectedIndex = [this]() -> int {
-        int idx = m_resultList->currentRow();
+        int idx = m_resultList->currentIndex().row();
         if (idx >= 0) return idx;
-        // fallback: selectedItems()
-        const auto sel = m_resultList->selectedItems();
-        if (!sel.isEmpty()) return m_resultList->row(sel.first());
+        // fallback: selectedIndexes()
+        const auto sel = m_resultList->selectionModel()->selectedIndexes();
+        if (!sel.isEmpty()) return sel.first().row();
         return -1;
     };
 
     // ОСТАВЛЯЕМ ТОЛЬКО ЭТОТ обработчик для m_btnRemove
     connect(m_btnRemove, &IconButton::clicked, this, [this, getSelectedIndex]() {
-        int idx = getSelectedIndex();
-        if (idx < 0) {
+        const quint64 id = m_listModel->idAt(getSelectedIndex());
+        if (id == 0) {
             qWarning() << "[YouTubePage] requestRemove: no selection";
             return;
         }
-        qDebug() << "[YouTubePage] requestRemove(" << idx << ")";
-        emit requestRemove(idx);
+        qDebug() << "[YouTubePage] requestRemove(" << id << ")";
+        emit requestRemove(id);
     });
 
     connect(m_btnUpdate, &IconButton::clicked, this, [this, getSelectedIndex]() {
-        int idx = getSelectedIndex();
-        if (idx < 0) {
+        const quint64 id = m_listModel->idAt(getSelectedIndex());
+        if (id == 0) {
             qWarning() << "[YouTubePage] requestUpdate: no selection";
             return;
         }
-        qDebug() << "[YouTubePage] requestUpdate(" << idx << ")";
-        emit requestUpdate(idx);
+        qDebug() << "[YouTubePage] requestUpdate(" << id << ")";
+        emit requestUpdate(id);
     });
 
     // Авто-включение/выключение кнопок Update/Remove в зависимости от selection
-    auto selectionChangedHandler = [this]() {
-        bool hasSelection = (m_resultList->currentRow() >= 0) || (!m_resultList->selectedItems().isEmpty());
-        m_btnRemove->setEnabled(hasSelection);
-        m_btnUpdate->setEnabled(hasSelection);
-    };
     // initial state
-    selectionChangedHandler();
+    updateSelectionButtons();
     connect(m_resultList->selectionModel(), &QItemSelectionModel::selectionChanged,
-            this, selectionChangedHandler);
-    connect(m_resultList, &QListWidget::currentRowChanged, this, [this, selectionChangedHandler](int row) {
-        m_currentStationIndex = row;
-        selectionChangedHandler();
+            this, &YouTubePage::updateSelectionButtons);
+    connect(m_resultList->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+            [this](const QModelIndex &current, const QModelIndex &) {
+        if (!m_listModel->isChanging()) {
+            const quint64 id = m_listModel->idAt(current.row());
+            if (id != 0) m_currentStationId = id;
+        }
+        updateSelectionButtons();
     });
+    // Список обновляется моделью; после полной перезагрузки возвращаем выбор
+    connect(m_listModel, &QAbstractItemModel::modelReset,
+            this,        &YouTubePage::restoreCurrentStation);
 
     // Playback controls
     connect(m_btnPlay, &IconButton::clicked, this, [this]() {
@@ -217,41 +234,36 @@ void YouTubePage::setupConnections()
     }
 }
 
-void YouTubePage::setStations(const QVector<Station>& stations)
+void YouTubePage::updateSelectionButtons()
 {
-    m_resultList->blockSignals(true);  // Блокируем сигналы
-
-    m_resultList->clear();
-    // Отключаем сигналы selectionModel на время заполнения списка, чтобы не срабатывать лишний раз
-    auto model = m_resultList->selectionModel();
-    if (model) model->blockSignals(true);
-
-    for (const Station &s : stations) {
-        QListWidgetItem *it = new QListWidgetItem(s.name.isEmpty() ? s.url : s.name);
-        it->setData(Qt::UserRole, s.url);
-        m_resultList->addItem(it);
-    }
-
-    // восстановим сигналы и обновим кнопки
-    if (model) model->blockSignals(false);
-    // синхронизируем состояние кнопок (удаление/изменение)
-    bool hasSelection = (m_resultList->currentRow() >= 0) || (!m_resultList->selectedItems().isEmpty());
+    bool hasSelection = m_resultList->currentIndex().isValid() || m_resultList->selectionModel()->hasSelection();
     m_btnRemove->setEnabled(hasSelection);
     m_btnUpdate->setEnabled(hasSelection);
+}
 
-    if (m_currentStationIndex >= 0 && m_currentStationIndex < stations.size()) {
-        m_resultList->setCurrentRow(m_currentStationIndex);
-    } else if (!stations.isEmpty()) {
-        m_resultList->setCurrentRow(0);
-    }
+void YouTubePage::selectRow(int row)
+{
+    m_syncingSelection = true;
+    m_resultList->setCurrentIndex(m_listModel->index(row, 0));
+    m_syncingSelection = false;
+}
 
-    m_resultList->blockSignals(false);  // Разблокируем
+void YouTubePage::restoreCurrentStation()
+{
+    const int row = m_listModel->rowOfId(m_currentStationId);
+    if (row >= 0) {
+        selectRow(row);
+    } else if (m_listModel->rowCount() > 0) {
+        selectRow(0);
+    }
+    updateSelectionButtons();
 }
 
-void YouTubePage::setCurrentStation(int index) {
-    if (index >= 0 && index < m_resultList->count()) {
-        m_resultList->setCurrentRow(index);
-        m_currentStationIndex = index;
+void YouTubePage::setCurrentStation(quint64 id) {
+    const int row = m_listModel->rowOfId(id);
+    if (row >= 0) {
+        selectRow(row);  // станция уже запущена вызывающим
+        m_currentStationId = id;
     }
 }
 
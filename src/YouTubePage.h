@@ -3,9 +3,11 @@
 #include <QWidget>
 #include <QPointer>
 #include "StationManager.h"
+#include "StationModel.h"
 #include "../include/AbstractPlayer.h"
 
-class QListWidget;
+class QLineEdit;
+class QListView;
 class QSlider;
 class QSpinBox;
 class IconButton;
@@ -17,8 +19,7 @@ class YouTubePage : public QWidget
 {
     Q_OBJECT
 public:
-    explicit YouTubePage(StationManager* stations, AbstractPlayer* player, QWidget* parent = nullptr);
-    void setStations(const QVector<Station>& stations);
+    explicit YouTubePage(StationManager* stations, StationModel* model, AbstractPlayer* player, QWidget* parent = nullptr);
 
     signals:
         void playRequested(const QString &url);
@@ -30,8 +31,8 @@ public:
 
     // Обработчики CRUD для элементов списка (аналог RadioPage)
     void requestAdd();
-    void requestRemove(int index);
-    void requestUpdate(int index);
+    void requestRemove(quint64 id);
+    void requestUpdate(quint64 id);
 
     // Громкость / mute / состояние воспроизведения
     void volumeChanged(int value);
@@ -40,7 +41,7 @@ public slots:
     void onVolumeChanged(int value);
     void setVolume(int value);
     void setPlaybackState(bool isPlaying);
-    void setCurrentStation(int index);
+    void setCurrentStation(quint64 id);
     void setMuted(bool muted);
     void stopPlayback();
 
@@ -48,10 +49,16 @@ public slots:
 private:
     void setupUi();
     void setupConnections();
+    void selectRow(int row);
+    void restoreCurrentStation();
+    void updateSelectionButtons();
     bool m_isPlaying = false;
+    bool m_syncingSelection = false;
 
     // UI
-    QListWidget* m_resultList = nullptr;
+    StationTypeModel* m_listModel = nullptr;
+    QListView*   m_resultList = nullptr;
+    QLineEdit*   m_filterEdit = nullptr;
 
     IconButton*  m_btnAdd = nullptr;
     IconButton*  m_btnRemove = nullptr;
@@ -68,5 +75,5 @@ private:
 
     StationManager* m_stations = nullptr;
     AbstractPlayer* m_player = nullptr;
-    int m_currentStationIndex = -1;
+    quint64 m_currentStationId = 0;
 };
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include "YtHelper.h"
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+    const int kStartTimeoutMs = 15000;   // импорт yt_dlp с холодного диска
+    const int kRetireGraceMs = 60000;    // сменённый процесс дольше не ждём
+    const int kCrashWindowMs = 60000;
+    const int kMaxCrashes = 3;           // за окно — помощник выключается
+}
+
+YtHelper::YtHelper(QObject* parent)
+    : QObject(parent)
+    , m_startTimer(new QTimer(this))
+{
+#ifdef Q_OS_WIN
+    m_python = QStringLiteral("python");
+#else
+    m_python = QStringLiteral("python3");
+#endif
+    QFile script(QStringLiteral(":/scripts/yt_helper.py"));
+    if (script.open(QIODevice::ReadOnly))
+        m_script = QString::fromUtf8(script.readAll());
+    if (m_script.isEmpty())
+        m_disabled = true;
+
+    m_startTimer->setSingleShot(true);
+    connect(m_startTimer, &QTimer::timeout, this, [this]() {
+        disable(QStringLiteral("yt-dlp helper did not become ready"));
+    });
+}
+
+YtHelper::~YtHelper()
+{
+    // Процессы — дочерние объекты; сигналы в полуразрушенный помощник не нужны
+    if (m_process)
+        m_process->disconnect(this);
+    for (QProcess* process : std::as_const(m_retiring))
+        process->disconnect(this);
+}
+
+void YtHelper::setLimits(int maxRequests, int maxRssMb)
+{
+    m_maxRequests = maxRequests;
+    m_maxRssMb = maxRssMb;
+}
+
+void YtHelper::setWorkers(int foreground, int background)
+{
+    m_foregroundWorkers = qMax(1, foreground);
+    m_backgroundWorkers = qMax(1, background);
+}
+
+void YtHelper::warmUp()
+{
+    ensureProcess();
+}
+
+int YtHelper::request(const QString& url, const QString& format, const QString& cookiesFile,
+                      bool playlist, bool background)
+{
+    const int ticket = ++m_nextTicket;
+    Ticket t;
+    t.request.insert("url", url);
+    t.request.insert("format", format.isEmpty() ? QJsonValue() : QJsonValue(format));
+    t.request.insert("cookies", cookiesFile);
+    t.request.insert("playlist", playlist);
+    t.request.insert("background", background);
+    m_tickets.insert(ticket, t);
+    send(ticket);
+    return ticket;
+}
+
+void YtHelper::cancel(int ticket)
+{
+    const Ticket t = m_tickets.take(ticket);
+    if (m_queued.removeOne(ticket) || !t.owner)
+        return;  // в процесс ещё не отправлен
+    // Сменённому процессу писать уже некуда: stdin закрыт
+    if (t.owner == m_process) {
+        QJsonObject line;
+        line.insert("cancel", ticket);
+        m_process->write(QJsonDocument(line).toJson(QJsonDocument::Compact) + '\n');
+    }
+}
+
+void YtHelper::ensureProcess()
+{
+    if (m_disabled || m_process)
+        return;
+
+    QProcess *process = new QProcess(this);
+    m_process = process;
+    m_ready = false;
+    m_served = 0;
+    process->setProgram(m_python);
+    process->setArguments({ QStringLiteral("-u"), QStringLiteral("-c"), m_script,
+                            QString::number(m_foregroundWorkers), QString::number(m_backgroundWorkers) });
+
+    connect(process, &QProcess::readyReadStandardOutput, this, [this, process]() {
+        onReadyRead(process);
+    });
+    connect(process, &QProcess::readyReadStandardError, this, [process]() {
+        const QString err = QString::fromUtf8(process->readAllStandardError()).trimmed();
+        if (!err.isEmpty())
+            qWarning() << "[YtHelper] stderr:" << err.left(1024);
+    });
+    connect(process, &QProcess::finished, this, [this, process]() {
+        onExited(process);
+    });
+    // Очередью, как в YtResolver: FailedToStart может выйти прямо из start()
+    connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart || m_process != process)
+            return;
+        disable(QStringLiteral("yt-dlp helper failed to start: ") + process->errorString());
+    }, Qt::QueuedConnection);
+
+    process->start();
+    m_startTimer->start(kStartTimeoutMs);
+    qDebug() << "[YtHelper] Starting" << m_python;
+}
+
+void YtHelper::send(int ticket)
+{
+    ensureProcess();
+    if (m_disabled || !m_tickets.contains(ticket))
+        return;
+    m_tickets[ticket].owner = m_process;
+    if (!m_ready) {
+        m_queued << ticket;
+        return;
+    }
+    write(ticket);
+}
+
+void YtHelper::write(int ticket)
+{
+    QJsonObject line = m_tickets.value(ticket).request;
+    line.insert("id", ticket);
+    m_process->write(QJsonDocument(line).toJson(QJsonDocument::Compact) + '\n');
+    if (m_maxRequests > 0 && ++m_served >= m_maxRequests) {
+        qDebug() << "[YtHelper] Served" << m_served << "requests, recycling";
+        recycle();
+    }
+}
+
+void YtHelper::recycle()
+{
+    if (!m_process || !m_ready)
+        return;
+    QProcess *process = m_process;
+    m_process = nullptr;
+    m_ready = false;
+    m_retiring << process;
+    // Конец stdin: доделает начатое и выйдет сам; завис — добиваем
+    process->closeWriteChannel();
+    QTimer::singleShot(kRetireGraceMs, process, [process]() { process->kill(); });
+    ensureProcess();  // смена тёплая: следующий запрос не ждёт импорта
+}
+
+void YtHelper::onReadyRead(QProcess* process)
+{
+    QByteArray &buffer = m_buffers[process];
+    buffer.append(process->readAllStandardOutput());
+    QList<QByteArray> lines;
+    int newline;
+    while ((newline = buffer.indexOf('\n')) >= 0) {
+        lines << buffer.left(newline);
+        buffer.remove(0, newline + 1);
+    }
+    // Обработчик ответа может выключить помощник и убрать процесс
+    for (const QByteArray& line : std::as_const(lines)) {
+        if (m_process != process && !m_retiring.contains(process))
+            return;
+        onLine(process, line);
+    }
+}
+
+void YtHelper::onLine(QProcess* process, const QByteArray& line)
+{
+    const QJsonObject reply = QJsonDocument::fromJson(line).object();
+    if (reply.isEmpty())
+        return;
+
+    if (reply.contains("ready")) {
+        if (!reply.value("ready").toBool()) {
+            disable(QStringLiteral("yt-dlp helper: ") + reply.value("error").toString());
+            return;
+        }
+        if (process != m_process)
+            return;
+        m_ready = true;
+        m_startTimer->stop();
+        qDebug() << "[YtHelper] Ready, yt_dlp" << reply.value("version").toString();
+        const QList<int> queued = m_queued;
+        m_queued.clear();
+        for (int ticket : queued) {
+            if (!m_tickets.contains(ticket))
+                continue;
+            if (m_process == process)
+                write(ticket);
+            else
+                send(ticket);  // сменился по лимиту — в очередь нового
+        }
+        return;
+    }
+
+    const int ticket = reply.value("id").toInt();
+    if (m_tickets.remove(ticket)) {
+        emit finished(ticket, reply.value("url").toString(), reply.value("error").toString(), false);
+    }
+
+    // Рост памяти: экстракторы и cookie jar копятся от запроса к запросу
+    const int rss = reply.value("rss_mb").toInt();
+    if (m_maxRssMb > 0 && rss > m_maxRssMb && process == m_process) {
+        qDebug() << "[YtHelper] Memory" << rss << "MB over limit, recycling";
+        recycle();
+    }
+}
+
+void YtHelper::onExited(QProcess* process)
+{
+    const bool retiring = m_retiring.removeOne(process);
+    const bool current = process == m_process;
+    if (current) {
+        m_process = nullptr;
+        m_ready = false;
+        m_queued.clear();  // их билеты ниже уйдут новому процессу
+        m_startTimer->stop();
+    }
+    m_buffers.remove(process);
+    process->disconnect(this);
+    process->deleteLater();
+    if (m_disabled)
+        return;
+
+    QList<int> lost;
+    for (auto it = m_tickets.constBegin(); it != m_tickets.constEnd(); ++it) {
+        if (it->owner == process)
+            lost << it.key();
+    }
+    if (retiring && lost.isEmpty())
+        return;  // штатная смена
+
+    qWarning() << "[YtHelper] Helper exited unexpectedly, pending requests:" << lost.size();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    m_crashes << now;
+    m_crashes.removeIf([now](qint64 t) { return now - t > kCrashWindowMs; });
+    if (m_crashes.size() >= kMaxCrashes) {
+        disable(QStringLiteral("yt-dlp helper keeps crashing"));
+        return;
+    }
+
+    for (int ticket : std::as_const(lost)) {
+        if (!m_tickets.contains(ticket))
+            continue;  // отменён обработчиком предыдущего ответа
+        Ticket &t = m_tickets[ticket];
+        if (t.resent) {
+            m_tickets.remove(ticket);
+            emit finished(ticket, QString(), QStringLiteral("yt-dlp helper crashed twice on this request"), true);
+            continue;
+        }
+        t.resent = true;
+        send(ticket);
+    }
+    if (current)
+        ensureProcess();  // держим тёплым и без ожидающих
+}
+
+void YtHelper::disable(const QString& reason)
+{
+    if (m_disabled)
+        return;
+    m_disabled = true;
+    qWarning() << "[YtHelper] Disabled:" << reason;
+    m_startTimer->stop();
+
+    QList<QProcess*> processes = m_retiring;
+    if (m_process)
+        processes << m_process;
+    m_process = nullptr;
+    m_ready = false;
+    m_retiring.clear();
+    m_buffers.clear();
+    for (QProcess* process : std::as_const(processes)) {
+        process->disconnect(this);
+        if (process->state() == QProcess::NotRunning) {
+            process->deleteLater();
+        } else {
+            connect(process, &QProcess::finished, process, &QObject::deleteLater);
+            process->kill();
+        }
+    }
+
+    // Ожидающим — отказ по вине помощника: YtResolver повторит отдельным процессом
+    const QList<int> tickets = m_tickets.keys();
+    m_tickets.clear();
+    m_queued.clear();
+    for (int ticket : tickets)
+        emit finished(ticket, QString(), reason, true);
+}
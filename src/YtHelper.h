@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+class QProcess;
+class QTimer;
+
+// YtHelper — резидентный python-процесс с уже импортированным yt_dlp
+// (скрипт :/scripts/yt_helper.py). Каждый запуск yt-dlp.exe заново
+// распаковывает и импортирует весь экстрактор — это большая часть времени
+// разрешения; здесь импорт один раз, а запросы идут построчным JSON через
+// stdin/stdout и обрабатываются параллельно.
+// Упал — перезапускается, незавершённые запросы уходят в новый процесс
+// (каждый не больше одного раза). После N запросов или при росте памяти
+// процесс плавно сменяется: старый доделывает своё, новые — в свежий.
+// Не запустился (нет python / модуля yt_dlp) или падает раз за разом —
+// помощник выключается, YtResolver возвращается к отдельным процессам.
+class YtHelper : public QObject {
+    Q_OBJECT
+public:
+    explicit YtHelper(QObject* parent = nullptr);
+    ~YtHelper() override;
+
+    void setPython(const QString& program) { m_python = program; }
+    // <= 0 — без ограничения
+    void setLimits(int maxRequests, int maxRssMb);
+    void setEnabled(bool enabled) { m_disabled = !enabled || m_script.isEmpty(); }
+    // Потоки помощника: для запросов, которых ждут, и для предвыборки —
+    // пулы раздельные; действует со следующего запуска процесса
+    void setWorkers(int foreground, int background);
+
+    bool isAvailable() const { return !m_disabled; }
+    // Запустить заранее, чтобы первый запрос не ждал импорта
+    void warmUp();
+    // format пустой — формат yt-dlp по умолчанию; background — в пул предвыборки
+    int  request(const QString& url, const QString& format, const QString& cookiesFile,
+                 bool playlist, bool background);
+    // Ответ не придёт; ещё не начатый разбор помощник выбросит, начатый —
+    // доделает впустую
+    void cancel(int ticket);
+    // Плавная смена процесса (например, завис разбор)
+    void recycle();
+
+signals:
+    // fault — ответа нет по вине помощника (упал, выключен), а не yt-dlp
+    void finished(int ticket, const QString& directUrl, const QString& error, bool fault);
+
+private:
+    struct Ticket {
+        QJsonObject request;
+        QProcess*   owner = nullptr;   // процесс, которому отдан запрос
+        bool        resent = false;
+    };
+
+    void ensureProcess();
+    void send(int ticket);
+    void write(int ticket);
+    void onReadyRead(QProcess* process);
+    void onLine(QProcess* process, const QByteArray& line);
+    void onExited(QProcess* process);
+    void disable(const QString& reason);
+
+    QString             m_python;
+    QString             m_script;
+    QProcess*           m_process = nullptr;   // принимает новые запросы
+    bool                m_ready = false;
+    QList<QProcess*>    m_retiring;            // доделывают своё и выходят
+    QHash<QProcess*, QByteArray> m_buffers;    // неполные строки stdout
+    QHash<int, Ticket>  m_tickets;
+    QList<int>          m_queued;              // ждут готовности процесса
+    QList<qint64>       m_crashes;             // время падений, мс
+    QTimer*             m_startTimer;
+    int                 m_served = 0;
+    int                 m_maxRequests = 200;
+    int                 m_maxRssMb = 400;
+    int                 m_foregroundWorkers = 4;
+    int                 m_backgroundWorkers = 2;
+    int                 m_nextTicket = 0;
+    bool                m_disabled = false;
+};
@@ -0,0 +1,455 @@
+#include "YtResolver.h"
+#include "YtHelper.h"
+#include "YtUrlCache.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+    // Селектор формата для -g; входит в ключ кэша ссылок
+    const QString kAudioFormat = QStringLiteral("bestaudio[ext=m4a]/bestaudio");
+    // Запасной запрос: без -f yt-dlp выбрал бы bv*+ba, и первой строкой -g
+    // была бы дорожка без звука (VLC с --no-video играл бы тишину)
+    const QString kManifestFormat = QStringLiteral("bestaudio/best");
+    // Манифест ответил первым — столько ждём основного: его m4a лучше
+    const int kPreferPrimaryMs = 1000;
+    const int kTimeoutMs = 30000;   // живые трансляции отвечают долго
+    const int kMaxOrphans = 2;
+
+    // Helper: write small logs to exe/logs
+    void writeLog(const QString &name, const QString &content)
+    {
+        QString exeDir = QCoreApplication::applicationDirPath();
+        QString logDir = exeDir + QDir::separator() + "logs";
+        QDir().mkpath(logDir);
+        QFile f(logDir + QDir::separator() + name);
+        if (f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            f.write(content.toUtf8());
+    }
+
+    bool allowsPlaylist(const QString& url)
+    {
+        return url.contains("list=") || url.contains("playlist");
+    }
+
+    // Отменённый процесс убиваем без ожидания; удалится, когда завершится
+    void discardProcess(QProcess* process, QObject* owner)
+    {
+        if (!process)
+            return;
+        process->disconnect(owner);
+        if (process->state() == QProcess::NotRunning) {
+            process->deleteLater();
+            return;
+        }
+        QObject::connect(process, &QProcess::finished, process, &QObject::deleteLater);
+        process->kill();
+    }
+}
+
+YtResolver::YtResolver(QObject* parent)
+    : QObject(parent)
+    , m_cache(new YtUrlCache(QString(), this))
+    , m_helper(new YtHelper(this))
+{
+    connect(m_helper, &YtHelper::finished, this, &YtResolver::onHelperFinished);
+    setPrefetchWorkers(m_prefetchWorkers);
+}
+
+YtResolver::~YtResolver()
+{
+    const QList<Job*> jobs = m_jobs.values();
+    for (Job* job : jobs)
+        killJob(job);
+}
+
+QString YtResolver::normalize(const QString& url)
+{
+    QString normalized = url.trimmed();
+    static const QRegularExpression rx(QStringLiteral("^[A-Za-z0-9_-]{11}$"));
+    if (rx.match(normalized).hasMatch())
+        normalized = QStringLiteral("https://www.youtube.com/watch?v=%1").arg(normalized);
+    return normalized;
+}
+
+int YtResolver::resolve(const QString& url, const QString& cookiesFile, bool useCache)
+{
+    const int id = ++m_nextId;
+    const QString normalized = normalize(url);
+    const QString key = YtUrlCache::key(normalized, kAudioFormat, cookiesFile);
+
+    // Из кэша — тоже сигналом: вызывающий сначала запомнит номер запроса
+    if (useCache) {
+        QString cached = m_cache->lookup(key);
+        if (cached.isEmpty())
+            cached = m_cache->lookup(YtUrlCache::key(normalized, kManifestFormat, cookiesFile));
+        if (!cached.isEmpty()) {
+            QMetaObject::invokeMethod(this, [this, id, cached]() {
+                emit resolved(id, cached, true);
+            }, Qt::QueuedConnection);
+            return id;
+        }
+    }
+
+    if (Job *job = m_jobs.value(key)) {
+        // То же видео уже разрешается (в том числе предвыборкой) — ждём его
+        m_orphans.removeOne(job);
+        if (job->background) {
+            job->background = false;
+            armHedge(job);  // теперь ответа ждут — хеджируем и фоновый
+        }
+        job->waiters << id;
+        qDebug() << "[YtResolver] Request" << id << "joined in-flight yt-dlp for" << normalized;
+        return id;
+    }
+
+    Job *job = createJob(key, normalized, cookiesFile);
+    job->waiters << id;
+    startAttempt(job, false);
+    armHedge(job);
+    return id;
+}
+
+YtResolver::Job* YtResolver::createJob(const QString& key, const QString& url, const QString& cookiesFile)
+{
+    Job *job = new Job;
+    job->key = key;
+    job->url = url;
+    job->cookiesFile = cookiesFile;
+    job->timeout = new QTimer(this);
+    job->timeout->setSingleShot(true);
+    connect(job->timeout, &QTimer::timeout, this, [this, job]() {
+        if (!job->manifestUrl.isEmpty()) {
+            finishJob(job, job->manifestUrl, QString(), true);
+            return;
+        }
+        qWarning() << "[YtResolver] yt-dlp timed out for" << job->url;
+        if (job->primary.ticket || job->manifest.ticket)
+            m_helper->recycle();  // разбор завис в помощнике — меняем процесс
+        finishJob(job, QString(), QStringLiteral("yt-dlp timed out while resolving stream URL"));
+    });
+    job->hedge = new QTimer(this);
+    job->hedge->setSingleShot(true);
+    connect(job->hedge, &QTimer::timeout, this, [this, job]() {
+        if (job->manifest.started)
+            return;
+        qDebug() << "[YtResolver] Primary query slow, hedging with manifest query for" << job->url;
+        startAttempt(job, true);
+    });
+    m_jobs.insert(key, job);
+    return job;
+}
+
+void YtResolver::cancel(int requestId)
+{
+    for (Job* job : std::as_const(m_jobs)) {
+        if (!job->waiters.removeOne(requestId))
+            continue;
+        if (job->waiters.isEmpty()) {
+            m_orphans.append(job);
+            limitOrphans();
+            // Очередью: следующий resolve() успеет встать на передний план
+            QMetaObject::invokeMethod(this, &YtResolver::pumpPrefetch, Qt::QueuedConnection);
+        }
+        return;
+    }
+}
+
+void YtResolver::invalidate(const QString& url, const QString& cookiesFile)
+{
+    const QString normalized = normalize(url);
+    m_cache->invalidate(YtUrlCache::key(normalized, kAudioFormat, cookiesFile));
+    m_cache->invalidate(YtUrlCache::key(normalized, kManifestFormat, cookiesFile));
+}
+
+void YtResolver::setPrefetchWorkers(int workers)
+{
+    m_prefetchWorkers = qMax(0, workers);
+    // Пулы помощника — по нашим же пределам: основной запрос и хедж у
+    // ожидаемого видео и у каждой «сироты», доделывающей свою работу
+    m_helper->setWorkers(2 * (1 + kMaxOrphans), m_prefetchWorkers);
+}
+
+void YtResolver::prefetch(const QStringList& urls, const QString& cookiesFile)
+{
+    m_prefetch.clear();
+    for (const QString& url : urls) {
+        if (!url.trimmed().isEmpty())
+            m_prefetch.append({ normalize(url), cookiesFile });
+    }
+    if (!m_prefetch.isEmpty())
+        m_helper->warmUp();  // пользователь в YouTube — поднимаем помощник заранее
+    pumpPrefetch();
+}
+
+void YtResolver::pumpPrefetch()
+{
+    // Уступаем переднему плану: пока кто-то ждёт ответа, фон не растёт
+    int running = 0;
+    for (const Job* job : std::as_const(m_jobs)) {
+        if (!job->waiters.isEmpty())
+            return;
+        if (job->background)
+            ++running;
+    }
+
+    while (running < m_prefetchWorkers && !m_prefetch.isEmpty()) {
+        const Prefetch next = m_prefetch.takeFirst();
+        const QString key = YtUrlCache::key(next.url, kAudioFormat, next.cookiesFile);
+        if (m_jobs.contains(key) || !m_cache->lookup(key).isEmpty()
+            || !m_cache->lookup(YtUrlCache::key(next.url, kManifestFormat, next.cookiesFile)).isEmpty())
+            continue;  // уже в работе или ссылка ещё годна
+        Job *job = createJob(key, next.url, next.cookiesFile);
+        job->background = true;
+        qDebug() << "[YtResolver] Prefetching" << next.url;
+        startAttempt(job, false);  // фон не хеджируем — процессов и так N
+        ++running;
+    }
+}
+
+void YtResolver::limitOrphans()
+{
+    while (m_orphans.size() > kMaxOrphans) {
+        Job *oldest = m_orphans.first();
+        qDebug() << "[YtResolver] Dropping abandoned yt-dlp for" << oldest->url;
+        killJob(oldest);
+    }
+}
+
+void YtResolver::armHedge(Job* job)
+{
+    if (m_hedgeDelayMs > 0 && job->primary.running() && !job->manifest.started && !job->hedge->isActive())
+        job->hedge->start(m_hedgeDelayMs);
+}
+
+void YtResolver::startAttempt(Job* job, bool manifest)
+{
+    Attempt *attempt = manifest ? &job->manifest : &job->primary;
+    const Attempt &other = manifest ? job->primary : job->manifest;
+    attempt->started = true;
+    attempt->stdoutBuffer.clear();
+    attempt->stderrBuffer.clear();
+
+    if (!job->direct && m_helper->isAvailable()) {
+        attempt->ticket = m_helper->request(job->url, manifest ? kManifestFormat : kAudioFormat,
+                                            job->cookiesFile, allowsPlaylist(job->url), job->background);
+        qDebug() << "[YtResolver] Sent to yt-dlp helper:" << job->url << (manifest ? "(manifest)" : "");
+    } else {
+        startProcess(job, manifest);
+    }
+    // Таймаут общий на параллельные попытки; последовательная — с нуля
+    if (!other.running())
+        job->timeout->start(kTimeoutMs);
+}
+
+void YtResolver::startProcess(Job* job, bool manifest)
+{
+    Attempt *attempt = manifest ? &job->manifest : &job->primary;
+    QProcess *process = new QProcess(this);
+    attempt->process = process;
+
+    // Determine yt-dlp executable
+    QFile localYt("thirdparty/libmpv/yt-dlp.exe");  // Keep path as is, or adjust if needed
+    process->setProgram(localYt.exists() ? localYt.fileName() : QStringLiteral("yt-dlp"));
+
+    // Build args: get direct audio URL (prefer m4a); запасной — любой формат со звуком
+    QStringList args;
+    args << QStringLiteral("-g");
+    args << QStringLiteral("-f") << (manifest ? kManifestFormat : kAudioFormat);
+    args << QStringLiteral("--no-check-certificate"); // optional, helps some environments
+
+    args << (allowsPlaylist(job->url) ? QStringLiteral("--yes-playlist") : QStringLiteral("--no-playlist"));
+
+    if (!job->cookiesFile.isEmpty())
+        args << QStringLiteral("--cookies") << job->cookiesFile;
+    args << job->url;
+    process->setArguments(args);
+
+    connect(process, &QProcess::readyReadStandardOutput, this, [attempt, process]() {
+        attempt->stdoutBuffer.append(process->readAllStandardOutput());
+    });
+    connect(process, &QProcess::readyReadStandardError, this, [attempt, process]() {
+        const QByteArray chunk = process->readAllStandardError();
+        attempt->stderrBuffer.append(chunk);
+        const QString err = QString::fromUtf8(chunk).trimmed();
+        if (!err.isEmpty()) {
+            qWarning() << "[YtResolver] yt-dlp stderr (real-time):" << err;
+            writeLog("yt_err_realtime.txt", err + "\n");
+        }
+    });
+    connect(process, &QProcess::finished, this, [this, job, manifest](int exitCode, QProcess::ExitStatus) {
+        onAttemptFinished(job, manifest, exitCode);
+    });
+    // Ошибка запуска приходит сигналом — waitForStarted() не нужен. Очередью:
+    // на некоторых платформах она выходит прямо из start(), посреди этой функции
+    const QString key = job->key;
+    connect(process, &QProcess::errorOccurred, this, [this, key, job, manifest, attempt, process](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart || m_jobs.value(key) != job || attempt->process != process)
+            return;
+        const QString message = QStringLiteral("yt-dlp failed to start: ") + process->errorString();
+        qWarning() << "[YtResolver]" << message;
+        discardProcess(process, this);
+        attempt->process = nullptr;
+        onAttemptFailed(job, manifest, message);
+    }, Qt::QueuedConnection);
+
+    process->start();
+    qDebug() << "[YtResolver] yt-dlp started for" << job->url << (manifest ? "(manifest)" : "");
+}
+
+void YtResolver::onAttemptFinished(Job* job, bool manifest, int exitCode)
+{
+    Attempt &attempt = manifest ? job->manifest : job->primary;
+    QProcess *process = attempt.process;
+    attempt.process = nullptr;
+    attempt.stderrBuffer.append(process->readAllStandardError());
+    process->disconnect(this);
+    process->deleteLater();
+
+    const QString stdoutStr = QString::fromUtf8(attempt.stdoutBuffer).trimmed();
+    const QString stderrStr = QString::fromUtf8(attempt.stderrBuffer).trimmed();
+    writeLog(manifest ? "yt_out_manifest.txt" : "yt_out.txt", stdoutStr);
+    writeLog(manifest ? "yt_err_manifest.txt" : "yt_err.txt", stderrStr);
+
+    qDebug() << "[YtResolver] yt-dlp" << (manifest ? "(manifest)" : "") << "exitCode =" << exitCode;
+    qDebug() << "[YtResolver] yt-dlp stdout (snippet):" << stdoutStr.left(1024);
+
+    // Основной без годного формата — его ссылке не верим, решает манифест
+    const bool unusable = stdoutStr.isEmpty() ||
+                          (!manifest && (stderrStr.contains("Requested format is not available") ||
+                                         stderrStr.contains("only manifest")));
+    QStringList lines = stdoutStr.split('\n', Qt::SkipEmptyParts);
+    for (QString &s : lines) s = s.trimmed();
+    if (unusable || lines.isEmpty()) {
+        onAttemptFailed(job, manifest, QStringLiteral("yt-dlp returned no URL (even after fallback). See logs."));
+        return;
+    }
+    onAttemptSucceeded(job, manifest, lines.first());
+}
+
+void YtResolver::onAttemptSucceeded(Job* job, bool manifest, const QString& directUrl)
+{
+    if (manifest && job->primary.running()) {
+        // Основной ещё идёт: его аудио-ссылка лучше — даём ему немного времени
+        qDebug() << "[YtResolver] Manifest query answered first, waiting" << kPreferPrimaryMs << "ms for primary";
+        job->manifestUrl = directUrl;
+        const QString key = job->key;
+        QTimer::singleShot(kPreferPrimaryMs, this, [this, key, job]() {
+            if (m_jobs.value(key) == job && !job->manifestUrl.isEmpty())
+                finishJob(job, job->manifestUrl, QString(), true);
+        });
+        return;
+    }
+    finishJob(job, directUrl, QString(), manifest);
+}
+
+void YtResolver::onHelperFinished(int ticket, const QString& directUrl, const QString& error, bool fault)
+{
+    for (Job* job : std::as_const(m_jobs)) {
+        const bool manifest = job->manifest.ticket == ticket;
+        if (!manifest && job->primary.ticket != ticket)
+            continue;
+        Attempt &attempt = manifest ? job->manifest : job->primary;
+        const Attempt &other = manifest ? job->primary : job->manifest;
+        attempt.ticket = 0;
+
+        if (fault) {
+            // Помощник подвёл, а не yt-dlp — та же попытка отдельным процессом
+            qWarning() << "[YtResolver] Helper failed:" << error << "- falling back to yt-dlp process";
+            job->direct = true;
+            startProcess(job, manifest);
+            if (!other.running())
+                job->timeout->start(kTimeoutMs);
+            return;
+        }
+
+        writeLog(manifest ? "yt_out_manifest.txt" : "yt_out.txt", directUrl);
+        writeLog(manifest ? "yt_err_manifest.txt" : "yt_err.txt", error);
+        qDebug() << "[YtResolver] yt-dlp helper" << (manifest ? "(manifest)" : "")
+                 << "answered:" << (directUrl.isEmpty() ? error : directUrl).left(1024);
+        if (directUrl.isEmpty()) {
+            onAttemptFailed(job, manifest, error.isEmpty() ? QStringLiteral("yt-dlp returned no URL (even after fallback). See logs.") : error);
+            return;
+        }
+        onAttemptSucceeded(job, manifest, directUrl);
+        return;
+    }
+}
+
+void YtResolver::onAttemptFailed(Job* job, bool manifest, const QString& error)
+{
+    if (!manifest && !job->manifestUrl.isEmpty()) {
+        finishJob(job, job->manifestUrl, QString(), true);  // манифест уже ответил
+        return;
+    }
+    const Attempt &other = manifest ? job->primary : job->manifest;
+    if (!other.started) {
+        // Хедж ещё не стартовал — запасной путь сразу
+        qDebug() << "[YtResolver] Trying fallback: request manifest (-f" << kManifestFormat << ")";
+        job->hedge->stop();
+        startAttempt(job, !manifest);
+        return;
+    }
+    if (other.running())
+        return;  // вторая попытка ещё идёт — ждём её
+    qWarning() << "[YtResolver] Both yt-dlp queries failed for" << job->url;
+    finishJob(job, QString(), error);
+}
+
+void YtResolver::finishJob(Job* job, const QString& directUrl, const QString& error, bool fromManifest)
+{
+    if (m_jobs.value(job->key) == job)
+        m_jobs.remove(job->key);
+    m_orphans.removeOne(job);
+    // Результат отменённых запросов тоже в кэш — возврат к видео мгновенный.
+    // Ответ манифеста — под своим ключом: формат другой
+    if (!directUrl.isEmpty())
+        m_cache->store(fromManifest ? YtUrlCache::key(job->url, kManifestFormat, job->cookiesFile) : job->key,
+                       directUrl);
+
+    // Проигравшая попытка больше не нужна
+    discardAttempt(job->primary);
+    discardAttempt(job->manifest);
+
+    const QList<int> waiters = job->waiters;
+    job->timeout->stop();
+    job->timeout->deleteLater();
+    job->hedge->stop();
+    job->hedge->deleteLater();
+    delete job;
+
+    for (int id : waiters) {
+        if (directUrl.isEmpty())
+            emit failed(id, error);
+        else
+            emit resolved(id, directUrl, false);
+    }
+    // Освободилось место (или передний план отпустил) — следующая предвыборка
+    QMetaObject::invokeMethod(this, &YtResolver::pumpPrefetch, Qt::QueuedConnection);
+}
+
+void YtResolver::discardAttempt(Attempt& attempt)
+{
+    discardProcess(attempt.process, this);
+    attempt.process = nullptr;
+    if (attempt.ticket)
+        m_helper->cancel(attempt.ticket);  // ответ помощника просто не придёт
+    attempt.ticket = 0;
+}
+
+void YtResolver::killJob(Job* job)
+{
+    discardAttempt(job->primary);
+    discardAttempt(job->manifest);
+    if (m_jobs.value(job->key) == job)
+        m_jobs.remove(job->key);
+    m_orphans.removeOne(job);
+    job->timeout->stop();
+    job->timeout->deleteLater();
+    job->hedge->stop();
+    job->hedge->deleteLater();
+    delete job;
+}
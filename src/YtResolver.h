@@ -0,0 +1,107 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QProcess>
+#include <QString>
+
+class YtHelper;
+class YtUrlCache;
+class QTimer;
+
+// YtResolver — получение прямой ссылки на звук через yt-dlp без единого
+// блокирующего ожидания в GUI-потоке. resolve() сразу возвращает номер
+// запроса; результат приходит сигналом с этим номером. Запросы одного видео
+// (тот же ключ кэша) делят один процесс. cancel() лишь отписывает запрос:
+// процесс доделывает работу в кэш (вернуться к видео — мгновенно), но
+// «сирот» одновременно не больше двух, лишние убиваются.
+// prefetch() заранее разрешает вероятные следующие видео (соседей по списку,
+// частые из истории) пулом из N фоновых процессов; фон уступает: пока кто-то
+// ждёт ответа, новые фоновые не стартуют, а запрос того же видео просто
+// подхватывает уже идущий фоновый процесс.
+// Хеджирование: если запрос с -f bestaudio молчит дольше hedgeDelay, рядом
+// стартует запасной запрос (-f bestaudio/best — манифест или любой формат
+// со звуком); берётся первая годная ссылка, второй процесс убивается —
+// худший случай близок к одной попытке, а не к сумме. Запасной ответил
+// первым — основному даётся ещё секунда: его m4a предпочтительнее.
+// Ответы запасного кэшируются под своим ключом формата.
+// Попытки идут через резидентный YtHelper (без запуска yt-dlp на каждый
+// запрос); он недоступен или подвёл — отдельным процессом yt-dlp, как раньше.
+class YtResolver : public QObject {
+    Q_OBJECT
+public:
+    explicit YtResolver(QObject* parent = nullptr);
+    ~YtResolver() override;
+
+    // Голый 11-символьный id -> ссылка watch?v=
+    static QString normalize(const QString& url);
+
+    int  resolve(const QString& url, const QString& cookiesFile, bool useCache = true);
+    void cancel(int requestId);
+    void invalidate(const QString& url, const QString& cookiesFile);
+    // Заменяет очередь предвыборки; порядок — приоритет
+    void prefetch(const QStringList& urls, const QString& cookiesFile);
+    void setPrefetchWorkers(int workers);
+    // <= 0 — без хеджирования: манифест только после неудачи основного
+    void setHedgeDelay(int ms) { m_hedgeDelayMs = ms; }
+    YtHelper* helper() const { return m_helper; }
+
+signals:
+    void resolved(int requestId, const QString& directUrl, bool fromCache);
+    void failed(int requestId, const QString& error);
+
+private:
+    // Один запрос к yt-dlp: основной (-f) или манифест — процессом либо помощнику
+    struct Attempt {
+        QProcess*   process = nullptr;
+        int         ticket = 0;        // запрос в YtHelper
+        QByteArray  stdoutBuffer;
+        QByteArray  stderrBuffer;
+        bool        started = false;
+
+        bool running() const { return process || ticket; }
+    };
+
+    struct Job {
+        QString     key;
+        QString     url;
+        QString     cookiesFile;
+        QList<int>  waiters;
+        Attempt     primary;
+        Attempt     manifest;
+        QTimer*     timeout = nullptr;
+        QTimer*     hedge = nullptr;
+        bool        background = false;   // предвыборка, никто не ждёт
+        bool        direct = false;       // помощник подвёл — только процессы
+        QString     manifestUrl;          // ответ запасного, ждёт основного
+    };
+
+    struct Prefetch {
+        QString url;
+        QString cookiesFile;
+    };
+
+    Job* createJob(const QString& key, const QString& url, const QString& cookiesFile);
+    void pumpPrefetch();
+    void startAttempt(Job* job, bool manifest);
+    void startProcess(Job* job, bool manifest);
+    void onHelperFinished(int ticket, const QString& directUrl, const QString& error, bool fault);
+    void discardAttempt(Attempt& attempt);
+    void onAttemptFinished(Job* job, bool manifest, int exitCode);
+    void onAttemptSucceeded(Job* job, bool manifest, const QString& directUrl);
+    void onAttemptFailed(Job* job, bool manifest, const QString& error);
+    void armHedge(Job* job);
+    void finishJob(Job* job, const QString& directUrl, const QString& error, bool fromManifest = false);
+    void killJob(Job* job);
+    void limitOrphans();
+
+    YtUrlCache*          m_cache;
+    YtHelper*            m_helper;
+    QHash<QString, Job*> m_jobs;       // ключ кэша -> процесс в работе
+    QList<Job*>          m_orphans;    // без ожидающих, по времени отмены
+    QList<Prefetch>      m_prefetch;   // ещё не запущенная предвыборка
+    int                  m_prefetchWorkers = 2;
+    int                  m_hedgeDelayMs = 2500;
+    int                  m_nextId = 0;
+};
@@ -0,0 +1,167 @@
+#include "YtUrlCache.h"
+#include "BackgroundWriter.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+    // VLC перезапрашивает ссылку при перемотке и обрывах — она должна
+    // пережить прослушивание, поэтому запас большой (подпись живёт ~6 ч)
+    const qint64 kExpiryMarginSecs = 30 * 60;
+    const qint64 kDefaultTtlSecs = 60 * 60;  // expire= не нашёлся
+    const int    kMaxEntries = 500;
+
+    qint64 nowSecs()
+    {
+        return QDateTime::currentSecsSinceEpoch();
+    }
+}
+
+YtUrlCache::YtUrlCache(const QString& cachePath, QObject* parent)
+    : QObject(parent)
+    , m_writer(new BackgroundWriter(QStringLiteral("YtCacheWriter"), 1000, this))
+    , m_cachePath(cachePath)
+{
+    if (m_cachePath.isEmpty()) {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+        QDir().mkpath(dir);
+        m_cachePath = QDir(dir).filePath(QStringLiteral("ytcache.json"));
+    }
+    load();
+}
+
+QString YtUrlCache::key(const QString& url, const QString& format, const QString& cookiesFile)
+{
+    // Одно видео по разным адресам (watch?v=, youtu.be, shorts, голый id)
+    // — одна запись; с плейлистом yt-dlp отдаёт его первый элемент
+    QString target;
+    const QUrl parsed(url.trimmed());
+    const QString list = QUrlQuery(parsed).queryItemValue(QStringLiteral("list"));
+    static const QRegularExpression idRx(QStringLiteral("(?:[?&]v=|youtu\\.be/|/shorts/|/live/|/embed/)([A-Za-z0-9_-]{11})"));
+    static const QRegularExpression bareRx(QStringLiteral("^[A-Za-z0-9_-]{11}$"));
+    if (!list.isEmpty()) {
+        target = QStringLiteral("list:") + list;
+    } else if (const auto m = idRx.match(url); m.hasMatch()) {
+        target = m.captured(1);
+    } else if (bareRx.match(url.trimmed()).hasMatch()) {
+        target = url.trimmed();
+    } else {
+        target = parsed.adjusted(QUrl::StripTrailingSlash).toString();
+    }
+
+    // Cookies: путь и время изменения — переэкспорт файла меняет сессию
+    QString cookies = QStringLiteral("-");
+    if (!cookiesFile.isEmpty()) {
+        const QFileInfo info(cookiesFile);
+        const QByteArray identity = (info.absoluteFilePath() + QLatin1Char('@')
+                                     + QString::number(info.lastModified().toMSecsSinceEpoch())).toUtf8();
+        cookies = QString::fromLatin1(QCryptographicHash::hash(identity, QCryptographicHash::Sha1).toHex().left(12));
+    }
+    return target + QLatin1Char('|') + format + QLatin1Char('|') + cookies;
+}
+
+qint64 YtUrlCache::expiryOf(const QString& directUrl)
+{
+    // Прогрессивные ссылки: ?expire=...; манифесты: .../expire/<t>/...
+    const QUrl url(directUrl);
+    bool ok = false;
+    const qint64 fromQuery = QUrlQuery(url).queryItemValue(QStringLiteral("expire")).toLongLong(&ok);
+    if (ok && fromQuery > 0)
+        return fromQuery;
+    static const QRegularExpression pathRx(QStringLiteral("/expire/(\\d+)"));
+    const auto m = pathRx.match(url.path());
+    return m.hasMatch() ? m.captured(1).toLongLong() : 0;
+}
+
+QString YtUrlCache::lookup(const QString& key) const
+{
+    auto it = m_cache.constFind(key);
+    if (it == m_cache.constEnd() || it->expires <= nowSecs())
+        return QString();
+    return it->url;
+}
+
+void YtUrlCache::store(const QString& key, const QString& directUrl)
+{
+    const qint64 expire = expiryOf(directUrl);
+    Entry e;
+    e.url = directUrl;
+    e.expires = expire > 0 ? expire - kExpiryMarginSecs : nowSecs() + kDefaultTtlSecs;
+    if (e.expires <= nowSecs())
+        return;  // подпись и так на исходе
+    m_cache.insert(key, e);
+    prune();
+    save();
+    qDebug() << "[YtUrlCache] Cached for" << (e.expires - nowSecs()) / 60 << "min:" << key;
+}
+
+void YtUrlCache::invalidate(const QString& key)
+{
+    if (m_cache.remove(key))
+        save();
+}
+
+void YtUrlCache::prune()
+{
+    const qint64 now = nowSecs();
+    m_cache.removeIf([now](const QHash<QString, Entry>::iterator it) { return it->expires <= now; });
+    if (m_cache.size() <= kMaxEntries)
+        return;
+
+    // Переполнение — уходят ближайшие к истечению
+    QList<qint64> expiries;
+    expiries.reserve(m_cache.size());
+    for (const Entry& e : std::as_const(m_cache))
+        expiries << e.expires;
+    std::nth_element(expiries.begin(), expiries.begin() + (expiries.size() - kMaxEntries), expiries.end());
+    const qint64 cutoff = expiries.at(expiries.size() - kMaxEntries);
+    m_cache.removeIf([cutoff](const QHash<QString, Entry>::iterator it) { return it->expires < cutoff; });
+}
+
+void YtUrlCache::load()
+{
+    QFile f(m_cachePath);
+    if (!f.open(QIODevice::ReadOnly))
+        return;
+    const QJsonObject root = QJsonDocument::fromJson(f.readAll()).object();
+    for (auto it = root.constBegin(); it != root.constEnd(); ++it) {
+        const QJsonObject o = it.value().toObject();
+        Entry e;
+        e.url = o.value("url").toString();
+        e.expires = o.value("expires").toInteger();
+        if (!e.url.isEmpty())
+            m_cache.insert(it.key(), e);
+    }
+    prune();
+}
+
+void YtUrlCache::save()
+{
+    QJsonObject root;
+    for (auto it = m_cache.constBegin(); it != m_cache.constEnd(); ++it) {
+        QJsonObject o;
+        o.insert("url", it->url);
+        o.insert("expires", it->expires);
+        root.insert(it.key(), o);
+    }
+    const QString path = m_cachePath;
+    const QByteArray data = QJsonDocument(root).toJson(QJsonDocument::Compact);
+    m_writer->schedule([path, data]() {
+        QSaveFile f(path);
+        if (f.open(QIODevice::WriteOnly)) {
+            f.write(data);
+            f.commit();
+        }
+    });
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+
+class BackgroundWriter;
+
+// YtUrlCache — прямые ссылки на звук, полученные от yt-dlp, на диске
+// (ytcache.json). Ключ — id видео (или плейлиста) + селектор формата +
+// отпечаток файла cookies: другой вход в аккаунт — другая ссылка.
+// Ссылки googlevideo подписаны и живут до expire=; запись считается
+// годной, пока до него остаётся запас — повторный запуск обходится
+// без yt-dlp и стартует за доли секунды.
+class YtUrlCache : public QObject {
+    Q_OBJECT
+public:
+    explicit YtUrlCache(const QString& cachePath = QString(), QObject* parent = nullptr);
+
+    static QString key(const QString& url, const QString& format, const QString& cookiesFile);
+    // Время истечения подписи (UTC, секунды); 0 — в ссылке его нет
+    static qint64 expiryOf(const QString& directUrl);
+
+    // Пусто — записи нет или до истечения меньше запаса
+    QString lookup(const QString& key) const;
+    void store(const QString& key, const QString& directUrl);
+    void invalidate(const QString& key);
+
+private:
+    struct Entry {
+        QString url;
+        qint64  expires = 0;   // уже с учётом запаса
+    };
+
+    void prune();
+    void load();
+    void save();
+
+    BackgroundWriter*     m_writer;
+    QString               m_cachePath;
+    QHash<QString, Entry> m_cache;
+};
@@ -5,10 +5,11 @@
 #include "MainWindow.h"
 #include "StationManager.h"
 #include "RadioPlayer.h"
+#include "StreamPlayer.h"
 #include "YTPlayer.h"
 #include "SwitchPlayer.h"
+#include "AppSettings.h"
 #include "../include/FontLoader.h"
-#include <QSettings>
 #include <csignal>
 #include <QMessageLogger>
 #include <QFile>
@@ -51,16 +52,7 @@ int main(int argc, char *argv[])
         qWarning("Cannot load qdarkstyle qss");
     }
 
-    QString lang;
-    {
-        QSettings settings(
-            QSettings::IniFormat,
-            QSettings::UserScope,
-            "MyApp",
-            "LoraRadio"
-        );
-        lang = settings.value("language", "en").toString();
-    }
+    QString lang = AppSettings::instance()->language();
 
     QTranslator qtTrans;
     bool qtLoaded = qtTrans.load(
@@ -80,26 +72,27 @@ int main(int argc, char *argv[])
         app.installTranslator(&appTrans);
 
     StationManager* stations = new StationManager("");
-    RadioPlayer* radio = new RadioPlayer(stations);
+    // Движок радио выбирается настройкой radio/backend
+    // HLS всегда идёт через StreamPlayer: свой разбор плейлистов и сегментов
+    AbstractPlayer* radio = nullptr;
+    AbstractPlayer* hls = nullptr;
+    if (AppSettings::instance()->radioBackend() == QLatin1String("native")) {
+        radio = new StreamPlayer();
+    } else {
+        radio = new RadioPlayer(stations);
+        hls = new StreamPlayer();
+    }
     YTPlayer* ytplayer = new YTPlayer(QStringLiteral(""), nullptr);
 
-    SwitchPlayer* player = new SwitchPlayer(radio, ytplayer, nullptr);
+    SwitchPlayer* player = new SwitchPlayer(radio, ytplayer, hls, nullptr);
     qDebug() << "[main] Created SwitchPlayer at" << player;
 
     MainWindow w(stations, player);
 
     int result = app.exec();
 
-    {
-        QSettings settings(
-            QSettings::IniFormat,
-            QSettings::UserScope,
-            "MyApp",
-            "LoraRadio"
-        );
-        settings.setValue("lastExitCode", result);
-        settings.sync();
-    }
+    AppSettings::instance()->setValue("lastExitCode", result);
+    AppSettings::instance()->flush();
 
     return result;
 }